@@ -32,8 +32,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "StellarObject.h"
 #include "System.h"
 #include "Weapon.h"
-
-#include <SDL2/SDL.h>
+#include "WellKnown.h"
 
 #include <algorithm>
 #include <cmath>
@@ -243,7 +242,9 @@ namespace {
 
 
 AI::AI(const List<Ship> &ships, const List<Minable> &minables, const List<Flotsam> &flotsam)
-	: ships(ships), minables(minables), flotsam(flotsam)
+	: ships(ships), minables(minables), flotsam(flotsam), arena(1 << 17),
+	governmentRosters(less<const Government *>(), arena), enemyLists(less<const Government *>(), arena),
+	allyLists(less<const Government *>(), arena)
 {
 }
 
@@ -275,14 +276,14 @@ void AI::IssueMoveTarget(const PlayerInfo &player, const Point &target, const Sy
 
 
 // Commands issued via the keyboard (mostly, to the flagship).
-void AI::UpdateKeys(PlayerInfo &player, Command &clickCommands, bool isActive)
+void AI::UpdateKeys(PlayerInfo &player, const Command &keys, bool hasShift, Command &clickCommands, bool isActive)
 {
-	shift = (SDL_GetModState() & KMOD_SHIFT);
+	shift = hasShift;
 	escortsUseAmmo = Preferences::Has("Escorts expend ammo");
 	escortsAreFrugal = Preferences::Has("Escorts use ammo frugally");
 	
 	Command oldHeld = keyHeld;
-	keyHeld.ReadKeyboard();
+	keyHeld = keys;
 	keyStuck |= clickCommands;
 	clickCommands.Clear();
 	keyDown = keyHeld.AndNot(oldHeld);
@@ -428,6 +429,13 @@ void AI::ClearOrders()
 
 void AI::Step(const PlayerInfo &player)
 {
+	// The lists of ships are rebuilt in the frame arena every step, so the old
+	// lists must be freed before the arena can be reset.
+	governmentRosters.clear();
+	enemyLists.clear();
+	allyLists.clear();
+	arena.Reset();
+	
 	// First, figure out the comparative strengths of the present governments.
 	const System *playerSystem = player.GetSystem();
 	map<const Government *, int64_t> strength;
@@ -465,6 +473,7 @@ void AI::Step(const PlayerInfo &player)
 		if(!it->GetSystem())
 			continue;
 		
+		Random::Stream stream(it->RandomKey(), Random::AI);
 		if(it.get() == flagship)
 		{
 			MovePlayer(*it, player);
@@ -855,6 +864,14 @@ int64_t AI::EnemyStrength(const Government *government)
 
 
 
+// Get the scratch memory that was used in the most recent step.
+const FrameArena &AI::Arena() const
+{
+	return arena;
+}
+
+
+
 // Check if the given target can be pursued by this ship.
 bool AI::CanPursue(const Ship &ship, const Ship &target) const
 {
@@ -1161,12 +1178,12 @@ shared_ptr<Ship> AI::FindTarget(const Ship &ship) const
 // Return a list of all targetable ships in the same system as the player that
 // match the desired hostility (i.e. enemy or non-enemy). Does not consider the
 // ship's current target, as its inclusion may or may not be desired.
-vector<shared_ptr<Ship>> AI::GetShipsList(const Ship &ship, bool targetEnemies, double maxRange) const
+AI::ShipList AI::GetShipsList(const Ship &ship, bool targetEnemies, double maxRange) const
 {
 	if(maxRange < 0.)
 		maxRange = numeric_limits<double>::infinity();
 	
-	auto targets = vector<shared_ptr<Ship>>();
+	ShipList targets(arena);
 	
 	// The cached lists are built each step based on the current ships in the player's system.
 	const auto &rosters = targetEnemies ? enemyLists : allyLists;
@@ -2842,7 +2859,7 @@ void AI::AutoFire(const Ship &ship, Command &command, bool secondary) const
 			continue;
 		}
 		// For non-homing weapons:
-		for(const shared_ptr<const Ship> &target : enemies)
+		for(const shared_ptr<Ship> &target : enemies)
 		{
 			// Don't shoot ships we want to plunder.
 			bool hasBoarded = Has(ship, target, ShipEvent::BOARD);
@@ -3175,7 +3192,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 			}
 		}
 		if(!message.empty())
-			Audio::Play(Audio::Get("fail"));
+			Audio::Play(WellKnown::Get(WellKnown::FAIL));
 		
 		const StellarObject *target = ship.GetTargetStellar();
 		// Require that the player's planetary target is one of the current system's planets.
@@ -3201,7 +3218,7 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 			{
 				message = "The authorities on this " + next->GetPlanet()->Noun() +
 					" refuse to clear you to land here.";
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 			}
 			else if(next != target)
 				message = "Switching landing targets. Now landing on " + next->Name() + ".";
@@ -3239,13 +3256,13 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 			if(!target)
 			{
 				message = "There are no planets in this system that you can land on.";
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 			}
 			else if(!target->GetPlanet()->CanLand())
 			{
 				message = "The authorities on this " + target->GetPlanet()->Noun() +
 					" refuse to clear you to land here.";
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 			}
 			else if(!types.empty())
 			{
@@ -3412,21 +3429,21 @@ void AI::MovePlayer(Ship &ship, const PlayerInfo &player)
 			Messages::Add("You do not have a hyperdrive installed.");
 			keyStuck.Clear();
 			if(isNewPress)
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 		}
 		else if(!ship.JumpFuel(ship.GetTargetSystem()))
 		{
 			Messages::Add("You cannot jump to the selected system.");
 			keyStuck.Clear();
 			if(isNewPress)
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 		}
 		else if(!ship.JumpsRemaining() && !ship.IsEnteringHyperspace())
 		{
 			Messages::Add("You do not have enough fuel to make a hyperspace jump.");
 			keyStuck.Clear();
 			if(isNewPress)
-				Audio::Play(Audio::Get("fail"));
+				Audio::Play(WellKnown::Get(WellKnown::FAIL));
 		}
 		else
 		{
@@ -3510,11 +3527,13 @@ bool AI::Has(const Ship &ship, const Government *government, int type) const
 void AI::UpdateStrengths(map<const Government *, int64_t> &strength, const System *playerSystem)
 {
 	// Tally the strength of a government by the cost of its present and able ships.
-	governmentRosters.clear();
 	for(const auto &it : ships)
 		if(it->GetGovernment() && it->GetSystem() == playerSystem)
 		{
-			governmentRosters[it->GetGovernment()].emplace_back(it);
+			auto rit = governmentRosters.find(it->GetGovernment());
+			if(rit == governmentRosters.end())
+				rit = governmentRosters.emplace(it->GetGovernment(), ShipList(arena)).first;
+			rit->second.emplace_back(it);
 			if(!it->IsDisabled())
 				strength[it->GetGovernment()] += it->Cost();
 		}
@@ -3524,7 +3543,8 @@ void AI::UpdateStrengths(map<const Government *, int64_t> &strength, const Syste
 	allyStrength.clear();
 	for(const auto &gov : strength)
 	{
-		set<const Government *> allies;
+		set<const Government *, less<const Government *>, FrameArena::Allocator<const Government *>> allies(
+			less<const Government *>(), arena);
 		for(const auto &enemy : strength)
 			if(enemy.first->IsEnemy(gov.first))
 			{
@@ -3566,18 +3586,15 @@ void AI::UpdateStrengths(map<const Government *, int64_t> &strength, const Syste
 // Cache various lists of all targetable ships in the player's system for this Step.
 void AI::CacheShipLists()
 {
-	allyLists.clear();
-	enemyLists.clear();
 	for(const auto &git : governmentRosters)
 	{
-		allyLists.emplace(git.first, vector<shared_ptr<Ship>>());
-		allyLists.at(git.first).reserve(ships.size());
-		enemyLists.emplace(git.first, vector<shared_ptr<Ship>>());
-		enemyLists.at(git.first).reserve(ships.size());
+		ShipList &allies = allyLists.emplace(git.first, ShipList(arena)).first->second;
+		allies.reserve(ships.size());
+		ShipList &enemies = enemyLists.emplace(git.first, ShipList(arena)).first->second;
+		enemies.reserve(ships.size());
 		for(const auto &oit : governmentRosters)
 		{
-			auto &list = git.first->IsEnemy(oit.first)
-					? enemyLists[git.first] : allyLists[git.first];
+			ShipList &list = git.first->IsEnemy(oit.first) ? enemies : allies;
 			list.insert(list.end(), oit.second.begin(), oit.second.end());
 		}
 	}
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define AI_H_
 
 #include "Command.h"
+#include "FrameArena.h"
 #include "Point.h"
 
 #include <cstdint>
@@ -53,8 +54,9 @@ template <class Type>
 	// Fleet commands from the player.
 	void IssueShipTarget(const PlayerInfo &player, const std::shared_ptr<Ship> &target);
 	void IssueMoveTarget(const PlayerInfo &player, const Point &target, const System *moveToSystem);
-	// Commands issued via the keyboard (mostly, to the flagship).
-	void UpdateKeys(PlayerInfo &player, Command &clickCommands, bool isActive);
+	// Commands issued via the keyboard (mostly, to the flagship). The keys that
+	// are held down and whether shift is held are passed in by the engine.
+	void UpdateKeys(PlayerInfo &player, const Command &keys, bool hasShift, Command &clickCommands, bool isActive);
 	
 	// Allow the AI to track any events it is interested in.
 	void UpdateEvents(const std::list<ShipEvent> &events);
@@ -70,6 +72,16 @@ template <class Type>
 	int64_t AllyStrength(const Government *government);
 	int64_t EnemyStrength(const Government *government);
 	
+	// Get the scratch memory that was used in the most recent step.
+	const FrameArena &Arena() const;
+	
+	
+private:
+	// Lists of ships that are rebuilt every step, in the frame arena.
+	typedef std::vector<std::shared_ptr<Ship>, FrameArena::Allocator<std::shared_ptr<Ship>>> ShipList;
+	typedef std::map<const Government *, ShipList, std::less<const Government *>,
+		FrameArena::Allocator<std::pair<const Government *const, ShipList>>> ShipLists;
+	
 	
 private:
 	// Check if a ship can pursue its target (i.e. beyond the "fence").
@@ -81,7 +93,7 @@ private:
 	// Pick a new target for the given ship.
 	std::shared_ptr<Ship> FindTarget(const Ship &ship) const;
 	// Obtain a list of ships matching the desired hostility.
-	std::vector<std::shared_ptr<Ship>> GetShipsList(const Ship &ship, bool targetEnemies, double maxRange = -1.) const;
+	ShipList GetShipsList(const Ship &ship, bool targetEnemies, double maxRange = -1.) const;
 	
 	bool FollowOrders(Ship &ship, Command &command) const;
 	void MoveIndependent(Ship &ship, Command &command) const;
@@ -222,9 +234,12 @@ private:
 	
 	std::map<const Government *, int64_t> enemyStrength;
 	std::map<const Government *, int64_t> allyStrength;
-	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> governmentRosters;
-	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> enemyLists;
-	std::map<const Government *, std::vector<std::shared_ptr<Ship>>> allyLists;
+	// Scratch memory for the lists of ships below, and any other temporary
+	// lists. It is reset at the start of each step.
+	mutable FrameArena arena;
+	ShipLists governmentRosters;
+	ShipLists enemyLists;
+	ShipLists allyLists;
 };
 
 
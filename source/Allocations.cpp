@@ -0,0 +1,274 @@
+/* Allocations.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Allocations.h"
+
+#include "Format.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <string>
+
+using namespace std;
+
+namespace {
+	// These are initialized at compile time, so they are ready before any
+	// static objects are constructed (and allocate memory).
+	atomic<bool> isCounting(false);
+	atomic<uint64_t> count(0);
+	atomic<uint64_t> bytes(0);
+	atomic<bool> isTracking(false);
+	
+	// The memory held by each owner.
+	const char *TAG_NAME[Allocations::TAG_COUNT] = {
+		"game data",
+		"data nodes",
+		"ships",
+		"engine",
+		"image buffers",
+		"mask caches",
+		"sounds",
+		"music"
+	};
+	atomic<int64_t> tagBytes[Allocations::TAG_COUNT];
+	atomic<int64_t> tagPeak[Allocations::TAG_COUNT];
+	atomic<int64_t> tagObjects[Allocations::TAG_COUNT];
+	
+	void UpdatePeak(Allocations::Tag tag, int64_t value)
+	{
+		int64_t peak = tagPeak[tag].load(memory_order_relaxed);
+		while(value > peak && !tagPeak[tag].compare_exchange_weak(peak, value, memory_order_relaxed))
+			continue;
+	}
+	
+	string FormatBytes(int64_t value)
+	{
+		if(value >= 10 << 20)
+			return Format::Number(value >> 20) + " MB";
+		if(value >= 10 << 10)
+			return Format::Number(value >> 10) + " kB";
+		return Format::Number(value) + " B";
+	}
+	
+	void *Allocate(size_t size)
+	{
+		if(isCounting.load(memory_order_relaxed))
+		{
+			count.fetch_add(1, memory_order_relaxed);
+			bytes.fetch_add(size, memory_order_relaxed);
+		}
+		return malloc(size ? size : 1);
+	}
+}
+
+
+
+// Start counting, from zero, or stop counting.
+void Allocations::Start()
+{
+	count = 0;
+	bytes = 0;
+	isCounting = true;
+}
+
+
+
+void Allocations::Stop()
+{
+	isCounting = false;
+}
+
+
+
+bool Allocations::IsCounting()
+{
+	return isCounting;
+}
+
+
+
+// Get the number of allocations, and the total bytes allocated, since
+// counting was started.
+uint64_t Allocations::Count()
+{
+	return count;
+}
+
+
+
+uint64_t Allocations::Bytes()
+{
+	return bytes;
+}
+
+
+
+// Start keeping track of what each owner is holding. This cannot be turned
+// off again, so that every object that is counted is also uncounted.
+void Allocations::Track()
+{
+	isTracking = true;
+}
+
+
+
+bool Allocations::IsTracking()
+{
+	return isTracking;
+}
+
+
+
+// Record that the given owner is now holding on to more or less memory.
+void Allocations::Add(Tag tag, int64_t bytes, int64_t objects)
+{
+	if(!isTracking.load(memory_order_relaxed))
+		return;
+	
+	tagObjects[tag].fetch_add(objects, memory_order_relaxed);
+	UpdatePeak(tag, tagBytes[tag].fetch_add(bytes, memory_order_relaxed) + bytes);
+}
+
+
+
+void Allocations::Remove(Tag tag, int64_t bytes, int64_t objects)
+{
+	if(!isTracking.load(memory_order_relaxed))
+		return;
+	
+	tagObjects[tag].fetch_sub(objects, memory_order_relaxed);
+	tagBytes[tag].fetch_sub(bytes, memory_order_relaxed);
+}
+
+
+
+// Replace the given owner's totals, for owners that measure what they are
+// holding rather than recording each change.
+void Allocations::Set(Tag tag, int64_t bytes, int64_t objects)
+{
+	if(!isTracking.load(memory_order_relaxed))
+		return;
+	
+	tagObjects[tag].store(objects, memory_order_relaxed);
+	tagBytes[tag].store(bytes, memory_order_relaxed);
+	UpdatePeak(tag, bytes);
+}
+
+
+
+// Get the memory each owner is holding right now, or the most it has held.
+int64_t Allocations::Bytes(Tag tag)
+{
+	return tagBytes[tag];
+}
+
+
+
+int64_t Allocations::Peak(Tag tag)
+{
+	return tagPeak[tag];
+}
+
+
+
+int64_t Allocations::Objects(Tag tag)
+{
+	return tagObjects[tag];
+}
+
+
+
+// Print a table of how much memory each owner is holding.
+void Allocations::Report(ostream &out)
+{
+	out << left << setw(16) << "owner" << right << setw(12) << "objects"
+		<< setw(12) << "memory" << setw(12) << "peak" << endl;
+	int64_t total = 0;
+	for(int i = 0; i < TAG_COUNT; ++i)
+	{
+		Tag tag = static_cast<Tag>(i);
+		total += Bytes(tag);
+		out << left << setw(16) << TAG_NAME[i] << right << setw(12) << Format::Number(Objects(tag))
+			<< setw(12) << FormatBytes(Bytes(tag)) << setw(12) << FormatBytes(Peak(tag)) << endl;
+	}
+	out << left << setw(16) << "total" << right << setw(24) << FormatBytes(total) << endl;
+	if(count)
+		out << Format::Number(count) << " allocations (" << FormatBytes(bytes)
+			<< ") were counted the last time counting was on." << endl;
+}
+
+
+
+// Replacements for the global allocation functions. All of them must be
+// replaced together, so that memory is always freed the same way it was
+// allocated.
+void *operator new(size_t size)
+{
+	void *pointer = Allocate(size);
+	if(!pointer)
+		throw bad_alloc();
+	return pointer;
+}
+
+
+
+void *operator new[](size_t size)
+{
+	void *pointer = Allocate(size);
+	if(!pointer)
+		throw bad_alloc();
+	return pointer;
+}
+
+
+
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+	return Allocate(size);
+}
+
+
+
+void *operator new[](size_t size, const nothrow_t &) noexcept
+{
+	return Allocate(size);
+}
+
+
+
+void operator delete(void *pointer) noexcept
+{
+	free(pointer);
+}
+
+
+
+void operator delete[](void *pointer) noexcept
+{
+	free(pointer);
+}
+
+
+
+void operator delete(void *pointer, const nothrow_t &) noexcept
+{
+	free(pointer);
+}
+
+
+
+void operator delete[](void *pointer, const nothrow_t &) noexcept
+{
+	free(pointer);
+}
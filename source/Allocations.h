@@ -0,0 +1,89 @@
+/* Allocations.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef ALLOCATIONS_H_
+#define ALLOCATIONS_H_
+
+#include <cstdint>
+#include <ostream>
+
+
+
+// Class for counting how many times the game allocates memory, in every thread,
+// so that code that allocates memory in every step of the game can be found.
+// The global operator new is replaced to do the counting. Counting is off
+// unless it has been started, in which case checking that is the only cost.
+// Separately, the biggest owners of memory keep track of how much they are
+// holding on to, so that growth over a long session can be attributed to them.
+// That is also off unless it is turned on before anything is loaded, because
+// data nodes are created and destroyed by the million while parsing.
+class Allocations {
+public:
+	enum Tag {
+		GAME_DATA,
+		DATA_NODES,
+		SHIPS,
+		ENGINE,
+		IMAGE_BUFFERS,
+		MASK_CACHES,
+		SOUNDS,
+		MUSIC,
+		TAG_COUNT
+	};
+	
+	// A member that counts how many objects of the given type exist. It only
+	// counts the size of the object itself, not anything it points to.
+	template <class Type, Tag TAG>
+	class Counted {
+	public:
+		Counted() { Add(TAG, sizeof(Type)); }
+		Counted(const Counted &) : Counted() {}
+		Counted &operator=(const Counted &) { return *this; }
+		~Counted() { Remove(TAG, sizeof(Type)); }
+	};
+	
+	
+public:
+	// Start counting, from zero, or stop counting.
+	static void Start();
+	static void Stop();
+	static bool IsCounting();
+	
+	// Get the number of allocations, and the total bytes allocated, since
+	// counting was started.
+	static uint64_t Count();
+	static uint64_t Bytes();
+	
+	// Start keeping track of what each owner is holding. This cannot be turned
+	// off again, so that every object that is counted is also uncounted.
+	static void Track();
+	static bool IsTracking();
+	
+	// Record that the given owner is now holding on to more or less memory.
+	static void Add(Tag tag, int64_t bytes, int64_t objects = 1);
+	static void Remove(Tag tag, int64_t bytes, int64_t objects = 1);
+	// Replace the given owner's totals, for owners that measure what they are
+	// holding rather than recording each change.
+	static void Set(Tag tag, int64_t bytes, int64_t objects);
+	
+	// Get the memory each owner is holding right now, or the most it has held.
+	static int64_t Bytes(Tag tag);
+	static int64_t Peak(Tag tag);
+	static int64_t Objects(Tag tag);
+	
+	// Print a table of how much memory each owner is holding.
+	static void Report(std::ostream &out);
+};
+
+
+
+#endif
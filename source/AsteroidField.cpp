@@ -172,6 +172,14 @@ const list<shared_ptr<Minable>> &AsteroidField::Minables() const
 
 
 
+// Get the number of objects in the asteroid and minable collision sets.
+size_t AsteroidField::CollisionSetSize() const
+{
+	return asteroidCollisions.Size() + minableCollisions.Size();
+}
+
+
+
 // Construct an asteroid with the given sprite and "energy level."
 AsteroidField::Asteroid::Asteroid(const Sprite *sprite, double energy)
 {
@@ -60,6 +60,8 @@ public:
 	
 	// Get the list of minable asteroids.
 	const std::list<std::shared_ptr<Minable>> &Minables() const;
+	// Get the number of objects in the asteroid and minable collision sets.
+	size_t CollisionSetSize() const;
 	
 	
 private:
@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Files.h"
 #include "Music.h"
 #include "Point.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "Sound.h"
 
@@ -561,6 +562,7 @@ namespace {
 	// Thread entry point for loading sounds.
 	void Load()
 	{
+		Profiler::SetThreadName("Sound loader");
 		string name;
 		string path;
 		while(true)
@@ -579,6 +581,7 @@ namespace {
 			}
 			
 			// Unlock the mutex for the time-intensive part of the loop.
+			Profiler::Zone zone("Sound::Load");
 			if(!sounds[name].Load(path, name))
 				Files::LogError("Unable to load sound \"" + name + "\" from path: " + path);
 		}
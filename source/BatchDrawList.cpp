@@ -14,14 +14,19 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "BatchShader.h"
 #include "Body.h"
+#include "Profiler.h"
 #include "Screen.h"
 #include "Sprite.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
 
 namespace {
+	// Each vertex has five attributes, and each quad has four vertices.
+	const size_t QUAD_SIZE = 20;
+	
 	void Push(vector<float> &v, const Point &pos, float s, float t, float frame)
 	{
 		v.push_back(pos.X());
@@ -37,7 +42,13 @@ namespace {
 // Clear the list, also setting the global time step for animation.
 void BatchDrawList::Clear(int step, double zoom)
 {
-	data.clear();
+	// Clearing a vector does not release its memory, so the buffers filled in
+	// the previous step will be reused.
+	added.clear();
+	addedRange.clear();
+	vertices.clear();
+	ranges.clear();
+	lastRange = 0;
 	this->step = step;
 	this->zoom = zoom;
 	isHighDPI = (Screen::IsHighResolution() ? zoom > .5 : zoom > 1.);
@@ -59,8 +70,21 @@ bool BatchDrawList::Add(const Body &body, float clip)
 	if(Cull(body, position))
 		return false;
 	
-	// Get the data vector for this particular sprite.
-	vector<float> &v = data[body.GetSprite()];
+	// Find the range for this particular sprite. Objects with the same sprite
+	// tend to be added one after another, so check the most recent one first.
+	// There are only ever a few dozen distinct sprites in a step.
+	const Sprite *sprite = body.GetSprite();
+	if(lastRange >= ranges.size() || ranges[lastRange].sprite != sprite)
+	{
+		lastRange = 0;
+		while(lastRange < ranges.size() && ranges[lastRange].sprite != sprite)
+			++lastRange;
+		if(lastRange == ranges.size())
+			ranges.push_back({sprite, 0, 0});
+	}
+	++ranges[lastRange].count;
+	addedRange.push_back(lastRange);
+	
 	// The sprite frame is the same for every vertex.
 	float frame = body.GetFrame(step);
 	
@@ -80,33 +104,74 @@ bool BatchDrawList::Add(const Body &body, float clip)
 	Point bottomLeft = topLeft + uh;
 	Point bottomRight = bottomLeft + uw;
 	
-	// Push two copies of the first and last vertices to mark the break between
-	// the sprites.
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topLeft, 0.f, 1.f, frame);
-	Push(v, topRight, 1.f, 1.f, frame);
-	Push(v, bottomLeft, 0.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
-	Push(v, bottomRight, 1.f, 1.f - clip, frame);
+	// The index buffer turns these four vertices into two triangles, so there
+	// is no need for any dummy vertices between one quad and the next.
+	Push(added, topLeft, 0.f, 1.f, frame);
+	Push(added, topRight, 1.f, 1.f, frame);
+	Push(added, bottomLeft, 0.f, 1.f - clip, frame);
+	Push(added, bottomRight, 1.f, 1.f - clip, frame);
 	
 	return true;
 }
 
 
 
+// Once everything has been added, sort the vertex stream so that all the
+// quads that use the same sprite are contiguous.
+void BatchDrawList::Finish()
+{
+	// Figure out where each sprite's range begins.
+	size_t first = 0;
+	for(Range &range : ranges)
+	{
+		range.first = first;
+		first += range.count;
+		// Reuse the count as a cursor while copying the quads into place.
+		range.count = 0;
+	}
+	
+	// This is a counting sort: each quad is copied exactly once, directly into
+	// its final position in the stream.
+	vertices.resize(added.size());
+	for(size_t i = 0; i < addedRange.size(); ++i)
+	{
+		Range &range = ranges[addedRange[i]];
+		const float *in = &added[i * QUAD_SIZE];
+		copy(in, in + QUAD_SIZE, &vertices[(range.first + range.count) * QUAD_SIZE]);
+		++range.count;
+	}
+}
+
+
+
 // Draw all the items in this list.
 void BatchDrawList::Draw() const
 {
+	if(vertices.empty())
+		return;
+	
+	Profiler::Zone zone("BatchDrawList::Draw");
 	BatchShader::Bind();
 	
-	for(const pair<const Sprite *, vector<float>> &it : data)
-		BatchShader::Add(it.first, isHighDPI, it.second);
+	// Upload the entire step's vertex data at once, then draw each sprite's
+	// portion of it.
+	BatchShader::Upload(vertices);
+	for(const Range &range : ranges)
+		BatchShader::Add(range.sprite, isHighDPI, range.first, range.count);
 	
 	BatchShader::Unbind();
 }
 
 
 
+// Get the number of vertices in the sorted stream.
+size_t BatchDrawList::Vertices() const
+{
+	return vertices.size() / (QUAD_SIZE / 4);
+}
+
+
+
 bool BatchDrawList::Cull(const Body &body, const Point &position) const
 {
 	if(!body.HasSprite() || !body.Zoom())
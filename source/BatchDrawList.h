@@ -15,7 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Point.h"
 
-#include <map>
+#include <cstddef>
 #include <vector>
 
 class Body;
@@ -33,26 +33,50 @@ public:
 	
 	// Add an object based on the Body class.
 	bool Add(const Body &body, float clip = 1.f);
+	// Once everything has been added, sort the vertex stream so that all the
+	// quads that use the same sprite are contiguous. This is done in the
+	// calculation thread so that drawing only has to upload one buffer.
+	void Finish();
 	
 	// Draw all the items in this list.
 	void Draw() const;
+	// Get the number of vertices in the sorted stream.
+	size_t Vertices() const;
 	
 	
 private:
 	bool Cull(const Body &body, const Point &position) const;
 	
 	
+private:
+	// A contiguous run of quads in the vertex stream that all use one sprite.
+	class Range {
+	public:
+		const Sprite *sprite;
+		size_t first;
+		size_t count;
+	};
+	
+	
 private:
 	int step = 0;
 	double zoom = 1.;
 	bool isHighDPI = false;
 	Point center;
 	
-	// Each sprite consists of six vertices (four vertices to form a quad and
-	// two dummy vertices to mark the break in between them). Each of those
-	// vertices has five attributes: (x, y) position in pixels, (s, t) texture
-	// coordinates, and the index of the sprite frame.
-	std::map<const Sprite *, std::vector<float>> data;
+	// Each sprite is a quad of four vertices, drawn as two triangles using a
+	// shared index buffer. Each of those vertices has five attributes: (x, y)
+	// position in pixels, (s, t) texture coordinates, and the index of the
+	// sprite frame. Quads are stored in the order they were added, along with
+	// the index of the range they belong to. None of these vectors are ever
+	// shrunk, so after the first few steps no reallocation happens.
+	std::vector<float> added;
+	std::vector<size_t> addedRange;
+	// The sorted stream that will actually be uploaded, and the per-sprite
+	// ranges within it (measured in quads).
+	std::vector<float> vertices;
+	std::vector<Range> ranges;
+	size_t lastRange = 0;
 };
 
 
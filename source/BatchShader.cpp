@@ -12,10 +12,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "BatchShader.h"
 
+#include "Font.h"
 #include "Screen.h"
 #include "Shader.h"
 #include "Sprite.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace std;
 
 namespace {
@@ -29,6 +33,45 @@ namespace {
 	
 	GLuint vao;
 	GLuint vbo;
+	GLuint ebo;
+	
+	// Each vertex has five floats. Each quad has four vertices and six indices.
+	const size_t VERTEX_SIZE = 5 * sizeof(float);
+	const size_t QUAD_VERTICES = 4;
+	const size_t QUAD_INDICES = 6;
+	
+	// The vertex buffer is used as a ring: each frame's data is written just
+	// past the previous frame's, so the driver never has to wait for the GPU
+	// to finish with the old data. Once the end is reached, the buffer storage
+	// is orphaned and writing starts over at the beginning.
+	size_t ringCapacity = 4 << 20;
+	size_t ringOffset = 0;
+	// The index buffer holds the indices for this many quads.
+	size_t indexedQuads = 0;
+	
+	// Make sure the index buffer is big enough to draw the given number of
+	// quads. Only the number of quads in the largest frame so far matters.
+	void ReserveIndices(size_t quads)
+	{
+		if(quads <= indexedQuads)
+			return;
+		
+		indexedQuads = max<size_t>(2 * indexedQuads, max<size_t>(quads, 1024));
+		vector<GLuint> indices;
+		indices.reserve(indexedQuads * QUAD_INDICES);
+		for(GLuint i = 0; i < indexedQuads * QUAD_VERTICES; i += QUAD_VERTICES)
+		{
+			indices.push_back(i);
+			indices.push_back(i + 1);
+			indices.push_back(i + 2);
+			indices.push_back(i + 1);
+			indices.push_back(i + 3);
+			indices.push_back(i + 2);
+		}
+		// The element buffer binding is part of the VAO state, so this must be
+		// done while the VAO is bound.
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	}
 }
 
 
@@ -84,23 +127,30 @@ void BatchShader::Init()
 	
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, ringCapacity, nullptr, GL_STREAM_DRAW);
 	
-	// In this VAO, enable the two vertex arrays and specify their byte offsets.
+	glGenBuffers(1, &ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	ReserveIndices(1);
+	
+	// In this VAO, enable the two vertex arrays. Their byte offsets are set
+	// each frame, depending on where in the ring buffer the data was written.
 	glEnableVertexAttribArray(vertI);
-	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
 	glEnableVertexAttribArray(texCoordI);
-	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(2 * sizeof(float)));
 	
-	// Unbind the buffer and the VAO, but leave the vertex attrib arrays enabled
-	// in the VAO so they will be used when it is bound.
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// Unbind the VAO first, so that it still remembers the element buffer.
+	// Leave the vertex attrib arrays enabled in the VAO so they will be used
+	// when it is bound.
 	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 
 
 void BatchShader::Bind()
 {
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	// Bind the vertex buffer so we can upload data to it.
@@ -113,10 +163,57 @@ void BatchShader::Bind()
 
 
 
-void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float> &data)
+// Upload all the vertex data that will be drawn this frame.
+void BatchShader::Upload(const vector<float> &data)
+{
+	size_t size = sizeof(float) * data.size();
+	if(!size)
+		return;
+	
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+	if(size > ringCapacity)
+	{
+		// The buffer is too small to hold even a single frame. Replace it with
+		// one that can hold several.
+		ringCapacity = max(2 * ringCapacity, 4 * size);
+		glBufferData(GL_ARRAY_BUFFER, ringCapacity, nullptr, GL_STREAM_DRAW);
+		ringOffset = 0;
+	}
+	else if(ringOffset + size > ringCapacity)
+	{
+		// Orphan the old storage. The driver keeps it alive for as long as the
+		// GPU is still drawing from it, and hands back fresh memory.
+		access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+		ringOffset = 0;
+	}
+	else
+		access |= GL_MAP_INVALIDATE_RANGE_BIT;
+	
+	void *buffer = glMapBufferRange(GL_ARRAY_BUFFER, ringOffset, size, access);
+	if(buffer)
+	{
+		memcpy(buffer, data.data(), size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	
+	// Point the vertex attributes at the start of this frame's data, so that
+	// the indices can refer to vertices starting from zero.
+	glVertexAttribPointer(vertI, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE,
+		reinterpret_cast<void *>(ringOffset));
+	glVertexAttribPointer(texCoordI, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE,
+		reinterpret_cast<void *>(ringOffset + 2 * sizeof(float)));
+	ringOffset += size;
+	
+	ReserveIndices(data.size() / (QUAD_VERTICES * 5));
+}
+
+
+
+// Draw the given range of quads from the uploaded data with the given sprite.
+void BatchShader::Add(const Sprite *sprite, bool isHighDPI, size_t first, size_t count)
 {
 	// Do nothing if there are no sprites to draw.
-	if(data.empty())
+	if(!count)
 		return;
 	
 	// First, bind the proper texture.
@@ -124,11 +221,9 @@ void BatchShader::Add(const Sprite *sprite, bool isHighDPI, const vector<float>
 	// The shader also needs to know how many frames the texture has.
 	glUniform1f(frameCountI, sprite->Frames());
 	
-	// Upload the vertex data.
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * data.size(), data.data(), GL_STREAM_DRAW);
-	
-	// Draw all the vertices.
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, data.size() / 5);
+	// Draw two triangles for each quad.
+	glDrawElements(GL_TRIANGLES, count * QUAD_INDICES, GL_UNSIGNED_INT,
+		reinterpret_cast<void *>(first * QUAD_INDICES * sizeof(GLuint)));
 }
 
 
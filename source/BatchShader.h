@@ -15,19 +15,23 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 class Sprite;
 
+#include <cstddef>
 #include <vector>
 
 
 
-// Class for drawing sprites in a batch. The input to each draw command is a
-// sprite, whether it should be drawn high DPI, and the vertex data.
+// Class for drawing sprites in a batch. All the vertex data for a frame is
+// uploaded at once, into a streaming buffer that is reused as a ring. Each draw
+// command then specifies a sprite, whether it should be drawn high DPI, and the
+// range of quads (four vertices each) within that data that use that sprite.
 class BatchShader {
 public:
 	// Initialize the shaders.
 	static void Init();
 	
 	static void Bind();
-	static void Add(const Sprite *sprite, bool isHighDPI, const std::vector<float> &data);
+	static void Upload(const std::vector<float> &data);
+	static void Add(const Sprite *sprite, bool isHighDPI, size_t first, size_t count);
 	static void Unbind();
 };
 
@@ -0,0 +1,233 @@
+/* ChangeCompactor.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "ChangeCompactor.h"
+
+#include "DataNode.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+using namespace std;
+
+namespace {
+	// Information about the node that changes to an object are being merged
+	// into, and the position in the list of changes where that node is.
+	class Group {
+	public:
+		list<DataNode>::iterator node;
+		int index;
+	};
+	
+	bool IsLink(const DataNode &node)
+	{
+		return (node.Size() >= 3 && (node.Token(0) == "link" || node.Token(0) == "unlink"));
+	}
+	
+	// Check if changes of the given type can be merged. Anything else that is
+	// in the list of changes is left exactly where it is. Only systems and
+	// planets are merged: they are what events change over and over, and they
+	// are what the test of this class checks. Merging anything else would rely
+	// on how its Load() works without anything to catch it if that changes.
+	bool IsMergeable(const DataNode &node)
+	{
+		return (node.Size() >= 2 && (node.Token(0) == "planet" || node.Token(0) == "system"));
+	}
+	
+	// Keys that hold a single value, which replaces any previous value. The
+	// number with each key is how many tokens it needs to be valid.
+	const map<string, map<string, int>> SINGLE = {
+		{"planet", {{"landscape", 2}, {"music", 2}, {"government", 2},
+			{"required reputation", 2}, {"bribe", 2}, {"security", 2}}},
+		{"system", {{"pos", 3}, {"government", 2}, {"music", 2}, {"habitable", 2},
+			{"belt", 2}, {"haze", 2}}}
+	};
+	
+	// Get the key of the given child node, skipping any "add" or "remove."
+	string Key(const DataNode &child)
+	{
+		bool isAddOrRemove = (child.Token(0) == "add" || child.Token(0) == "remove");
+		const string &key = child.Token(isAddOrRemove && child.Size() >= 2);
+		// A system's "minables" are stored in the same list as its "asteroids."
+		return (key == "minables" ? "asteroids" : key);
+	}
+	
+	// Planets and systems clear certain keys the first time a node names them,
+	// unless it is an "add" or "remove." Get the key that the given child will
+	// clear if it comes first, or an empty string if it will not clear any.
+	string OverwriteKey(const string &type, const DataNode &child)
+	{
+		const string &key = child.Token(0);
+		if(key == "add" || key == "remove")
+			return string();
+		
+		if(type == "planet")
+		{
+			// "<key> clear" is a "remove <key>" rather than an overwrite.
+			if(child.Size() >= 2 && child.Token(1) == "clear")
+				return string();
+			if(key == "attributes" || key == "description" || key == "spaceport")
+				return key;
+		}
+		else if(type == "system")
+		{
+			if(key == "minables")
+				return "asteroids";
+			if(key == "asteroids" || key == "attributes" || key == "fleet" || key == "link" || key == "object")
+				return key;
+		}
+		return string();
+	}
+	
+	// Get the names of all the planets that the given system node places in
+	// the system. Loading the node tells each of them that it is in the system.
+	void AddPlanets(const DataNode &node, set<string> &planets)
+	{
+		for(const DataNode &child : node)
+		{
+			bool isAdded = (child.Token(0) == "add");
+			if(child.Size() < 1 + isAdded || child.Token(isAdded) != "object")
+				continue;
+			
+			if(child.Size() >= 2 + isAdded)
+				planets.insert(child.Token(1 + isAdded));
+			AddPlanets(child, planets);
+		}
+	}
+}
+
+
+
+// Compact the given list of changes, in place.
+void ChangeCompactor::Compact(list<DataNode> &changes)
+{
+	// A link or unlink always leaves the two systems in the same state, no
+	// matter whether they were linked before. So, only the last one for each
+	// pair of systems matters.
+	set<pair<string, string>> linked;
+	for(auto it = changes.end(); it != changes.begin(); )
+	{
+		--it;
+		if(IsLink(*it) && !linked.insert(minmax(it->Token(1), it->Token(2))).second)
+			it = changes.erase(it);
+	}
+	
+	// Merge each change into the previous change to the same object, unless
+	// that would move it past a change that it depends on. Systems depend on
+	// links to or from them, because a system node can clear its links. They
+	// also depend on other systems that place the same planets, because the
+	// order of a wormhole's systems is the order they were placed in.
+	map<pair<string, string>, Group> groups;
+	map<string, int> lastLink;
+	map<string, pair<int, string>> lastPlaced;
+	int index = 0;
+	for(auto it = changes.begin(); it != changes.end(); ++index)
+	{
+		if(IsLink(*it))
+		{
+			lastLink[it->Token(1)] = index;
+			lastLink[it->Token(2)] = index;
+		}
+		if(!IsMergeable(*it))
+		{
+			++it;
+			continue;
+		}
+		
+		const string &name = it->Token(1);
+		auto git = groups.find(make_pair(it->Token(0), name));
+		if(it->Token(0) == "system")
+		{
+			set<string> planets;
+			AddPlanets(*it, planets);
+			
+			if(git != groups.end())
+			{
+				int start = git->second.index;
+				auto lit = lastLink.find(name);
+				bool isBlocked = (lit != lastLink.end() && lit->second > start);
+				for(const string &planet : planets)
+				{
+					auto pit = lastPlaced.find(planet);
+					isBlocked |= (pit != lastPlaced.end() && pit->second.first > start && pit->second.second != name);
+				}
+				if(isBlocked)
+				{
+					groups.erase(git);
+					git = groups.end();
+				}
+			}
+			for(const string &planet : planets)
+				lastPlaced[planet] = make_pair(index, name);
+		}
+		
+		if(git == groups.end())
+		{
+			Group &group = groups[make_pair(it->Token(0), name)];
+			group.node = it;
+			group.index = index;
+			++it;
+		}
+		else
+		{
+			Merge(*git->second.node, *it);
+			it = changes.erase(it);
+		}
+	}
+}
+
+
+
+// Append the children of the second node to the first, adding whatever is
+// needed to make loading the result the same as loading the two in order.
+void ChangeCompactor::Merge(DataNode &node, const DataNode &next)
+{
+	const string &type = node.Token(0);
+	auto single = SINGLE.find(type);
+	set<string> cleared;
+	for(const DataNode &child : next)
+	{
+		// When the nodes are loaded separately, the first time the next node
+		// sets one of these keys, the key's old value is cleared. In the merged
+		// node, that key may have already been set, so clear it explicitly
+		// instead. Anything before that which changed the key can be dropped.
+		string key = OverwriteKey(type, child);
+		if(!key.empty() && cleared.insert(key).second)
+		{
+			node.children.remove_if([&key](const DataNode &it) { return Key(it) == key; });
+			AddRemove(node, key);
+		}
+		// Similarly, a key with a single value makes any earlier values of it
+		// irrelevant.
+		else if(single != SINGLE.end())
+		{
+			auto sit = single->second.find(child.Token(0));
+			if(sit != single->second.end() && child.Size() >= sit->second)
+				node.children.remove_if([&sit](const DataNode &it) { return Key(it) == sit->first; });
+		}
+		
+		node.children.push_back(child);
+		node.children.back().parent = &node;
+		node.children.back().Reparent();
+	}
+}
+
+
+
+// Add a "remove <key>" child to the given node.
+void ChangeCompactor::AddRemove(DataNode &node, const string &key)
+{
+	node.children.emplace_back(&node);
+	node.children.back().tokens = {"remove", key};
+}
@@ -0,0 +1,45 @@
+/* ChangeCompactor.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef CHANGE_COMPACTOR_H_
+#define CHANGE_COMPACTOR_H_
+
+#include <list>
+#include <string>
+
+class DataNode;
+
+
+
+// Class that shortens the list of changes that events have made to the game
+// data, by folding successive changes to the same object into one change that
+// has the same effect. A pilot who has played for a long time may have
+// thousands of changes saved, many of which redefine the same few systems and
+// planets again and again. All of them must be applied each time the pilot is
+// loaded, so without compaction, loading gets slower the longer the game goes.
+class ChangeCompactor {
+public:
+	// Compact the given list of changes, in place.
+	static void Compact(std::list<DataNode> &changes);
+	
+	
+private:
+	// Append the children of the second node to the first, adding whatever is
+	// needed to make loading the result the same as loading the two in order.
+	static void Merge(DataNode &node, const DataNode &next);
+	// Add a "remove <key>" child to the given node.
+	static void AddRemove(DataNode &node, const std::string &key);
+};
+
+
+
+#endif
@@ -41,6 +41,7 @@ namespace {
 // Initialize a collision set. The cell size and cell count should both be
 // powers of two; otherwise, they are rounded down to a power of two.
 CollisionSet::CollisionSet(unsigned cellSize, unsigned cellCount)
+	: arena(1 << 13)
 {
 	// Right shift amount to convert from (x, y) location to grid (x, y).
 	SHIFT = 0u;
@@ -65,6 +66,7 @@ CollisionSet::CollisionSet(unsigned cellSize, unsigned cellCount)
 void CollisionSet::Clear(int step)
 {
 	this->step = step;
+	arena.Reset();
 	
 	added.clear();
 	sorted.clear();
@@ -321,8 +323,10 @@ const vector<Body *> &CollisionSet::Circle(const Point &center, double radius) c
 	int maxX = static_cast<int>(center.X() + radius) >> SHIFT;
 	int maxY = static_cast<int>(center.Y() + radius) >> SHIFT;
 	
-	// Keep track of which objects we've already considered.
-	set<const Body *> seen;
+	// Keep track of which objects we've already considered. That set is only
+	// needed during this query, so its memory can be reused by the next one.
+	size_t mark = arena.Mark();
+	set<const Body *, less<const Body *>, FrameArena::Allocator<const Body *>> seen(less<const Body *>(), arena);
 	result.clear();
 	for(int y = minY; y <= maxY; ++y)
 	{
@@ -352,5 +356,23 @@ const vector<Body *> &CollisionSet::Circle(const Point &center, double radius) c
 			}
 		}
 	}
+	seen.clear();
+	arena.Rewind(mark);
 	return result;
 }
+
+
+
+// Get the number of objects in the set.
+size_t CollisionSet::Size() const
+{
+	return added.size();
+}
+
+
+
+// Get the scratch memory that was used since the set was cleared.
+const FrameArena &CollisionSet::Arena() const
+{
+	return arena;
+}
@@ -13,6 +13,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef COLLISION_SET_H_
 #define COLLISION_SET_H_
 
+#include "FrameArena.h"
+
+#include <cstddef>
 #include <vector>
 
 class Government;
@@ -50,6 +53,11 @@ public:
 	// Get all objects within the given range of the given point.
 	const std::vector<Body *> &Circle(const Point &center, double radius) const;
 	
+	// Get the number of objects in the set.
+	size_t Size() const;
+	// Get the scratch memory that was used since the set was cleared.
+	const FrameArena &Arena() const;
+	
 	
 private:
 	class Entry {
@@ -84,6 +92,8 @@ private:
 	
 	// Vector for returning the result of a circle query.
 	mutable std::vector<Body *> result;
+	// Scratch memory for circle queries, which is reset each step.
+	mutable FrameArena arena;
 };
 
 
@@ -255,6 +255,22 @@ Command Command::AndNot(Command command) const
 
 
 
+// Get the key commands as a bit mask.
+uint32_t Command::Keys() const
+{
+	return static_cast<uint32_t>(state);
+}
+
+
+
+// Set the key commands from a bit mask, leaving the fire commands alone.
+void Command::SetKeys(uint32_t keys)
+{
+	state = (state & ~0xFFFFFFFFull) | keys;
+}
+
+
+
 // Set the turn direction and amount to a value between -1 and 1.
 void Command::SetTurn(double amount)
 {
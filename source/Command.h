@@ -95,6 +95,10 @@ public:
 	bool Has(Command command) const;
 	// Get the commands that are set in this and not in the given command.
 	Command AndNot(Command command) const;
+	// Get or set the key commands as a bit mask, e.g. to record which keys the
+	// player was holding down. This ignores the turn and fire fields.
+	uint32_t Keys() const;
+	void SetKeys(uint32_t keys);
 	
 	// Get or set the turn amount. The amount must be between -1 and 1, but it
 	// can be a fractional value to allow finer control.
@@ -0,0 +1,66 @@
+/* CopyOnWrite.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef COPY_ON_WRITE_H_
+#define COPY_ON_WRITE_H_
+
+#include <memory>
+
+
+
+// Template for a value that is shared by all copies of the object that holds
+// it, until one of them needs to modify it. Copying it only copies a pointer,
+// and the value itself is not duplicated until Edit() is called on a copy that
+// is still shared. A value that has never been edited takes no memory at all.
+template <class Type>
+class CopyOnWrite {
+public:
+	const Type &operator*() const { return data ? *data : Default(); }
+	const Type *operator->() const { return &**this; }
+
+	// Get a modifiable reference to the value, copying it first if it is shared.
+	Type &Edit();
+
+
+private:
+	// The value of anything that has never been edited.
+	static const Type &Default();
+
+
+private:
+	std::shared_ptr<Type> data;
+};
+
+
+
+template <class Type>
+Type &CopyOnWrite<Type>::Edit()
+{
+	if(!data)
+		data = std::make_shared<Type>();
+	else if(data.use_count() > 1)
+		data = std::make_shared<Type>(*data);
+	return *data;
+}
+
+
+
+template <class Type>
+const Type &CopyOnWrite<Type>::Default()
+{
+	static const Type value;
+	return value;
+}
+
+
+
+#endif
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "DataNode.h"
 
+#include "Allocations.h"
 #include "Files.h"
 
 #include <algorithm>
@@ -30,6 +31,7 @@ DataNode::DataNode(const DataNode *parent)
 	// capacity for four tokens. This makes file loading slightly faster, at the
 	// cost of DataFiles taking up a bit more memory.
 	tokens.reserve(4);
+	Allocations::Add(Allocations::DATA_NODES, sizeof(DataNode));
 }
 
 
@@ -39,6 +41,14 @@ DataNode::DataNode(const DataNode &other)
 	: children(other.children), tokens(other.tokens)
 {
 	Reparent();
+	Allocations::Add(Allocations::DATA_NODES, sizeof(DataNode));
+}
+
+
+
+DataNode::~DataNode()
+{
+	Allocations::Remove(Allocations::DATA_NODES, sizeof(DataNode));
 }
 
 
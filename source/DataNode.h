@@ -32,6 +32,8 @@ public:
 	explicit DataNode(const DataNode *parent = nullptr);
 	// Copy constructor.
 	DataNode(const DataNode &other);
+	// The destructor only keeps track of how many nodes exist.
+	~DataNode();
 	
 	DataNode &operator=(const DataNode &other);
 	
@@ -71,6 +73,8 @@ private:
 	
 	// Allow DataFile to modify the internal structure of DataNodes.
 	friend class DataFile;
+	// ChangeCompactor needs to combine the children of multiple nodes.
+	friend class ChangeCompactor;
 };
 
 
@@ -0,0 +1,161 @@
+/* DotShader.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "DotShader.h"
+
+#include "Color.h"
+#include "Font.h"
+#include "Screen.h"
+#include "Shader.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+	Shader shader;
+	GLint scaleI;
+	GLint colorI;
+	
+	GLuint vao;
+	GLuint vbo;
+	
+	// Each dot is drawn as two triangles. Each vertex has a screen position,
+	// an offset from the center of the dot, and the dot's outer radius.
+	const int FLOATS_PER_VERTEX = 5;
+	const int VERTICES_PER_DOT = 6;
+	const float CORNERS[VERTICES_PER_DOT][2] = {
+		{-1.f, -1.f}, {1.f, -1.f}, {-1.f, 1.f},
+		{-1.f, 1.f}, {1.f, -1.f}, {1.f, 1.f}
+	};
+	
+	// Scratch space for building the vertex data. Only the drawing thread
+	// uses this shader, so there is no need to guard it.
+	vector<float> vertices;
+}
+
+
+
+void DotShader::Init()
+{
+	static const char *vertexCode =
+		"uniform vec2 scale;\n"
+		
+		"in vec2 vert;\n"
+		"in vec2 offset;\n"
+		"in float outer;\n"
+		"out vec2 coord;\n"
+		"out float radius;\n"
+		
+		"void main() {\n"
+		"  coord = offset;\n"
+		"  radius = outer;\n"
+		"  gl_Position = vec4(vert * scale, 0, 1);\n"
+		"}\n";
+	
+	static const char *fragmentCode =
+		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
+		
+		"in vec2 coord;\n"
+		"in float radius;\n"
+		"out vec4 finalColor;\n"
+		
+		"void main() {\n"
+		"  float len = length(coord);\n"
+		"  float alpha = clamp(min(radius - len, len + 1), 0, 1);\n"
+		"  finalColor = color * alpha;\n"
+		"}\n";
+	
+	shader = Shader(vertexCode, fragmentCode);
+	scaleI = shader.Uniform("scale");
+	colorI = shader.Uniform("color");
+	
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	
+	constexpr auto stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+	glEnableVertexAttribArray(shader.Attrib("vert"));
+	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, stride, nullptr);
+	
+	glEnableVertexAttribArray(shader.Attrib("offset"));
+	glVertexAttribPointer(shader.Attrib("offset"), 2, GL_FLOAT, GL_FALSE, stride,
+		reinterpret_cast<const GLvoid *>(2 * sizeof(GLfloat)));
+	
+	glEnableVertexAttribArray(shader.Attrib("outer"));
+	glVertexAttribPointer(shader.Attrib("outer"), 1, GL_FLOAT, GL_FALSE, stride,
+		reinterpret_cast<const GLvoid *>(4 * sizeof(GLfloat)));
+	
+	// unbind the VBO and VAO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+
+
+void DotShader::Bind()
+{
+	if(!shader.Object())
+		throw runtime_error("DotShader: Bind() called before Init().");
+	
+	Font::Flush();
+	glUseProgram(shader.Object());
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	
+	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
+	glUniform2fv(scaleI, 1, scale);
+}
+
+
+
+void DotShader::Add(const vector<float> &dots, const Color &color)
+{
+	size_t count = dots.size() / 3;
+	if(!count)
+		return;
+	
+	vertices.clear();
+	vertices.reserve(count * VERTICES_PER_DOT * FLOATS_PER_VERTEX);
+	for(size_t i = 0; i < count; ++i)
+	{
+		float x = dots[3 * i];
+		float y = dots[3 * i + 1];
+		float outer = dots[3 * i + 2];
+		for(const float *corner : CORNERS)
+		{
+			float dx = corner[0] * outer;
+			float dy = corner[1] * outer;
+			vertices.insert(vertices.end(), {x + dx, y + dy, dx, dy, outer});
+		}
+	}
+	
+	// Orphan the old contents so the driver does not have to wait for any
+	// draw calls that are still using them.
+	GLsizeiptr size = vertices.size() * sizeof(float);
+	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+	
+	glUniform4fv(colorI, 1, color.Get());
+	glDrawArrays(GL_TRIANGLES, 0, count * VERTICES_PER_DOT);
+}
+
+
+
+void DotShader::Unbind()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
@@ -0,0 +1,38 @@
+/* DotShader.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef DOT_SHADER_H_
+#define DOT_SHADER_H_
+
+#include <vector>
+
+class Color;
+
+
+
+// Class for drawing many filled-in round dots of the same color with a single
+// draw call, e.g. for the radar display. The dots look the same as the ones
+// that RingShader draws when the inner radius is zero.
+class DotShader {
+public:
+	static void Init();
+	
+	static void Bind();
+	// Draw a batch of dots. Each dot is given by three values: the x and y
+	// coordinates of its center, in screen units, and its outer radius.
+	static void Add(const std::vector<float> &dots, const Color &color);
+	static void Unbind();
+};
+
+
+
+#endif
@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Body.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Screen.h"
 #include "Sprite.h"
 #include "SpriteSet.h"
@@ -113,6 +114,7 @@ bool DrawList::AddSwizzled(const Body &body, int swizzle)
 // Draw all the items in this list.
 void DrawList::Draw() const
 {
+	Profiler::Zone zone("DrawList::Draw");
 	SpriteShader::Bind();
 	
 	bool withBlur = Preferences::Has("Render motion blur");
@@ -124,6 +126,14 @@ void DrawList::Draw() const
 
 
 
+// Get the number of items in this list.
+size_t DrawList::Size() const
+{
+	return items.size();
+}
+
+
+
 bool DrawList::Cull(const Body &body, const Point &position, const Point &blur) const
 {
 	if(!body.HasSprite() || !body.Zoom())
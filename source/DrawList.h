@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Point.h"
 #include "SpriteShader.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -44,6 +45,8 @@ public:
 	
 	// Draw all the items in this list.
 	void Draw() const;
+	// Get the number of items in this list.
+	size_t Size() const;
 	
 	
 private:
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Engine.h"
 
+#include "Allocations.h"
 #include "Audio.h"
 #include "Effect.h"
 #include "FillShader.h"
@@ -38,9 +39,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "PointerShader.h"
 #include "Politics.h"
 #include "Preferences.h"
+#include "Profiler.h"
 #include "Projectile.h"
 #include "Random.h"
+#include "Replay.h"
 #include "RingShader.h"
+#include "Scenario.h"
 #include "Screen.h"
 #include "Ship.h"
 #include "ShipEvent.h"
@@ -52,10 +56,16 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "StellarObject.h"
 #include "System.h"
 #include "Visual.h"
+#include "WellKnown.h"
 #include "WrappedText.h"
 
+#include <SDL2/SDL.h>
+
 #include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <cmath>
+#include <cstring>
 #include <string>
 
 using namespace std;
@@ -159,6 +169,17 @@ namespace {
 	}
 	
 	const double RADAR_SCALE = .025;
+	
+	// Get how many steps can be waiting to be calculated before the drawing
+	// thread has to wait for the calculation thread to catch up. Recordings
+	// are only exact if the input for each step is read after the step before
+	// it was calculated, so steps are only queued up in normal play.
+	int QueueDepth()
+	{
+		if(Replay::IsPlaying() || Replay::IsRecording() || Scenario::IsRunning())
+			return 1;
+		return 1 + Preferences::StepsAhead();
+	}
 }
 
 
@@ -168,6 +189,11 @@ Engine::Engine(PlayerInfo &player)
 	shipCollisions(256u, 32u)
 {
 	zoom = Preferences::ViewZoom();
+	for(Frame &frame : frames)
+	{
+		frame.zoom = zoom;
+		frame.radar.SetScale(RADAR_SCALE);
+	}
 	
 	// Start the thread for doing calculations.
 	calcThread = thread(&Engine::ThreadEntryPoint, this);
@@ -186,17 +212,19 @@ Engine::Engine(PlayerInfo &player)
 		center = object->Position();
 	
 	// Now we know the player's current position. Draw the planets.
-	draw[calcTickTock].Clear(step, zoom);
-	draw[calcTickTock].SetCenter(center);
-	radar[calcTickTock].SetCenter(center);
+	Frame &frame = frames[calcFrame];
+	frame.center = center;
+	frame.draw.Clear(step, zoom);
+	frame.draw.SetCenter(center);
+	frame.radar.SetCenter(center);
 	const Ship *flagship = player.Flagship();
 	for(const StellarObject &object : player.GetSystem()->Objects())
 		if(object.HasSprite())
 		{
-			draw[calcTickTock].Add(object);
+			frame.draw.Add(object);
 			
 			double r = max(2., object.Radius() * .03 + .5);
-			radar[calcTickTock].Add(object.RadarType(flagship), object.Position(), r, r - 1.);
+			frame.radar.Add(object.RadarType(flagship), object.Position(), r, r - 1.);
 		}
 	
 	// Add all neighboring systems to the radar.
@@ -204,7 +232,7 @@ Engine::Engine(PlayerInfo &player)
 	const set<const System *> &links = (flagship && flagship->Attributes().Get("jump drive")) ?
 		player.GetSystem()->Neighbors() : player.GetSystem()->Links();
 	for(const System *system : links)
-		radar[calcTickTock].AddPointer(
+		frame.radar.AddPointer(
 			(system == targetSystem) ? Radar::SPECIAL : Radar::INACTIVE,
 			system->Position() - player.GetSystem()->Position());
 	
@@ -221,12 +249,17 @@ Engine::~Engine()
 	}
 	condition.notify_all();
 	calcThread.join();
+	Allocations::Set(Allocations::ENGINE, 0, 0);
 }
 
 
 
 void Engine::Place()
 {
+	// Placing the ships uses the same random numbers each time this pilot's
+	// game is loaded.
+	Replay::Begin(player, step);
+	Random::Stream stream(player.Seed(), step, 0, Random::PLACE);
 	ships.clear();
 	ai.ClearOrders();
 	
@@ -373,39 +406,33 @@ void Engine::Place(const list<NPC> &npcs, shared_ptr<Ship> flagship)
 
 
 
-// Wait for the previous calculations (if any) to be done.
+// Wait until no more steps are queued up than the player allows, then pause
+// the calculation thread between steps so the game state can be accessed.
 void Engine::Wait()
 {
 	unique_lock<mutex> lock(swapMutex);
-	while(calcTickTock != drawTickTock)
+	// If the calculation thread is already paused, it cannot catch up.
+	int depth = QueueDepth();
+	while(queued >= depth && !isPaused)
+		condition.wait(lock);
+	// Don't let it start on any of the steps that are still queued up until
+	// the next one has been added, but let it finish the one it is on.
+	isPaused = true;
+	while(isCalculating)
 		condition.wait(lock);
 }
 
 
 
-// Begin the next step of calculations.
+// Read the input for the next step, and do any work that can only be done
+// while the calculation thread is paused (for thread safety reasons).
 void Engine::Step(bool isActive)
 {
-	events.swap(eventQueue);
-	eventQueue.clear();
-	
 	// The calculation thread is now paused, so it is safe to access things.
+	UpdateMemory();
 	const shared_ptr<Ship> flagship = player.FlagshipPtr();
-	const StellarObject *object = player.GetStellarObject();
-	if(object)
-	{
-		center = object->Position();
-		centerVelocity = Point();
-	}
-	else if(flagship)
+	if(flagship)
 	{
-		center = flagship->Position();
-		centerVelocity = flagship->Velocity();
-		if(doEnter && flagship->Zoom() == 1. && !flagship->IsHyperspacing())
-		{
-			doEnter = false;
-			events.emplace_back(flagship, flagship, ShipEvent::JUMP);
-		}
 		if(flagship->IsEnteringHyperspace() || flagship->Commands().Has(Command::JUMP))
 		{
 			if(jumpCount < 100)
@@ -420,11 +447,57 @@ void Engine::Step(bool isActive)
 		}
 		else if(jumpCount > 0)
 			--jumpCount;
+		
+		// Load the sprites for the next system the flagship will jump to, so
+		// that they are ready before it arrives.
+		const System *next = flagship->GetTargetSystem();
+		if(!next && player.HasTravelPlan())
+			next = player.TravelPlan().back();
+		// Only do this when the destination changes, and once more when the
+		// jump begins, because a sprite that is not drawn is only kept loaded
+		// for ten seconds.
+		bool isEnteringHyperspace = flagship->IsEnteringHyperspace();
+		if(next != prefetched || (isEnteringHyperspace && !wasEnteringHyperspace))
+			GameData::Prefetch(next, flagship->GetSystem());
+		prefetched = next;
+		wasEnteringHyperspace = isEnteringHyperspace;
+	}
+	
+	// Measuring text can only be done in this thread, so the planet labels and
+	// the target's name are added here to the frame that will be drawn next.
+	// The game state matches that frame, because the calculation thread was
+	// paused right after finishing it.
+	Frame &frame = frames[doneFrame];
+	frame.labels.clear();
+	const System *currentSystem = player.GetSystem();
+	if(currentSystem && Preferences::Has("Show planet labels"))
+	{
+		for(const StellarObject &object : currentSystem->Objects())
+		{
+			if(!object.GetPlanet() || !object.GetPlanet()->IsAccessible(flagship.get()))
+				continue;
+			
+			Point pos = object.Position() - frame.center;
+			if(pos.Length() - object.Radius() < 600. / frame.zoom)
+				frame.labels.emplace_back(pos, object, currentSystem, frame.zoom);
+		}
+	}
+	shared_ptr<const Ship> target = flagship ? flagship->GetTargetShip() : nullptr;
+	if(target)
+		frame.info.SetString("target name", FontSet::Get(14).TruncateMiddle(target->Name(), 150));
+	
+	Command keys;
+	bool hasShift = false;
+	if(!Replay::IsPlaying() && !Scenario::IsRunning())
+	{
+		keys.ReadKeyboard();
+		hasShift = (SDL_GetModState() & KMOD_SHIFT);
 	}
-	ai.UpdateEvents(events);
-	ai.UpdateKeys(player, clickCommands, isActive && wasActive);
-	wasActive = isActive;
-	Audio::Update(center);
+	// Record this step's input, or replace it with the recorded input. Steps
+	// are never queued up while recording or playing back, so the calculation
+	// thread is not using the click commands.
+	Replay::Input(*this, keys, hasShift, clickCommands, isActive, zoom);
+	Audio::Update(frame.center);
 	
 	// Smoothly zoom in and out.
 	if(isActive)
@@ -446,367 +519,85 @@ void Engine::Step(bool isActive)
 		}
 	}
 	
-	// Draw a highlight to distinguish the flagship from other ships.
-	if(flagship && !flagship->IsDestroyed() && Preferences::Has("Highlight player's flagship"))
-	{
-		highlightSprite = flagship->GetSprite();
-		highlightUnit = flagship->Unit() * zoom;
-		highlightFrame = flagship->GetFrame();
-	}
-	else
-		highlightSprite = nullptr;
-		
-	// Any of the player's ships that are in system are assumed to have
-	// landed along with the player.
-	if(flagship && flagship->GetPlanet() && isActive)
-		player.SetPlanet(flagship->GetPlanet());
-	
-	const System *currentSystem = player.GetSystem();
-	// Update this here, for thread safety.
-	if(!player.HasTravelPlan() && flagship && flagship->GetTargetSystem())
-		player.TravelPlan().push_back(flagship->GetTargetSystem());
-	if(player.HasTravelPlan() && currentSystem == player.TravelPlan().back())
-		player.PopTravel();
-	if(doFlash)
-	{
-		flash = .4;
-		doFlash = false;
-	}
-	else if(flash)
-		flash = max(0., flash * .99 - .002);
-	
-	targets.clear();
-	
-	// Update the player's ammo amounts.
-	ammo.clear();
-	if(flagship)
-		for(const auto &it : flagship->Outfits())
-		{
-			if(!it.first->Icon())
-				continue;
-			
-			if(it.first->Ammo())
-				ammo.emplace_back(it.first,
-					flagship->OutfitCount(it.first->Ammo()));
-			else if(it.first->FiringFuel())
-			{
-				double remaining = flagship->Fuel()
-					* flagship->Attributes().Get("fuel capacity");
-				ammo.emplace_back(it.first,
-					remaining / it.first->FiringFuel());
-			}
-			else
-				ammo.emplace_back(it.first, -1);
-		}
-	
-	// Display escort information for all ships of the "Escort" government,
-	// and all ships with the "escort" personality, except for fighters that
-	// are not owned by the player.
-	escorts.Clear();
-	bool fleetIsJumping = (flagship && flagship->Commands().Has(Command::JUMP));
-	for(const auto &it : ships)
-		if(it->GetGovernment()->IsPlayer() || it->GetPersonality().IsEscort())
-			if(!it->IsYours() && !it->CanBeCarried())
-			{
-				bool isSelected = (flagship && flagship->GetTargetShip() == it);
-				escorts.Add(*it, it->GetSystem() == currentSystem, fleetIsJumping, isSelected);
-			}
-	for(const shared_ptr<Ship> &escort : player.Ships())
-		if(!escort->IsParked() && escort != flagship && !escort->IsDestroyed())
-		{
-			// Check if this escort is selected.
-			bool isSelected = false;
-			for(const weak_ptr<Ship> &ptr : player.SelectedShips())
-				if(ptr.lock() == escort)
-				{
-					isSelected = true;
-					break;
-				}
-			escorts.Add(*escort, escort->GetSystem() == currentSystem, fleetIsJumping, isSelected);
-		}
-	
-	// Create the status overlays.
-	statuses.clear();
-	if(isActive && Preferences::Has("Show status overlays"))
-		for(const auto &it : ships)
-		{
-			if(!it->GetGovernment() || it->GetSystem() != currentSystem || it->Cloaking() == 1.)
-				continue;
-			// Don't show status for dead ships.
-			if(it->IsDestroyed())
-				continue;
-			
-			bool isEnemy = it->GetGovernment()->IsEnemy();
-			if(isEnemy || it->IsYours() || it->GetPersonality().IsEscort())
-			{
-				double width = min(it->Width(), it->Height());
-				statuses.emplace_back(it->Position() - center, it->Shields(), it->Hull(),
-					max(20., width * .5), isEnemy);
-			}
-		}
-	
-	// Create the planet labels.
-	labels.clear();
-	if(currentSystem && Preferences::Has("Show planet labels"))
-	{
-		for(const StellarObject &object : currentSystem->Objects())
-		{
-			if(!object.GetPlanet() || !object.GetPlanet()->IsAccessible(flagship.get()))
-				continue;
-			
-			Point pos = object.Position() - center;
-			if(pos.Length() - object.Radius() < 600. / zoom)
-				labels.emplace_back(pos, object, currentSystem, zoom);
-		}
-	}
-	
-	if(flagship && flagship->IsOverheated())
-		Messages::Add("Your ship has overheated.");
-	
-	// Clear the HUD information from the previous frame.
-	info = Information();
-	if(flagship && flagship->Hull())
-	{
-		Point shipFacingUnit(0., -1.);
-		if(Preferences::Has("Rotate flagship in HUD"))
-			shipFacingUnit = flagship->Facing().Unit();
-		
-		info.SetSprite("player sprite", flagship->GetSprite(), shipFacingUnit, flagship->GetFrame(step));
-	}
-	if(currentSystem)
-		info.SetString("location", currentSystem->Name());
-	info.SetString("date", player.GetDate().ToString());
-	if(flagship)
-	{
-		info.SetBar("fuel", flagship->Fuel(),
-			flagship->Attributes().Get("fuel capacity") * .01);
-		info.SetBar("energy", flagship->Energy());
-		double heat = flagship->Heat();
-		info.SetBar("heat", min(1., heat));
-		// If heat is above 100%, draw a second overlaid bar to indicate the
-		// total heat level.
-		if(heat > 1.)
-			info.SetBar("overheat", min(1., heat - 1.));
-		if(flagship->IsOverheated() && (step / 20) % 2)
-			info.SetBar("overheat blink", min(1., heat));
-		info.SetBar("shields", flagship->Shields());
-		info.SetBar("hull", flagship->Hull(), 20.);
-		info.SetBar("disabled hull", min(flagship->Hull(), flagship->DisabledHull()), 20.);
-	}
-	info.SetString("credits",
-		Format::Credits(player.Accounts().Credits()) + " credits");
-	bool isJumping = flagship && (flagship->Commands().Has(Command::JUMP) || flagship->IsEnteringHyperspace());
-	if(flagship && flagship->GetTargetStellar() && !isJumping)
-	{
-		const StellarObject *object = flagship->GetTargetStellar();
-		string navigationMode = flagship->Commands().Has(Command::LAND) ? "Landing on:" :
-			object->GetPlanet() && object->GetPlanet()->CanLand(*flagship) ? "Can land on:" :
-			"Cannot land on:";
-		info.SetString("navigation mode", navigationMode);
-		const string &name = object->Name();
-		info.SetString("destination", name);
-		
-		targets.push_back({
-			object->Position() - center,
-			object->Facing(),
-			object->Radius(),
-			object->GetPlanet()->CanLand() ? Radar::FRIENDLY : Radar::HOSTILE,
-			5});
-	}
-	else if(flagship && flagship->GetTargetSystem())
-	{
-		info.SetString("navigation mode", "Hyperspace:");
-		if(player.HasVisited(flagship->GetTargetSystem()))
-			info.SetString("destination", flagship->GetTargetSystem()->Name());
-		else
-			info.SetString("destination", "unexplored system");
-	}
-	else
-	{
-		info.SetString("navigation mode", "Navigation:");
-		info.SetString("destination", "no destination");
-	}
-	// Use the radar that was just populated. (The draw tick-tock has not
-	// yet been toggled, but it will be at the end of this function.)
-	shared_ptr<const Ship> target;
-	shared_ptr<const Minable> targetAsteroid;
-	targetVector = Point();
-	if(flagship)
-	{
-		target = flagship->GetTargetShip();
-		targetAsteroid = flagship->GetTargetAsteroid();
-		// Record that the player knows this type of asteroid is available here.
-		if(targetAsteroid)
-			for(const auto &it : targetAsteroid->Payload())
-				player.Harvest(it.first);
-	}
-	if(!target)
-		targetSwizzle = -1;
-	if(!target && !targetAsteroid)
-		info.SetString("target name", "no target");
-	else if(!target)
-	{
-		info.SetSprite("target sprite",
-			targetAsteroid->GetSprite(),
-			targetAsteroid->Facing().Unit(),
-			targetAsteroid->GetFrame(step));
-		info.SetString("target name", Format::Capitalize(targetAsteroid->Name()) + " Asteroid");
-		
-		targetVector = targetAsteroid->Position() - center;
-		
-		if(flagship->Attributes().Get("tactical scan power"))
-		{
-			info.SetCondition("range display");
-			int targetRange = round(targetAsteroid->Position().Distance(flagship->Position()));
-			info.SetString("target range", to_string(targetRange));
-		}
-	}
-	else
-	{
-		const Font &font = FontSet::Get(14);
-		if(target->GetSystem() == player.GetSystem() && target->Cloaking() < 1.)
-			targetUnit = target->Facing().Unit();
-		info.SetSprite("target sprite", target->GetSprite(), targetUnit, target->GetFrame(step));
-		info.SetString("target name", font.TruncateMiddle(target->Name(), 150));
-		info.SetString("target type", target->ModelName());
-		if(!target->GetGovernment())
-			info.SetString("target government", "No Government");
-		else
-			info.SetString("target government", target->GetGovernment()->GetName());
-		targetSwizzle = target->GetSwizzle();
-		info.SetString("mission target", target->GetPersonality().IsTarget() ? "(mission target)" : "");
-		
-		int targetType = RadarType(*target, step);
-		info.SetOutlineColor(Radar::GetColor(targetType));
-		if(target->GetSystem() == player.GetSystem() && target->IsTargetable())
-		{
-			info.SetBar("target shields", target->Shields());
-			info.SetBar("target hull", target->Hull(), 20.);
-			info.SetBar("target disabled hull", min(target->Hull(), target->DisabledHull()), 20.);
-		
-			// The target area will be a square, with sides proportional to the average
-			// of the width and the height of the sprite.
-			double size = (target->Width() + target->Height()) * .35;
-			targets.push_back({
-				target->Position() - center,
-				Angle(45.) + target->Facing(),
-				size,
-				targetType,
-				4});
-			
-			targetVector = target->Position() - center;
-			
-			// Check if the target is close enough to show tactical information.
-			double tacticalRange = 100. * sqrt(flagship->Attributes().Get("tactical scan power"));
-			double targetRange = target->Position().Distance(flagship->Position());
-			if(tacticalRange)
-			{
-				info.SetCondition("range display");
-				info.SetString("target range", to_string(static_cast<int>(round(targetRange))));
-			}
-			// Actual tactical information requires a scrutable
-			// target that is within the tactical scanner range.
-			if((targetRange <= tacticalRange && !target->Attributes().Get("inscrutable"))
-					|| (tacticalRange && target->IsYours()))
-			{
-				info.SetCondition("tactical display");
-				info.SetString("target crew", to_string(target->Crew()));
-				int fuel = round(target->Fuel() * target->Attributes().Get("fuel capacity"));
-				info.SetString("target fuel", to_string(fuel));
-				int energy = round(target->Energy() * target->Attributes().Get("energy capacity"));
-				info.SetString("target energy", to_string(energy));
-				int heat = round(100. * target->Heat());
-				info.SetString("target heat", to_string(heat) + "%");
-			}
-		}
-	}
-	if(target && target->IsTargetable() && target->GetSystem() == currentSystem
-		&& (flagship->CargoScanFraction() || flagship->OutfitScanFraction()))
-	{
-		double width = max(target->Width(), target->Height());
-		Point pos = target->Position() - center;
-		statuses.emplace_back(pos, flagship->OutfitScanFraction(), flagship->CargoScanFraction(),
-			10. + max(20., width * .5), 2, Angle(pos).Degrees() + 180.);
-	}
-	// Handle any events that change the selected ships.
-	if(groupSelect >= 0)
-	{
-		// This has to be done in Step() to avoid race conditions.
-		if(hasControl)
-			player.SetGroup(groupSelect);
-		else
-			player.SelectGroup(groupSelect, hasShift);
-		groupSelect = -1;
-	}
-	if(doClickNextStep)
-	{
-		// If a click command is issued, always wait until the next step to act
-		// on it, to avoid race conditions.
-		doClick = true;
-		doClickNextStep = false;
-	}
-	else
-		doClick = false;
+	// Any clicks since the last step are part of this step's input. If a click
+	// command is issued, always wait until the next step to act on it, to avoid
+	// race conditions.
+	Input input = clicks;
+	clicks.doClick = false;
+	clicks.groupSelect = -1;
+	input.keys = keys;
+	input.hasShift = hasShift;
+	input.isActive = isActive;
+	input.zoom = zoom;
+	input.hasInput = true;
+	// Escort icons are laid out when they are drawn, so check which one was
+	// clicked on in the frame that was drawn last.
+	if(input.doClick && !input.isRightClick)
+		input.clickStack = frames[drawFrame].escorts.Click(input.clickPoint);
 	
-	if(doClick && !isRightClick)
 	{
-		doClick = !player.SelectShips(clickBox, hasShift);
-		if(doClick)
+		unique_lock<mutex> lock(swapMutex);
+		// If the game is paused while steps are still waiting to be calculated,
+		// drop them instead of calculating them once the player has landed.
+		if(!isActive && queued)
 		{
-			const vector<const Ship *> &stack = escorts.Click(clickPoint);
-			if(!stack.empty())
-				doClick = !player.SelectShips(stack, hasShift);
-			else
-				clickPoint /= isRadarClick ? RADAR_SCALE : zoom;
+			inputs.clear();
+			queued = 0;
 		}
-	}
-	
-	// Draw crosshairs on all the selected ships.
-	for(const weak_ptr<Ship> &selected : player.SelectedShips())
-	{
-		shared_ptr<Ship> ship = selected.lock();
-		if(ship && ship != target && !ship->IsParked() && ship->GetSystem() == player.GetSystem()
-				&& !ship->IsDestroyed() && ship->Zoom() > 0.)
+		// If the calculation thread has caught up, the input can be used now.
+		// Otherwise it has to wait until the steps before it are calculated.
+		if(queued)
 		{
-			double size = (ship->Width() + ship->Height()) * .35;
-			targets.push_back({
-				ship->Position() - center,
-				Angle(45.) + ship->Facing(),
-				size,
-				Radar::PLAYER,
-				4});
+			inputs.push_back(input);
+			return;
 		}
 	}
-	
-	// Draw crosshairs on any minables in range of the flagship's scanners.
-	double scanRange = flagship ? 100. * sqrt(flagship->Attributes().Get("asteroid scan power")) : 0.;
-	if(flagship && scanRange && !flagship->IsHyperspacing())
-		for(const shared_ptr<Minable> &minable : asteroids.Minables())
-		{
-			Point offset = minable->Position() - center;
-			if(offset.Length() > scanRange)
-				continue;
-			
-			targets.push_back({
-				offset,
-				minable->Facing(),
-				.8 * minable->Radius(),
-				minable == flagship->GetTargetAsteroid() ? Radar::SPECIAL : Radar::INACTIVE,
-				3});
-		}
+	HandleInput(input);
 }
 
 
 
-// Begin the next step of calculations.
+// Queue up the next step of calculations.
 void Engine::Go()
 {
+	Replay::Go();
+	bool isNew = false;
 	{
 		unique_lock<mutex> lock(swapMutex);
-		++step;
-		drawTickTock = !drawTickTock;
+		// If no input was queued since the last step, the next step is
+		// calculated using the input that was already handled.
+		if(inputs.empty() || inputs.back().go)
+		{
+			inputs.emplace_back();
+			inputs.back().zoom = zoom;
+		}
+		Input &input = inputs.back();
+		input.go = true;
+		// The next step reflects the input that was read in this frame.
+		input.timing.input = FrameQueue::Time(FrameQueue::INPUT);
+		input.timing.step = FrameQueue::Clock::now();
+		++queued;
+		isPaused = false;
+		
+		// Draw the most recently calculated step. The calculation thread never
+		// writes to that frame until a newer one is being drawn.
+		isNew = (drawFrame != doneFrame);
+		drawFrame = doneFrame;
 	}
 	condition.notify_all();
+	
+	// The step that will be drawn next determines how much latency this frame
+	// has. If no new step is ready, the previous one is drawn again.
+	const Frame &shown = frames[drawFrame];
+	if(shown.timing.end != FrameQueue::Clock::time_point())
+	{
+		FrameQueue::Mark(FrameQueue::INPUT, shown.timing.input);
+		FrameQueue::Mark(FrameQueue::STEP, shown.timing.step);
+		FrameQueue::Mark(FrameQueue::CALCULATE, shown.timing.start);
+		FrameQueue::Mark(FrameQueue::CALCULATED, shown.timing.end);
+		if(isNew)
+			performance.Add(shown.sample);
+	}
 }
 
 
@@ -823,18 +614,20 @@ list<ShipEvent> &Engine::Events()
 // Draw a frame.
 void Engine::Draw() const
 {
-	GameData::Background().Draw(center, centerVelocity, zoom);
+	Profiler::Zone zone("Engine::Draw");
+	const Frame &frame = frames[drawFrame];
+	GameData::Background().Draw(frame.center, frame.centerVelocity, frame.zoom);
 	static const Set<Color> &colors = GameData::Colors();
 	const Interface *interface = GameData::Interfaces().Get("hud");
 	
 	// Draw any active planet labels.
-	for(const PlanetLabel &label : labels)
+	for(const PlanetLabel &label : frame.labels)
 		label.Draw();
 	
-	draw[drawTickTock].Draw();
-	batchDraw[drawTickTock].Draw();
+	frame.draw.Draw();
+	frame.batchDraw.Draw();
 	
-	for(const auto &it : statuses)
+	for(const auto &it : frame.statuses)
 	{
 		static const Color color[6] = {
 			*colors.Get("overlay friendly shields"),
@@ -844,31 +637,31 @@ void Engine::Draw() const
 			*colors.Get("overlay hostile hull"),
 			*colors.Get("overlay cargo scan")
 		};
-		Point pos = it.position * zoom;
-		double radius = it.radius * zoom;
+		Point pos = it.position * frame.zoom;
+		double radius = it.radius * frame.zoom;
 		if(it.outer > 0.)
 			RingShader::Draw(pos, radius + 3., 1.5f, it.outer, color[it.type], 0.f, it.angle);
-		double dashes = (it.type >= 2) ? 0. : 20. * min(1., zoom);
+		double dashes = (it.type >= 2) ? 0. : 20. * min(1., frame.zoom);
 		if(it.inner > 0.)
 			RingShader::Draw(pos, radius, 1.5f, it.inner, color[3 + it.type], dashes, it.angle);
 	}
 	
 	// Draw the flagship highlight, if any.
-	if(highlightSprite)
+	if(frame.highlightSprite)
 	{
-		Point size(highlightSprite->Width(), highlightSprite->Height());
+		Point size(frame.highlightSprite->Width(), frame.highlightSprite->Height());
 		const Color &color = *colors.Get("flagship highlight");
 		// The flagship is always in the dead center of the screen.
-		OutlineShader::Draw(highlightSprite, Point(), size, color, highlightUnit, highlightFrame);
+		OutlineShader::Draw(frame.highlightSprite, Point(), size, color, frame.highlightUnit, frame.highlightFrame);
 	}
 	
-	if(flash)
-		FillShader::Fill(Point(), Point(Screen::Width(), Screen::Height()), Color(flash, flash));
+	if(frame.flash)
+		FillShader::Fill(Point(), Point(Screen::Width(), Screen::Height()), Color(frame.flash, frame.flash));
 	
 	// Draw messages. Draw the most recent messages first, as some messages
 	// may be wrapped onto multiple lines.
 	const Font &font = FontSet::Get(14);
-	const vector<Messages::Entry> &messages = Messages::Get(step);
+	const vector<Messages::Entry> &messages = Messages::Get(frame.step);
 	Rectangle messageBox = interface->GetBox("messages");
 	WrappedText messageLine(font);
 	messageLine.SetWrapWidth(messageBox.Width());
@@ -880,56 +673,56 @@ void Engine::Draw() const
 		messagePoint.Y() -= messageLine.Height();
 		if(messagePoint.Y() < messageBox.Top())
 			break;
-		float alpha = (it->step + 1000 - step) * .001f;
+		float alpha = (it->step + 1000 - frame.step) * .001f;
 		Color color(alpha, 0.f);
 		messageLine.Draw(messagePoint, color);
 	}
 	
 	// Draw crosshairs around anything that is targeted.
-	for(const Target &target : targets)
+	for(const Target &target : frame.targets)
 	{
 		Angle a = target.angle;
 		Angle da(360. / target.count);
 		
 		for(int i = 0; i < target.count; ++i)
 		{
-			PointerShader::Draw(target.center * zoom, a.Unit(), 12.f, 14.f, -target.radius * zoom,
+			PointerShader::Draw(target.center * frame.zoom, a.Unit(), 12.f, 14.f, -target.radius * frame.zoom,
 				Radar::GetColor(target.type));
 			a += da;
 		}
 	}
 	
 	// Draw the heads-up display.
-	interface->Draw(info);
+	interface->Draw(frame.info);
 	if(interface->HasPoint("radar"))
 	{
-		radar[drawTickTock].Draw(
+		frame.radar.Draw(
 			interface->GetPoint("radar"),
 			RADAR_SCALE,
 			interface->GetValue("radar radius"),
 			interface->GetValue("radar pointer radius"));
 	}
-	if(interface->HasPoint("target") && targetVector.Length() > 20.)
+	if(interface->HasPoint("target") && frame.targetVector.Length() > 20.)
 	{
 		Point center = interface->GetPoint("target");
 		double radius = interface->GetValue("target radius");
-		PointerShader::Draw(center, targetVector.Unit(), 10.f, 10.f, radius, Color(1.f));
+		PointerShader::Draw(center, frame.targetVector.Unit(), 10.f, 10.f, radius, Color(1.f));
 	}
 	
 	// Draw the faction markers.
-	if(targetSwizzle >= 0 && interface->HasPoint("faction markers"))
+	if(frame.targetSwizzle >= 0 && interface->HasPoint("faction markers"))
 	{
-		int width = font.Width(info.GetString("target government"));
+		int width = font.Width(frame.info.GetString("target government"));
 		Point center = interface->GetPoint("faction markers");
 		
 		const Sprite *mark[2] = {SpriteSet::Get("ui/faction left"), SpriteSet::Get("ui/faction right")};
 		// Round the x offsets to whole numbers so the icons are sharp.
 		double dx[2] = {(width + mark[0]->Width() + 1) / -2, (width + mark[1]->Width() + 1) / 2};
 		for(int i = 0; i < 2; ++i)
-			SpriteShader::Draw(mark[i], center + Point(dx[i], 0.), 1., targetSwizzle);
+			SpriteShader::Draw(mark[i], center + Point(dx[i], 0.), 1., frame.targetSwizzle);
 	}
 	if(jumpCount && Preferences::Has("Show mini-map"))
-		MapPanel::DrawMiniMap(player, .5f * min(1.f, jumpCount / 30.f), jumpInProgress, step);
+		MapPanel::DrawMiniMap(player, .5f * min(1.f, jumpCount / 30.f), jumpInProgress, frame.step);
 	
 	// Draw ammo status.
 	static const double ICON_SIZE = 30.;
@@ -948,7 +741,7 @@ void Engine::Draw() const
 	Point boxOff(AMMO_WIDTH - .5 * selectedSprite->Width(), .5 * ICON_SIZE);
 	Point textOff(AMMO_WIDTH - .5 * ICON_SIZE, .5 * (ICON_SIZE - font.Height()));
 	Point iconOff(.5 * ICON_SIZE, .5 * ICON_SIZE);
-	for(const pair<const Outfit *, int> &it : ammo)
+	for(const pair<const Outfit *, int> &it : frame.ammo)
 	{
 		pos.Y() -= ICON_SIZE;
 		if(pos.Y() < ammoBox.Top() + ammoPad)
@@ -970,11 +763,7 @@ void Engine::Draw() const
 	}
 	
 	// Draw escort status.
-	escorts.Draw(interface->GetBox("escorts"));
-	
-	// Upload any preloaded sprites that are now available. This is to avoid
-	// filling the entire backlog of sprites before landing on a planet.
-	GameData::Progress();
+	frame.escorts.Draw(interface->GetBox("escorts"));
 	
 	if(Preferences::Has("Show CPU / GPU load"))
 	{
@@ -982,62 +771,129 @@ void Engine::Draw() const
 		Color color = *colors.Get("medium");
 		font.Draw(loadString,
 			Point(-10 - font.Width(loadString), Screen::Height() * -.5 + 5.), color);
+		performance.Draw(Point(-270., Screen::Height() * -.5 + 25.));
 	}
 }
 
 
 
+// Record how long drawing the last frame took, for the performance display.
+void Engine::AddFrame(double drawTime)
+{
+	performance.AddFrame(drawTime);
+}
+
+
+
 // Select the object the player clicked on.
 void Engine::Click(const Point &from, const Point &to, bool hasShift)
 {
+	Replay::Click(from, to, hasShift, zoom);
+	
 	// First, see if this is a click on an escort icon.
-	doClickNextStep = true;
-	this->hasShift = hasShift;
-	isRightClick = false;
+	clicks.doClick = true;
+	clicks.clickHasShift = hasShift;
+	clicks.isRightClick = false;
 	
 	// Determine if the left-click was within the radar display.
 	const Interface *interface = GameData::Interfaces().Get("hud");
 	Point radarCenter = interface->GetPoint("radar");
 	double radarRadius = interface->GetValue("radar radius");
 	if(Preferences::Has("Clickable radar display") && (from - radarCenter).Length() <= radarRadius)
-		isRadarClick = true;
+		clicks.isRadarClick = true;
 	else
-		isRadarClick = false;
+		clicks.isRadarClick = false;
 	
-	clickPoint = isRadarClick ? from - radarCenter : from;
-	if(isRadarClick)
-		clickBox = Rectangle::WithCorners(
-			(from - radarCenter) / RADAR_SCALE + center,
-			(to - radarCenter) / RADAR_SCALE  + center);
+	// The selection box is placed relative to wherever the view is centered
+	// when the calculation thread gets to this click.
+	clicks.clickPoint = clicks.isRadarClick ? from - radarCenter : from;
+	if(clicks.isRadarClick)
+	{
+		clicks.clickFrom = (from - radarCenter) / RADAR_SCALE;
+		clicks.clickTo = (to - radarCenter) / RADAR_SCALE;
+	}
 	else
-		clickBox = Rectangle::WithCorners(from / zoom + center, to / zoom + center);
+	{
+		clicks.clickFrom = from / zoom;
+		clicks.clickTo = to / zoom;
+	}
 }
 
 
 
 void Engine::RClick(const Point &point)
 {
-	doClickNextStep = true;
-	hasShift = false;
-	isRightClick = true;
+	Replay::RClick(point, zoom);
+	clicks.doClick = true;
+	clicks.clickHasShift = false;
+	clicks.isRightClick = true;
 	
 	// Determine if the right-click was within the radar display, and if so, rescale.
 	const Interface *interface = GameData::Interfaces().Get("hud");
 	Point radarCenter = interface->GetPoint("radar");
 	double radarRadius = interface->GetValue("radar radius");
 	if(Preferences::Has("Clickable radar display") && (point - radarCenter).Length() <= radarRadius)
-		clickPoint = (point - radarCenter) / RADAR_SCALE;
+		clicks.clickPoint = (point - radarCenter) / RADAR_SCALE;
 	else
-		clickPoint = point / zoom;
+		clicks.clickPoint = point / zoom;
 }
 
 
 
 void Engine::SelectGroup(int group, bool hasShift, bool hasControl)
 {
-	groupSelect = group;
-	this->hasShift = hasShift;
-	this->hasControl = hasControl;
+	Replay::SelectGroup(group, hasShift, hasControl);
+	clicks.groupSelect = group;
+	clicks.clickHasShift = hasShift;
+	clicks.hasControl = hasControl;
+}
+
+
+
+// Get a hash of the state of every ship, projectile, and flotsam.
+uint64_t Engine::StateHash() const
+{
+	// Hash the exact bits of each value, so that even the smallest difference
+	// in the results is caught (FNV-1a).
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		for(int i = 0; i < 8; ++i)
+			hash = (hash ^ ((bits >> (8 * i)) & 0xFF)) * 1099511628211ull;
+	};
+	
+	add(step);
+	bool dump = (step >= 1742 && step <= 1745 && getenv("DUMP"));
+	if(dump) cerr << "S" << step << " ships " << ships.size() << " proj " << projectiles.size() << " flot " << flotsam.size() << " vis " << visuals.size() << endl;
+	for(const shared_ptr<Ship> &ship : ships)
+	{
+		if(dump) cerr << ship->Name() << " " << (ship->GetSystem() ? ship->GetSystem()->Name() : string("-")) << " " << ship->Position().X() << "," << ship->Position().Y() << " v" << ship->Velocity().X() << "," << ship->Velocity().Y() << " h" << ship->Hull() << " s" << ship->Shields() << " e" << ship->Energy() << " t" << ship->Heat() << " f" << ship->Fuel() << (ship->GetTargetShip() ? " T:" + ship->GetTargetShip()->Name() : string()) << endl;
+		add(ship->Position().X());
+		add(ship->Position().Y());
+		add(ship->Velocity().X());
+		add(ship->Velocity().Y());
+		add(ship->Facing().Degrees());
+		add(ship->Shields());
+		add(ship->Hull());
+		add(ship->Energy());
+		add(ship->Fuel());
+		add(ship->Heat());
+	}
+	for(const Projectile &projectile : projectiles)
+	{
+		add(projectile.Position().X());
+		add(projectile.Position().Y());
+		add(projectile.Velocity().X());
+		add(projectile.Velocity().Y());
+	}
+	for(const shared_ptr<Flotsam> &it : flotsam)
+	{
+		add(it->Position().X());
+		add(it->Position().Y());
+	}
+	return hash;
 }
 
 
@@ -1160,25 +1016,51 @@ void Engine::EnterSystem()
 // Thread entry point.
 void Engine::ThreadEntryPoint()
 {
+	Profiler::SetThreadName("Engine");
+	vector<Input> steps;
 	while(true)
 	{
 		{
 			unique_lock<mutex> lock(swapMutex);
-			while(calcTickTock == drawTickTock && !terminate)
+			while((isPaused || !queued) && !terminate)
 				condition.wait(lock);
 		
 			if(terminate)
 				break;
+			
+			// Take all the input up to the next step that should be calculated,
+			// and fill in whichever frame is not being drawn or about to be.
+			steps.clear();
+			do {
+				steps.push_back(inputs.front());
+				inputs.pop_front();
+			} while(!steps.back().go);
+			--queued;
+			isCalculating = true;
+			calcFrame = 0;
+			while(calcFrame == drawFrame || calcFrame == doneFrame)
+				++calcFrame;
 		}
 		
 		// Do all the calculations.
+		Frame &frame = frames[calcFrame];
+		frame.timing = steps.back().timing;
+		frame.timing.start = FrameQueue::Clock::now();
+		for(const Input &input : steps)
+			if(input.hasInput)
+				HandleInput(input);
+		frame.zoom = steps.back().zoom;
+		frame.step = ++step;
 		CalculateStep();
+		FinishStep();
+		frame.timing.end = FrameQueue::Clock::now();
 		
 		{
 			unique_lock<mutex> lock(swapMutex);
-			calcTickTock = drawTickTock;
+			isCalculating = false;
+			doneFrame = calcFrame;
 		}
-		condition.notify_one();
+		condition.notify_all();
 	}
 }
 
@@ -1186,18 +1068,31 @@ void Engine::ThreadEntryPoint()
 
 void Engine::CalculateStep()
 {
+	Profiler::Zone zone("Engine::CalculateStep");
 	FrameTimer loadTimer;
+	Frame &frame = frames[calcFrame];
+	PerformanceDisplay::Sample &sample = frame.sample;
+	sample.Start();
 	
 	// Clear the list of objects to draw.
-	draw[calcTickTock].Clear(step, zoom);
-	batchDraw[calcTickTock].Clear(step, zoom);
-	radar[calcTickTock].Clear();
+	frame.draw.Clear(step, frame.zoom);
+	frame.batchDraw.Clear(step, frame.zoom);
+	frame.radar.Clear();
 	
 	if(!player.GetSystem())
 		return;
 	
+	// All the random numbers used in this step come from streams keyed on the
+	// step and on the object using them, so that the outcome does not depend
+	// on what order the objects are updated in.
+	Random::Stream stream(player.Seed(), step, 0, Random::STEP);
+	
 	// Now, all the ships must decide what they are doing next.
-	ai.Step(player);
+	{
+		Profiler::Zone zone("AI::Step");
+		ai.Step(player);
+	}
+	sample.Lap(PerformanceDisplay::AI_STEP);
 	
 	// Perform actions for all the game objects. In general this is ordered from
 	// bottom to top of the draw stack, but in some cases one object type must
@@ -1213,11 +1108,14 @@ void Engine::CalculateStep()
 	const Ship *flagship = player.Flagship();
 	bool wasHyperspacing = (flagship && flagship->IsEnteringHyperspace());
 	// Move all the ships.
-	for(const shared_ptr<Ship> &it : ships)
-		MoveShip(it);
+	{
+		Profiler::Zone zone("Engine::MoveShip");
+		for(const shared_ptr<Ship> &it : ships)
+			MoveShip(it);
+	}
 	// If the flagship just began jumping, play the appropriate sound.
 	if(!wasHyperspacing && flagship && flagship->IsEnteringHyperspace())
-		Audio::Play(Audio::Get(flagship->IsUsingJumpDrive() ? "jump drive" : "hyperdrive"));
+		Audio::Play(WellKnown::Get(flagship->IsUsingJumpDrive() ? WellKnown::JUMP_DRIVE : WellKnown::HYPERDRIVE));
 	// Check if the flagship just entered a new system.
 	if(flagship && playerSystem != flagship->GetSystem())
 	{
@@ -1234,6 +1132,7 @@ void Engine::CalculateStep()
 		EnterSystem();
 	}
 	Prune(ships);
+	sample.Lap(PerformanceDisplay::MOVE_SHIPS);
 	
 	// Move the asteroids. This must be done before collision detection. Minables
 	// may create visuals or flotsam.
@@ -1247,7 +1146,10 @@ void Engine::CalculateStep()
 	
 	// Move the projectiles.
 	for(Projectile &projectile : projectiles)
+	{
+		Random::Stream projectileStream(projectile.RandomKey(), Random::PROJECTILE);
 		projectile.Move(newVisuals, newProjectiles);
+	}
 	Prune(projectiles);
 	
 	// Move the visuals.
@@ -1274,13 +1176,17 @@ void Engine::CalculateStep()
 	// Decrement the count of how long it's been since a ship last asked for help.
 	if(grudgeTime)
 		--grudgeTime;
+	sample.Lap(PerformanceDisplay::MOVE_OBJECTS);
 	
 	// Populate the collision detection lookup sets.
 	FillCollisionSets();
 	
 	// Perform collision detection.
-	for(Projectile &projectile : projectiles)
-		DoCollisions(projectile);
+	{
+		Profiler::Zone zone("Engine::DoCollisions");
+		for(Projectile &projectile : projectiles)
+			DoCollisions(projectile);
+	}
 	// Now that collision detection is done, clear the cache of ships with anti-
 	// missile systems ready to fire.
 	hasAntiMissile.clear();
@@ -1292,81 +1198,478 @@ void Engine::CalculateStep()
 	// Check for ship scanning.
 	for(const shared_ptr<Ship> &it : ships)
 		DoScanning(it);
+	sample.Lap(PerformanceDisplay::COLLISIONS);
+	
+	// Draw the objects. Start by figuring out where the view should be centered:
+	Profiler::Zone drawZone("Engine::CalculateStep: draw lists");
+	Point newCenter = center;
+	Point newCenterVelocity;
+	if(flagship)
+	{
+		newCenter = flagship->Position();
+		newCenterVelocity = flagship->Velocity();
+	}
+	frame.draw.SetCenter(newCenter, newCenterVelocity);
+	frame.batchDraw.SetCenter(newCenter);
+	frame.radar.SetCenter(newCenter);
+	
+	// Populate the radar.
+	FillRadar();
+	
+	// Draw the planets.
+	for(const StellarObject &object : playerSystem->Objects())
+		if(object.HasSprite())
+		{
+			// Don't apply motion blur to very large planets and stars.
+			if(object.Width() >= 280.)
+				frame.draw.AddUnblurred(object);
+			else
+				frame.draw.Add(object);
+		}
+	// Draw the asteroids and minables.
+	asteroids.Draw(frame.draw, newCenter, frame.zoom);
+	// Draw the flotsam.
+	for(const shared_ptr<Flotsam> &it : flotsam)
+		frame.draw.Add(*it);
+	// Draw the ships. Skip the flagship, then draw it on top of all the others.
+	bool showFlagship = false;
+	for(const shared_ptr<Ship> &ship : ships)
+		if(ship->GetSystem() == playerSystem && ship->HasSprite())
+		{
+			if(ship.get() != flagship)
+			{
+				AddSprites(*ship);
+				if(ship->IsThrusting())
+				{
+					for(const auto &it : ship->Attributes().FlareSounds())
+						if(it.second > 0)
+							Audio::Play(it.first, ship->Position());
+				}
+			}
+			else
+				showFlagship = true;
+		}
+		
+	if(flagship && showFlagship)
+	{
+		AddSprites(*flagship);
+		if(flagship->IsThrusting())
+		{
+			for(const auto &it : flagship->Attributes().FlareSounds())
+				if(it.second > 0)
+					Audio::Play(it.first);
+		}
+	}
+	// Draw the projectiles.
+	for(const Projectile &projectile : projectiles)
+		frame.batchDraw.Add(projectile, projectile.Clip());
+	// Draw the visuals.
+	for(const Visual &visual : visuals)
+		frame.batchDraw.Add(visual);
+	frame.batchDraw.Finish();
+	sample.Lap(PerformanceDisplay::FILL_DRAW_LISTS);
+	
+	// Keep track of how many objects were involved in this step.
+	sample.count[PerformanceDisplay::SHIPS] = ships.size();
+	sample.count[PerformanceDisplay::PROJECTILES] = projectiles.size();
+	sample.count[PerformanceDisplay::VISUALS] = visuals.size();
+	sample.count[PerformanceDisplay::FLOTSAM] = flotsam.size();
+	sample.count[PerformanceDisplay::DRAW_ITEMS] = frame.draw.Size();
+	sample.count[PerformanceDisplay::BATCH_VERTICES] = frame.batchDraw.Vertices();
+	sample.count[PerformanceDisplay::COLLISION_ENTRIES] = shipCollisions.Size() + asteroids.CollisionSetSize();
+	// Temporary lists are allocated from frame arenas, and only go to the heap
+	// if an arena is full.
+	sample.count[PerformanceDisplay::SCRATCH_ALLOCATIONS] = ai.Arena().Allocations() + shipCollisions.Arena().Allocations();
+	sample.count[PerformanceDisplay::SCRATCH_OVERFLOWS] = ai.Arena().Overflows() + shipCollisions.Arena().Overflows();
+	// Memory that is freed out of order, such as the old buffer when a vector
+	// grows, stays in use until the arena is reset.
+	sample.count[PerformanceDisplay::SCRATCH_LOST] = ai.Arena().Lost() + shipCollisions.Arena().Lost();
+	sample.count[PerformanceDisplay::SCRATCH_LOST_BYTES] = ai.Arena().LostBytes() + shipCollisions.Arena().LostBytes();
+	sample.count[PerformanceDisplay::AI_SCRATCH_PEAK_BYTES] = ai.Arena().Peak();
+	sample.Finish();
+	
+	// Keep track of how much of the CPU time we are using.
+	loadSum += loadTimer.Time();
+	if(++loadCount == 60)
+	{
+		load = loadSum;
+		loadSum = 0.;
+		loadCount = 0;
+	}
+}
+
+
+
+// Use the player's input for one step. This is done just before that step is
+// calculated, either by Step() if nothing else is waiting to be calculated, or
+// by the calculation thread once it catches up.
+void Engine::HandleInput(const Input &input)
+{
+	ai.UpdateKeys(player, input.keys, input.hasShift, clickCommands, input.isActive && wasActive);
+	wasActive = input.isActive;
+	
+	// Any of the player's ships that are in system are assumed to have
+	// landed along with the player.
+	const shared_ptr<Ship> flagship = player.FlagshipPtr();
+	if(flagship && flagship->GetPlanet() && input.isActive)
+		player.SetPlanet(flagship->GetPlanet());
+	
+	const System *currentSystem = player.GetSystem();
+	// Update this here, for thread safety.
+	if(!player.HasTravelPlan() && flagship && flagship->GetTargetSystem())
+		player.TravelPlan().push_back(flagship->GetTargetSystem());
+	if(player.HasTravelPlan() && currentSystem == player.TravelPlan().back())
+		player.PopTravel();
+	
+	// Handle any events that change the selected ships.
+	if(input.groupSelect >= 0)
+	{
+		// This has to be done here to avoid race conditions.
+		if(input.hasControl)
+			player.SetGroup(input.groupSelect);
+		else
+			player.SelectGroup(input.groupSelect, input.hasShift);
+	}
+	
+	// The view is now centered where it will be for this step, so the click
+	// can be placed in the game world.
+	doClick = input.doClick;
+	hasShift = input.clickHasShift;
+	isRightClick = input.isRightClick;
+	clickPoint = input.clickPoint;
+	clickBox = Rectangle::WithCorners(input.clickFrom + center, input.clickTo + center);
+	if(doClick && !isRightClick)
+	{
+		doClick = !player.SelectShips(clickBox, input.hasShift);
+		if(doClick)
+		{
+			if(!input.clickStack.empty())
+				doClick = !player.SelectShips(input.clickStack, input.hasShift);
+			else
+				clickPoint /= input.isRadarClick ? RADAR_SCALE : input.zoom;
+		}
+	}
+}
+
+
+
+// Pass on the events from the step that was just calculated, and fill in the
+// heads-up display for its frame.
+void Engine::FinishStep()
+{
+	Frame &frame = frames[calcFrame];
+	const shared_ptr<Ship> flagship = player.FlagshipPtr();
+	const StellarObject *object = player.GetStellarObject();
+	if(object)
+	{
+		center = object->Position();
+		centerVelocity = Point();
+	}
+	else if(flagship)
+	{
+		center = flagship->Position();
+		centerVelocity = flagship->Velocity();
+		if(doEnter && flagship->Zoom() == 1. && !flagship->IsHyperspacing())
+		{
+			doEnter = false;
+			eventQueue.emplace_back(flagship, flagship, ShipEvent::JUMP);
+		}
+	}
+	ai.UpdateEvents(eventQueue);
+	events.splice(events.end(), eventQueue);
+	frame.center = center;
+	frame.centerVelocity = centerVelocity;
 	
-	// Draw the objects. Start by figuring out where the view should be centered:
-	Point newCenter = center;
-	Point newCenterVelocity;
-	if(flagship)
+	// Draw a highlight to distinguish the flagship from other ships.
+	if(flagship && !flagship->IsDestroyed() && Preferences::Has("Highlight player's flagship"))
 	{
-		newCenter = flagship->Position();
-		newCenterVelocity = flagship->Velocity();
+		frame.highlightSprite = flagship->GetSprite();
+		frame.highlightUnit = flagship->Unit() * frame.zoom;
+		frame.highlightFrame = flagship->GetFrame();
 	}
-	draw[calcTickTock].SetCenter(newCenter, newCenterVelocity);
-	batchDraw[calcTickTock].SetCenter(newCenter);
-	radar[calcTickTock].SetCenter(newCenter);
+	else
+		frame.highlightSprite = nullptr;
 	
-	// Populate the radar.
-	FillRadar();
+	if(doFlash)
+	{
+		flash = .4;
+		doFlash = false;
+	}
+	else if(flash)
+		flash = max(0., flash * .99 - .002);
+	frame.flash = flash;
 	
-	// Draw the planets.
-	for(const StellarObject &object : playerSystem->Objects())
-		if(object.HasSprite())
+	const System *currentSystem = player.GetSystem();
+	frame.targets.clear();
+	
+	// Update the player's ammo amounts.
+	frame.ammo.clear();
+	if(flagship)
+		for(const auto &it : flagship->Outfits())
 		{
-			// Don't apply motion blur to very large planets and stars.
-			if(object.Width() >= 280.)
-				draw[calcTickTock].AddUnblurred(object);
+			if(!it.first->Icon())
+				continue;
+			
+			if(it.first->Ammo())
+				frame.ammo.emplace_back(it.first,
+					flagship->OutfitCount(it.first->Ammo()));
+			else if(it.first->FiringFuel())
+			{
+				double remaining = flagship->Fuel()
+					* flagship->Attributes().Get("fuel capacity");
+				frame.ammo.emplace_back(it.first,
+					remaining / it.first->FiringFuel());
+			}
 			else
-				draw[calcTickTock].Add(object);
+				frame.ammo.emplace_back(it.first, -1);
 		}
-	// Draw the asteroids and minables.
-	asteroids.Draw(draw[calcTickTock], newCenter, zoom);
-	// Draw the flotsam.
-	for(const shared_ptr<Flotsam> &it : flotsam)
-		draw[calcTickTock].Add(*it);
-	// Draw the ships. Skip the flagship, then draw it on top of all the others.
-	bool showFlagship = false;
-	for(const shared_ptr<Ship> &ship : ships)
-		if(ship->GetSystem() == playerSystem && ship->HasSprite())
-		{
-			if(ship.get() != flagship)
+	
+	// Display escort information for all ships of the "Escort" government,
+	// and all ships with the "escort" personality, except for fighters that
+	// are not owned by the player.
+	frame.escorts.Clear();
+	bool fleetIsJumping = (flagship && flagship->Commands().Has(Command::JUMP));
+	for(const auto &it : ships)
+		if(it->GetGovernment()->IsPlayer() || it->GetPersonality().IsEscort())
+			if(!it->IsYours() && !it->CanBeCarried())
 			{
-				AddSprites(*ship);
-				if(ship->IsThrusting())
+				bool isSelected = (flagship && flagship->GetTargetShip() == it);
+				frame.escorts.Add(*it, it->GetSystem() == currentSystem, fleetIsJumping, isSelected);
+			}
+	for(const shared_ptr<Ship> &escort : player.Ships())
+		if(!escort->IsParked() && escort != flagship && !escort->IsDestroyed())
+		{
+			// Check if this escort is selected.
+			bool isSelected = false;
+			for(const weak_ptr<Ship> &ptr : player.SelectedShips())
+				if(ptr.lock() == escort)
 				{
-					for(const auto &it : ship->Attributes().FlareSounds())
-						if(it.second > 0)
-							Audio::Play(it.first, ship->Position());
+					isSelected = true;
+					break;
 				}
+			frame.escorts.Add(*escort, escort->GetSystem() == currentSystem, fleetIsJumping, isSelected);
+		}
+	
+	// Create the status overlays.
+	frame.statuses.clear();
+	if(wasActive && Preferences::Has("Show status overlays"))
+		for(const auto &it : ships)
+		{
+			if(!it->GetGovernment() || it->GetSystem() != currentSystem || it->Cloaking() == 1.)
+				continue;
+			// Don't show status for dead ships.
+			if(it->IsDestroyed())
+				continue;
+			
+			bool isEnemy = it->GetGovernment()->IsEnemy();
+			if(isEnemy || it->IsYours() || it->GetPersonality().IsEscort())
+			{
+				double width = min(it->Width(), it->Height());
+				frame.statuses.emplace_back(it->Position() - center, it->Shields(), it->Hull(),
+					max(20., width * .5), isEnemy);
 			}
-			else
-				showFlagship = true;
 		}
+	
+	if(flagship && flagship->IsOverheated())
+		Messages::Add("Your ship has overheated.");
+	
+	// Clear the HUD information from the previous frame.
+	frame.info = Information();
+	if(flagship && flagship->Hull())
+	{
+		Point shipFacingUnit(0., -1.);
+		if(Preferences::Has("Rotate flagship in HUD"))
+			shipFacingUnit = flagship->Facing().Unit();
 		
-	if(flagship && showFlagship)
+		frame.info.SetSprite("player sprite", flagship->GetSprite(), shipFacingUnit, flagship->GetFrame(step));
+	}
+	if(currentSystem)
+		frame.info.SetString("location", currentSystem->Name());
+	frame.info.SetString("date", player.GetDate().ToString());
+	if(flagship)
 	{
-		AddSprites(*flagship);
-		if(flagship->IsThrusting())
+		frame.info.SetBar("fuel", flagship->Fuel(),
+			flagship->Attributes().Get("fuel capacity") * .01);
+		frame.info.SetBar("energy", flagship->Energy());
+		double heat = flagship->Heat();
+		frame.info.SetBar("heat", min(1., heat));
+		// If heat is above 100%, draw a second overlaid bar to indicate the
+		// total heat level.
+		if(heat > 1.)
+			frame.info.SetBar("overheat", min(1., heat - 1.));
+		if(flagship->IsOverheated() && (step / 20) % 2)
+			frame.info.SetBar("overheat blink", min(1., heat));
+		frame.info.SetBar("shields", flagship->Shields());
+		frame.info.SetBar("hull", flagship->Hull(), 20.);
+		frame.info.SetBar("disabled hull", min(flagship->Hull(), flagship->DisabledHull()), 20.);
+	}
+	frame.info.SetString("credits",
+		Format::Credits(player.Accounts().Credits()) + " credits");
+	bool isJumping = flagship && (flagship->Commands().Has(Command::JUMP) || flagship->IsEnteringHyperspace());
+	if(flagship && flagship->GetTargetStellar() && !isJumping)
+	{
+		const StellarObject *object = flagship->GetTargetStellar();
+		string navigationMode = flagship->Commands().Has(Command::LAND) ? "Landing on:" :
+			object->GetPlanet() && object->GetPlanet()->CanLand(*flagship) ? "Can land on:" :
+			"Cannot land on:";
+		frame.info.SetString("navigation mode", navigationMode);
+		const string &name = object->Name();
+		frame.info.SetString("destination", name);
+		
+		frame.targets.push_back({
+			object->Position() - center,
+			object->Facing(),
+			object->Radius(),
+			object->GetPlanet()->CanLand() ? Radar::FRIENDLY : Radar::HOSTILE,
+			5});
+	}
+	else if(flagship && flagship->GetTargetSystem())
+	{
+		frame.info.SetString("navigation mode", "Hyperspace:");
+		if(player.HasVisited(flagship->GetTargetSystem()))
+			frame.info.SetString("destination", flagship->GetTargetSystem()->Name());
+		else
+			frame.info.SetString("destination", "unexplored system");
+	}
+	else
+	{
+		frame.info.SetString("navigation mode", "Navigation:");
+		frame.info.SetString("destination", "no destination");
+	}
+	shared_ptr<const Ship> target;
+	shared_ptr<const Minable> targetAsteroid;
+	frame.targetVector = Point();
+	if(flagship)
+	{
+		target = flagship->GetTargetShip();
+		targetAsteroid = flagship->GetTargetAsteroid();
+		// Record that the player knows this type of asteroid is available here.
+		if(targetAsteroid)
+			for(const auto &it : targetAsteroid->Payload())
+				player.Harvest(it.first);
+	}
+	if(!target)
+		frame.targetSwizzle = -1;
+	if(!target && !targetAsteroid)
+		frame.info.SetString("target name", "no target");
+	else if(!target)
+	{
+		frame.info.SetSprite("target sprite",
+			targetAsteroid->GetSprite(),
+			targetAsteroid->Facing().Unit(),
+			targetAsteroid->GetFrame(step));
+		frame.info.SetString("target name", Format::Capitalize(targetAsteroid->Name()) + " Asteroid");
+		
+		frame.targetVector = targetAsteroid->Position() - center;
+		
+		if(flagship->Attributes().Get("tactical scan power"))
 		{
-			for(const auto &it : flagship->Attributes().FlareSounds())
-				if(it.second > 0)
-					Audio::Play(it.first);
+			frame.info.SetCondition("range display");
+			int targetRange = round(targetAsteroid->Position().Distance(flagship->Position()));
+			frame.info.SetString("target range", to_string(targetRange));
 		}
 	}
-	// Draw the projectiles.
-	for(const Projectile &projectile : projectiles)
-		batchDraw[calcTickTock].Add(projectile, projectile.Clip());
-	// Draw the visuals.
-	for(const Visual &visual : visuals)
-		batchDraw[calcTickTock].Add(visual);
+	else
+	{
+		if(target->GetSystem() == player.GetSystem() && target->Cloaking() < 1.)
+			targetUnit = target->Facing().Unit();
+		// The target's name is filled in by Step(), because that is the only
+		// thread that can measure how wide it is.
+		frame.info.SetSprite("target sprite", target->GetSprite(), targetUnit, target->GetFrame(step));
+		frame.info.SetString("target type", target->ModelName());
+		if(!target->GetGovernment())
+			frame.info.SetString("target government", "No Government");
+		else
+			frame.info.SetString("target government", target->GetGovernment()->GetName());
+		frame.targetSwizzle = target->GetSwizzle();
+		frame.info.SetString("mission target", target->GetPersonality().IsTarget() ? "(mission target)" : "");
+		
+		int targetType = RadarType(*target, step);
+		frame.info.SetOutlineColor(Radar::GetColor(targetType));
+		if(target->GetSystem() == player.GetSystem() && target->IsTargetable())
+		{
+			frame.info.SetBar("target shields", target->Shields());
+			frame.info.SetBar("target hull", target->Hull(), 20.);
+			frame.info.SetBar("target disabled hull", min(target->Hull(), target->DisabledHull()), 20.);
+		
+			// The target area will be a square, with sides proportional to the average
+			// of the width and the height of the sprite.
+			double size = (target->Width() + target->Height()) * .35;
+			frame.targets.push_back({
+				target->Position() - center,
+				Angle(45.) + target->Facing(),
+				size,
+				targetType,
+				4});
+			
+			frame.targetVector = target->Position() - center;
+			
+			// Check if the target is close enough to show tactical information.
+			double tacticalRange = 100. * sqrt(flagship->Attributes().Get("tactical scan power"));
+			double targetRange = target->Position().Distance(flagship->Position());
+			if(tacticalRange)
+			{
+				frame.info.SetCondition("range display");
+				frame.info.SetString("target range", to_string(static_cast<int>(round(targetRange))));
+			}
+			// Actual tactical information requires a scrutable
+			// target that is within the tactical scanner range.
+			if((targetRange <= tacticalRange && !target->Attributes().Get("inscrutable"))
+					|| (tacticalRange && target->IsYours()))
+			{
+				frame.info.SetCondition("tactical display");
+				frame.info.SetString("target crew", to_string(target->Crew()));
+				int fuel = round(target->Fuel() * target->Attributes().Get("fuel capacity"));
+				frame.info.SetString("target fuel", to_string(fuel));
+				int energy = round(target->Energy() * target->Attributes().Get("energy capacity"));
+				frame.info.SetString("target energy", to_string(energy));
+				int heat = round(100. * target->Heat());
+				frame.info.SetString("target heat", to_string(heat) + "%");
+			}
+		}
+	}
+	if(target && target->IsTargetable() && target->GetSystem() == currentSystem
+		&& (flagship->CargoScanFraction() || flagship->OutfitScanFraction()))
+	{
+		double width = max(target->Width(), target->Height());
+		Point pos = target->Position() - center;
+		frame.statuses.emplace_back(pos, flagship->OutfitScanFraction(), flagship->CargoScanFraction(),
+			10. + max(20., width * .5), 2, Angle(pos).Degrees() + 180.);
+	}
 	
-	// Keep track of how much of the CPU time we are using.
-	loadSum += loadTimer.Time();
-	if(++loadCount == 60)
+	// Draw crosshairs on all the selected ships.
+	for(const weak_ptr<Ship> &selected : player.SelectedShips())
 	{
-		load = loadSum;
-		loadSum = 0.;
-		loadCount = 0;
+		shared_ptr<Ship> ship = selected.lock();
+		if(ship && ship != target && !ship->IsParked() && ship->GetSystem() == player.GetSystem()
+				&& !ship->IsDestroyed() && ship->Zoom() > 0.)
+		{
+			double size = (ship->Width() + ship->Height()) * .35;
+			frame.targets.push_back({
+				ship->Position() - center,
+				Angle(45.) + ship->Facing(),
+				size,
+				Radar::PLAYER,
+				4});
+		}
 	}
+	
+	// Draw crosshairs on any minables in range of the flagship's scanners.
+	double scanRange = flagship ? 100. * sqrt(flagship->Attributes().Get("asteroid scan power")) : 0.;
+	if(flagship && scanRange && !flagship->IsHyperspacing())
+		for(const shared_ptr<Minable> &minable : asteroids.Minables())
+		{
+			Point offset = minable->Position() - center;
+			if(offset.Length() > scanRange)
+				continue;
+			
+			frame.targets.push_back({
+				offset,
+				minable->Facing(),
+				.8 * minable->Radius(),
+				minable == flagship->GetTargetAsteroid() ? Radar::SPECIAL : Radar::INACTIVE,
+				3});
+		}
 }
 
 
@@ -1375,6 +1678,7 @@ void Engine::CalculateStep()
 // boarding events, fire weapons, and launch fighters.
 void Engine::MoveShip(const shared_ptr<Ship> &ship)
 {
+	Random::Stream stream(ship->RandomKey(), Random::MOVE);
 	const Ship *flagship = player.Flagship();
 	
 	bool isJump = ship->IsUsingJumpDrive();
@@ -1406,13 +1710,13 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 		// Did this ship just begin hyperspacing?
 		if(wasHere && !wasHyperspacing && ship->IsHyperspacing())
 			Audio::Play(
-				Audio::Get(isJump ? "jump out" : "hyperdrive out"),
+				WellKnown::Get(isJump ? WellKnown::JUMP_OUT : WellKnown::HYPERDRIVE_OUT),
 				ship->Position());
 		
 		// Did this ship just jump into the player's system?
 		if(!wasHere && flagship && ship->GetSystem() == flagship->GetSystem())
 			Audio::Play(
-				Audio::Get(isJump ? "jump in" : "hyperdrive in"),
+				WellKnown::Get(isJump ? WellKnown::JUMP_IN : WellKnown::HYPERDRIVE_IN),
 				ship->Position());
 	}
 	
@@ -1442,10 +1746,17 @@ void Engine::MoveShip(const shared_ptr<Ship> &ship)
 // Populate the ship collision detection set for projectile & flotsam computations.
 void Engine::FillCollisionSets()
 {
+	Profiler::Zone zone("Engine::FillCollisionSets");
 	shipCollisions.Clear(step);
 	for(const shared_ptr<Ship> &it : ships)
 		if(it->GetSystem() == player.GetSystem() && it->Zoom() == 1.)
+		{
 			shipCollisions.Add(*it);
+			// The masks of ships in this system are the ones that projectiles
+			// are checked against, so it is worth caching their bounds.
+			if(it->HasSprite())
+				it->GetSprite()->CacheMaskFacings();
+		}
 	
 	// Get the ship collision set ready to query.
 	shipCollisions.Finish();
@@ -1866,6 +2177,7 @@ void Engine::DoScanning(const shared_ptr<Ship> &ship)
 // Fill in all the objects in the radar display.
 void Engine::FillRadar()
 {
+	Frame &frame = frames[calcFrame];
 	const Ship *flagship = player.Flagship();
 	const System *playerSystem = player.GetSystem();
 	
@@ -1874,7 +2186,7 @@ void Engine::FillRadar()
 		if(object.HasSprite())
 		{
 			double r = max(2., object.Radius() * .03 + .5);
-			radar[calcTickTock].Add(object.RadarType(flagship), object.Position(), r, r - 1.);
+			frame.radar.Add(object.RadarType(flagship), object.Position(), r, r - 1.);
 		}
 	
 	// Add pointers for neighboring systems.
@@ -1884,7 +2196,7 @@ void Engine::FillRadar()
 		const set<const System *> &links = (flagship->Attributes().Get("jump drive")) ?
 			playerSystem->Neighbors() : playerSystem->Links();
 		for(const System *system : links)
-			radar[calcTickTock].AddPointer(
+			frame.radar.AddPointer(
 				(system == targetSystem) ? Radar::SPECIAL : Radar::INACTIVE,
 				system->Position() - playerSystem->Position());
 	}
@@ -1892,10 +2204,10 @@ void Engine::FillRadar()
 	// Add viewport brackets.
 	if(!Preferences::Has("Disable viewport on radar"))
 	{
-		radar[calcTickTock].AddViewportBoundary(Screen::TopLeft() / zoom);
-		radar[calcTickTock].AddViewportBoundary(Screen::TopRight() / zoom);
-		radar[calcTickTock].AddViewportBoundary(Screen::BottomLeft() / zoom);
-		radar[calcTickTock].AddViewportBoundary(Screen::BottomRight() / zoom);
+		frame.radar.AddViewportBoundary(Screen::TopLeft() / frame.zoom);
+		frame.radar.AddViewportBoundary(Screen::TopRight() / frame.zoom);
+		frame.radar.AddViewportBoundary(Screen::BottomLeft() / frame.zoom);
+		frame.radar.AddViewportBoundary(Screen::BottomRight() / frame.zoom);
 	}
 	
 	// Add ships. Also check if hostile ships have newly appeared.
@@ -1914,7 +2226,7 @@ void Engine::FillRadar()
 			// Calculate how big the radar dot should be.
 			double size = sqrt(ship->Width() + ship->Height()) * .14 + .5;
 			
-			radar[calcTickTock].Add(type, ship->Position(), size);
+			frame.radar.Add(type, ship->Position(), size);
 			
 			// Check if this is a hostile ship.
 			hasHostiles |= (!ship->IsDisabled() && ship->GetGovernment()->IsEnemy()
@@ -1926,7 +2238,7 @@ void Engine::FillRadar()
 	else if(hasHostiles && !hadHostiles)
 	{
 		if(Preferences::Has("Warning siren"))
-			Audio::Play(Audio::Get("alarm"));
+			Audio::Play(WellKnown::Get(WellKnown::ALARM));
 		alarmTime = 180;
 		hadHostiles = true;
 	}
@@ -1939,11 +2251,11 @@ void Engine::FillRadar()
 		if(projectile.MissileStrength())
 		{
 			bool isEnemy = projectile.GetGovernment() && projectile.GetGovernment()->IsEnemy();
-			radar[calcTickTock].Add(
+			frame.radar.Add(
 				isEnemy ? Radar::SPECIAL : Radar::INACTIVE, projectile.Position(), 1.);
 		}
 		else if(projectile.GetWeapon().BlastRadius())
-			radar[calcTickTock].Add(Radar::SPECIAL, projectile.Position(), 1.8);
+			frame.radar.Add(Radar::SPECIAL, projectile.Position(), 1.8);
 	}
 }
 
@@ -1953,6 +2265,7 @@ void Engine::FillRadar()
 // and engine flares and any fighters it is carrying externally.
 void Engine::AddSprites(const Ship &ship)
 {
+	Frame &frame = frames[calcFrame];
 	bool hasFighters = ship.PositionFighters();
 	double cloak = ship.Cloaking();
 	bool drawCloaked = (cloak && ship.IsYours());
@@ -1962,8 +2275,8 @@ void Engine::AddSprites(const Ship &ship)
 			if(bay.side == Ship::Bay::UNDER && bay.ship)
 			{
 				if(drawCloaked)
-					draw[calcTickTock].AddSwizzled(*bay.ship, 7);
-				draw[calcTickTock].Add(*bay.ship, cloak);
+					frame.draw.AddSwizzled(*bay.ship, 7);
+				frame.draw.Add(*bay.ship, cloak);
 			}
 	
 	if(ship.IsThrusting())
@@ -1976,13 +2289,13 @@ void Engine::AddSprites(const Ship &ship)
 				for(int i = 0; i < it.second && i < 3; ++i)
 				{
 					Body sprite(it.first, pos, ship.Velocity(), ship.Facing(), point.Zoom());
-					draw[calcTickTock].Add(sprite, cloak);
+					frame.draw.Add(sprite, cloak);
 				}
 		}
 	
 	if(drawCloaked)
-		draw[calcTickTock].AddSwizzled(ship, 7);
-	draw[calcTickTock].Add(ship, cloak);
+		frame.draw.AddSwizzled(ship, 7);
+	frame.draw.Add(ship, cloak);
 	for(const Hardpoint &hardpoint : ship.Weapons())
 		if(hardpoint.GetOutfit() && hardpoint.GetOutfit()->HardpointSprite().HasSprite())
 		{
@@ -1992,7 +2305,7 @@ void Engine::AddSprites(const Ship &ship)
 				ship.Velocity(),
 				ship.Facing() + hardpoint.GetAngle(),
 				ship.Zoom());
-			draw[calcTickTock].Add(body, cloak);
+			frame.draw.Add(body, cloak);
 		}
 	
 	if(hasFighters)
@@ -2000,8 +2313,8 @@ void Engine::AddSprites(const Ship &ship)
 			if(bay.side == Ship::Bay::OVER && bay.ship)
 			{
 				if(drawCloaked)
-					draw[calcTickTock].AddSwizzled(*bay.ship, 7);
-				draw[calcTickTock].Add(*bay.ship, cloak);
+					frame.draw.AddSwizzled(*bay.ship, 7);
+				frame.draw.Add(*bay.ship, cloak);
 			}
 }
 
@@ -2094,6 +2407,37 @@ void Engine::DoGrudge(const shared_ptr<Ship> &target, const Government *attacker
 
 
 
+// Measure how much memory the lists of objects are holding on to. This only
+// counts the lists themselves, not the memory each object points to.
+void Engine::UpdateMemory() const
+{
+	if(!Allocations::IsTracking())
+		return;
+	
+	// Each element of a list is stored along with two pointers.
+	const size_t LIST_NODE = 2 * sizeof(void *);
+	int64_t objects = ships.size() + projectiles.size() + flotsam.size() + visuals.size();
+	int64_t bytes = (ships.size() + newShips.size()) * (sizeof(shared_ptr<Ship>) + LIST_NODE)
+		+ (flotsam.size() + newFlotsam.size()) * (sizeof(shared_ptr<Flotsam>) + LIST_NODE)
+		+ (projectiles.capacity() + newProjectiles.capacity()) * sizeof(Projectile)
+		+ (visuals.capacity() + newVisuals.capacity()) * sizeof(Visual)
+		+ hasAntiMissile.capacity() * sizeof(Ship *)
+		+ (eventQueue.size() + events.size()) * (sizeof(ShipEvent) + LIST_NODE)
+		+ inputs.size() * sizeof(Input);
+	for(const Frame &frame : frames)
+		bytes += frame.targets.capacity() * sizeof(Target)
+			+ frame.statuses.capacity() * sizeof(Status)
+			+ frame.labels.capacity() * sizeof(PlanetLabel);
+	Allocations::Set(Allocations::ENGINE, bytes, objects);
+	
+	// The masks' caches are only filled in by the calculation thread, which is
+	// paused now. Checking every sprite is not worth doing every step.
+	if(!(step % 60))
+		SpriteSet::UpdateMemory();
+}
+
+
+
 // Constructor for the ship status display rings.
 Engine::Status::Status(const Point &position, double outer, double inner, double radius, int type, double angle)
 	: position(position), outer(outer), inner(inner), radius(radius), type(type), angle(angle)
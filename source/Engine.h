@@ -20,12 +20,16 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Command.h"
 #include "DrawList.h"
 #include "EscortDisplay.h"
+#include "FrameQueue.h"
 #include "Information.h"
+#include "PerformanceDisplay.h"
 #include "Point.h"
 #include "Radar.h"
 #include "Rectangle.h"
 
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
@@ -51,9 +55,12 @@ class Visual;
 // the game, and to move them, step by step. All the motion and collision
 // calculations are handled in a separate thread so that the graphics thread is
 // free to just work on drawing things; this means that the drawn state of the
-// game is always one step (1/60 second) behind what is being calculated. This
-// lag is too small to be detectable and means that the game can better handle
-// situations where there are many objects on screen at once.
+// game is always at least one step (1/60 second) behind what is being
+// calculated. The input for each step is queued up, so if the player allows it
+// the calculation thread can get a step or two further ahead, and the frames it
+// produces are triple buffered so it never has to wait for the drawing to
+// finish. This lag is too small to be detectable and means that the game can
+// better handle situations where there are many objects on screen at once.
 class Engine {
 public:
 	explicit Engine(PlayerInfo &player);
@@ -64,12 +71,13 @@ public:
 	// Place NPCs spawned by a mission that offers when the player is not landed.
 	void Place(const std::list<NPC> &npcs, std::shared_ptr<Ship> flagship = nullptr);
 	
-	// Wait for the previous calculations (if any) to be done.
+	// Wait until no more steps are queued up than the player allows, then pause
+	// the calculation thread between steps so the game state can be accessed.
 	void Wait();
-	// Perform all the work that can only be done while the calculation thread
-	// is paused (for thread safety reasons).
+	// Read the input for the next step, and do any work that can only be done
+	// while the calculation thread is paused (for thread safety reasons).
 	void Step(bool isActive);
-	// Begin the next step of calculations.
+	// Queue up the next step of calculations.
 	void Go();
 	
 	// Get any special events that happened in this step.
@@ -78,19 +86,32 @@ public:
 	
 	// Draw a frame.
 	void Draw() const;
+	// Record how long drawing the last frame took, for the performance display.
+	void AddFrame(double drawTime);
 	
 	// Select the object the player clicked on.
 	void Click(const Point &from, const Point &to, bool hasShift);
 	void RClick(const Point &point);
 	void SelectGroup(int group, bool hasShift, bool hasControl);
 	
+	// Get a hash of the state of every ship, projectile, and flotsam, to check
+	// whether two runs of the game have played out exactly the same.
+	uint64_t StateHash() const;
+	
 	
 private:
+	class Input;
+	
 	void EnterSystem();
 	
 	void ThreadEntryPoint();
 	void CalculateStep();
 	
+	// The parts of each step that use the player's input, and that fill in the
+	// heads-up display. These are done by the calculation thread.
+	void HandleInput(const Input &input);
+	void FinishStep();
+	
 	void MoveShip(const std::shared_ptr<Ship> &ship);
 	
 	void SpawnFleets();
@@ -110,6 +131,9 @@ private:
 	
 	void DoGrudge(const std::shared_ptr<Ship> &target, const Government *attacker);
 	
+	// Measure how much memory the lists of objects are holding on to.
+	void UpdateMemory() const;
+	
 	
 private:
 	class Target {
@@ -121,6 +145,16 @@ private:
 		int count;
 	};
 	
+	// When the input for a step was read, and when it was queued, started, and
+	// finished calculating.
+	class Timing {
+	public:
+		FrameQueue::Clock::time_point input;
+		FrameQueue::Clock::time_point step;
+		FrameQueue::Clock::time_point start;
+		FrameQueue::Clock::time_point end;
+	};
+	
 	class Status {
 	public:
 		Status(const Point &position, double outer, double inner, double radius, int type, double angle = 0.);
@@ -133,6 +167,63 @@ private:
 		double angle;
 	};
 	
+	// The player's input for one step. Clicks are collected here until the next
+	// step begins, and then the input waits in a queue until the calculation
+	// thread gets to it.
+	class Input {
+	public:
+		Command keys;
+		bool hasShift = false;
+		bool isActive = false;
+		double zoom = 1.;
+		// A step can be calculated without any input, when a flight begins.
+		bool hasInput = false;
+		// Whether the engine went on to calculate a step after this input.
+		bool go = false;
+		Timing timing;
+		
+		bool doClick = false;
+		bool clickHasShift = false;
+		bool isRightClick = false;
+		bool isRadarClick = false;
+		Point clickPoint;
+		// The corners of the selection box, relative to the center of the view.
+		Point clickFrom;
+		Point clickTo;
+		// The escorts whose icon was clicked on, if any.
+		std::vector<const Ship *> clickStack;
+		int groupSelect = -1;
+		bool hasControl = false;
+	};
+	
+	// Everything that is drawn for one step.
+	class Frame {
+	public:
+		int step = 0;
+		double zoom = 1.;
+		Point center;
+		Point centerVelocity;
+		
+		DrawList draw;
+		BatchDrawList batchDraw;
+		Radar radar;
+		Timing timing;
+		PerformanceDisplay::Sample sample;
+		
+		Information info;
+		std::vector<Target> targets;
+		Point targetVector;
+		int targetSwizzle = -1;
+		EscortDisplay escorts;
+		std::vector<Status> statuses;
+		std::vector<PlanetLabel> labels;
+		std::vector<std::pair<const Outfit *, int>> ammo;
+		const Sprite *highlightSprite = nullptr;
+		Point highlightUnit;
+		float highlightFrame = 0.f;
+		double flash = 0.;
+	};
+	
 	
 private:
 	PlayerInfo &player;
@@ -158,31 +249,34 @@ private:
 	std::condition_variable condition;
 	std::mutex swapMutex;
 	
-	bool calcTickTock = false;
-	bool drawTickTock = false;
 	bool terminate = false;
 	bool wasActive = false;
-	DrawList draw[2];
-	BatchDrawList batchDraw[2];
-	Radar radar[2];
+	// Steps whose input has been read, but that have not been calculated yet,
+	// and how many of those the engine has been told to go on to.
+	std::deque<Input> inputs;
+	int queued = 0;
+	bool isCalculating = false;
+	bool isPaused = false;
+	// Clicks that will be part of the next step's input.
+	Input clicks;
+	// One frame is being drawn, the calculation thread is filling in another,
+	// and the most recently calculated one is ready to be drawn next.
+	static const int FRAME_COUNT = 3;
+	Frame frames[FRAME_COUNT];
+	int calcFrame = 0;
+	int doneFrame = 0;
+	int drawFrame = 0;
+	PerformanceDisplay performance;
 	// Viewport position and velocity.
 	Point center;
 	Point centerVelocity;
-	// Other information to display.
-	Information info;
-	std::vector<Target> targets;
-	Point targetVector;
+	// The most recent facing of the targeted ship.
 	Point targetUnit;
-	int targetSwizzle = -1;
-	EscortDisplay escorts;
-	std::vector<Status> statuses;
-	std::vector<PlanetLabel> labels;
-	std::vector<std::pair<const Outfit *, int>> ammo;
 	int jumpCount = 0;
 	const System *jumpInProgress[2] = {nullptr, nullptr};
-	const Sprite *highlightSprite = nullptr;
-	Point highlightUnit;
-	float highlightFrame = 0.f;
+	// The system whose sprites were last prefetched.
+	const System *prefetched = nullptr;
+	bool wasEnteringHyperspace = false;
 	
 	int step = 0;
 	
@@ -200,15 +294,11 @@ private:
 	bool doEnter = false;
 	bool hadHostiles = false;
 	
-	bool doClickNextStep = false;
 	bool doClick = false;
 	bool hasShift = false;
-	bool hasControl = false;
 	bool isRightClick = false;
-	bool isRadarClick = false;
 	Point clickPoint;
 	Rectangle clickBox;
-	int groupSelect = -1;
 	Command clickCommands;
 	
 	double zoom = 1.;
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "FillShader.h"
 
 #include "Color.h"
+#include "Font.h"
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
@@ -92,6 +93,7 @@ void FillShader::Fill(const Point &center, const Point &size, const Color &color
 	if(!shader.Object())
 		throw runtime_error("FillShader: Draw() called before Init().");
 	
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
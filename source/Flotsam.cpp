@@ -14,12 +14,12 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Angle.h"
 #include "Effect.h"
-#include "GameData.h"
 #include "Outfit.h"
 #include "Random.h"
 #include "Ship.h"
 #include "SpriteSet.h"
 #include "Visual.h"
+#include "WellKnown.h"
 
 #include <cmath>
 
@@ -101,7 +101,7 @@ void Flotsam::Move(vector<Visual> &visuals)
 		return;
 	
 	// This flotsam has reached the end of its life. 
-	const Effect *effect = GameData::Effects().Get("flotsam death");
+	const Effect *effect = WellKnown::Get(WellKnown::FLOTSAM_DEATH);
 	for(int i = 0; i < 3; ++i)
 	{
 		Angle smokeAngle = Angle::Random();
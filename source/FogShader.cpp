@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "FogShader.h"
 
+#include "Font.h"
 #include "GameData.h"
 #include "PlayerInfo.h"
 #include "Point.h"
@@ -222,6 +223,7 @@ void FogShader::Draw(const Point &center, double zoom, const PlayerInfo &player)
 		glBindTexture(GL_TEXTURE_2D, texture);
 	
 	// Set up to draw the image.
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
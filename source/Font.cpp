@@ -13,9 +13,11 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Font.h"
 
 #include "Color.h"
-#include "ImageBuffer.h"
 #include "Point.h"
 #include "Screen.h"
+#include "Shader.h"
+
+#include "gl_header.h"
 
 #include <algorithm>
 #include <cmath>
@@ -30,50 +32,104 @@ namespace {
 	const char *vertexCode =
 		// "scale" maps pixel coordinates to GL coordinates (-1 to 1).
 		"uniform vec2 scale;\n"
-		// The (x, y) coordinates of the top left corner of the glyph.
-		"uniform vec2 position;\n"
-		// The glyph to draw. (ASCII value - 32).
-		"uniform int glyph;\n"
-		// Aspect ratio of rendered glyph (unity by default).
-		"uniform float aspect = 1.f;\n"
 		
 		// Inputs from the VBO.
 		"in vec2 vert;\n"
 		"in vec2 corner;\n"
+		"in vec4 color;\n"
 		
 		// Output to the fragment shader.
 		"out vec2 texCoord;\n"
+		"out vec4 fragColor;\n"
 		
-		// Pick the proper glyph out of the texture.
+		// The glyph has already been picked out of the texture.
 		"void main() {\n"
-		"  texCoord = vec2((glyph + corner.x) / 98.f, corner.y);\n"
-		"  gl_Position = vec4((aspect * vert.x + position.x) * scale.x, (vert.y + position.y) * scale.y, 0, 1);\n"
+		"  texCoord = corner;\n"
+		"  fragColor = color;\n"
+		"  gl_Position = vec4(vert * scale, 0, 1);\n"
 		"}\n";
 	
 	const char *fragmentCode =
-		// The user must supply a texture and a color (white by default).
+		// The user must supply a texture.
 		"uniform sampler2D tex;\n"
-		"uniform vec4 color = vec4(1, 1, 1, 1);\n"
 		
-		// This comes from the vertex shader.
+		// These come from the vertex shader.
 		"in vec2 texCoord;\n"
+		"in vec4 fragColor;\n"
 		
 		// Output color.
 		"out vec4 finalColor;\n"
 		
 		// Multiply the texture by the user-specified color (including alpha).
 		"void main() {\n"
-		"  finalColor = texture(tex, texCoord).a * color;\n"
+		"  finalColor = texture(tex, texCoord).a * fragColor;\n"
 		"}\n";
 	
 	const int KERN = 2;
+	
+	// How many measurements to remember, per font.
+	const size_t WIDTH_CACHE_SIZE = 512;
+	const size_t TRUNCATE_CACHE_SIZE = 256;
+	// Measuring a short string is faster than looking it up.
+	const size_t MIN_CACHED_LENGTH = 16;
+	
+	// Ways of truncating a string.
+	const int TRUNCATE_BACK = 0;
+	const int TRUNCATE_FRONT = 1;
+	const int TRUNCATE_MIDDLE = 2;
+	
+	// Each vertex has eight floats: position, texture coordinate, and color.
+	const int VERTEX_SIZE = 8;
+	
+	// All fonts share a single shader and vertex buffer. They are only created
+	// the first time text is actually drawn.
+	Shader shader;
+	GLint scaleI = 0;
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	
+	// Fonts that have batched text waiting to be drawn, in the order in which
+	// they were first used since the last flush.
+	vector<const Font *> pending;
+	
+	void SetUpShader()
+	{
+		shader = Shader(vertexCode, fragmentCode);
+		glUseProgram(shader.Object());
+		glUniform1i(shader.Uniform("tex"), 0);
+		glUseProgram(0);
+		scaleI = shader.Uniform("scale");
+		
+		// Create the VAO and VBO.
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+		
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		
+		// Connect the vertex data to the attributes of the vertex shader.
+		GLsizei stride = VERTEX_SIZE * sizeof(GLfloat);
+		glEnableVertexAttribArray(shader.Attrib("vert"));
+		glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, stride, nullptr);
+		
+		glEnableVertexAttribArray(shader.Attrib("corner"));
+		glVertexAttribPointer(shader.Attrib("corner"), 2, GL_FLOAT, GL_FALSE,
+			stride, reinterpret_cast<const GLvoid *>(2 * sizeof(GLfloat)));
+		
+		glEnableVertexAttribArray(shader.Attrib("color"));
+		glVertexAttribPointer(shader.Attrib("color"), 4, GL_FLOAT, GL_FALSE,
+			stride, reinterpret_cast<const GLvoid *>(4 * sizeof(GLfloat)));
+		
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
 }
 
 
 
 Font::Font()
-	: texture(0), vao(0), vbo(0), colorI(0), scaleI(0), glyphI(0), aspectI(0),
-	  positionI(0), height(0), space(0), screenWidth(0), screenHeight(0)
+	: texture(0), height(0), space(0), glyphWidth(0.f), glyphHeight(0.f),
+	widthCache(WIDTH_CACHE_SIZE), truncateCache(TRUNCATE_CACHE_SIZE)
 {
 }
 
@@ -89,19 +145,25 @@ Font::Font(const string &imagePath)
 
 void Font::Load(const string &imagePath)
 {
-	// Load the texture.
-	ImageBuffer image;
+	// Load the glyph image. It will be uploaded the first time it is needed.
 	if(!image.Read(imagePath))
 		return;
 	
-	LoadTexture(image);
 	CalculateAdvances(image);
-	SetUpShader(image.Width() / GLYPHS, image.Height());
+	glyphWidth = .5f * (image.Width() / GLYPHS);
+	glyphHeight = .5f * image.Height();
 }
 
 
 
 void Font::Draw(const string &str, const Point &point, const Color &color) const
+{
+	DrawAliased(str.c_str(), round(point.X()), round(point.Y()), color);
+}
+
+
+
+void Font::Draw(const char *str, const Point &point, const Color &color) const
 {
 	DrawAliased(str, round(point.X()), round(point.Y()), color);
 }
@@ -110,31 +172,28 @@ void Font::Draw(const string &str, const Point &point, const Color &color) const
 
 void Font::DrawAliased(const string &str, double x, double y, const Color &color) const
 {
-	glUseProgram(shader.Object());
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glBindVertexArray(vao);
-	
-	glUniform4fv(colorI, 1, color.Get());
-	
-	// Update the scale, only if the screen size has changed.
-	if(Screen::Width() != screenWidth || Screen::Height() != screenHeight)
-	{
-		screenWidth = Screen::Width();
-		screenHeight = Screen::Height();
-		GLfloat scale[2] = {2.f / screenWidth, -2.f / screenHeight};
-		glUniform2fv(scaleI, 1, scale);
-	}
+	DrawAliased(str.c_str(), x, y, color);
+}
+
+
+
+void Font::DrawAliased(const char *str, double x, double y, const Color &color) const
+{
+	// If this is the first text drawn with this font since the last flush,
+	// make sure this font's batch will be drawn.
+	if(vertices.empty())
+		pending.push_back(this);
 	
-	GLfloat textPos[2] = {
-		static_cast<float>(x - 1.),
-		static_cast<float>(y)};
+	float textX = x - 1.;
+	float textY = y;
 	int previous = 0;
 	bool isAfterSpace = true;
 	bool underlineChar = false;
 	const int underscoreGlyph = max(0, min(GLYPHS - 1, '_' - 32));
 	
-	for(char c : str)
+	for( ; *str; ++str)
 	{
+		char c = *str;
 		if(c == '_')
 		{
 			underlineChar = showUnderlines;
@@ -146,42 +205,40 @@ void Font::DrawAliased(const string &str, double x, double y, const Color &color
 			isAfterSpace = !glyph;
 		if(!glyph)
 		{
-			textPos[0] += space;
+			textX += space;
 			continue;
 		}
 		
-		glUniform1i(glyphI, glyph);
-		glUniform1f(aspectI, 1.f);
-		
-		textPos[0] += advance[previous * GLYPHS + glyph] + KERN;
-		glUniform2fv(positionI, 1, textPos);
-		
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		textX += advance[previous * GLYPHS + glyph] + KERN;
+		AddGlyph(glyph, textX, textY, 1.f, color.Get());
 		
 		if(underlineChar)
 		{
-			glUniform1i(glyphI, underscoreGlyph);
-			glUniform1f(aspectI, static_cast<float>(advance[glyph * GLYPHS] + KERN)
-				/ (advance[underscoreGlyph * GLYPHS] + KERN));
-			
-			glUniform2fv(positionI, 1, textPos);
-			
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			float aspect = static_cast<float>(advance[glyph * GLYPHS] + KERN)
+				/ (advance[underscoreGlyph * GLYPHS] + KERN);
+			AddGlyph(underscoreGlyph, textX, textY, aspect, color.Get());
 			underlineChar = false;
 		}
 		
 		previous = glyph;
 	}
-	
-	glBindVertexArray(0);
-	glUseProgram(0);
 }
 
 
 
 int Font::Width(const string &str, char after) const
 {
-	return Width(str.c_str(), after);
+	if(str.length() < MIN_CACHED_LENGTH)
+		return Width(str.c_str(), after);
+	
+	uint64_t key = LayoutHash(str.data(), str.length(), after);
+	const CachedText *cached = widthCache.Get(key);
+	if(cached && cached->parameter == after && cached->text == str)
+		return cached->width;
+	
+	int width = Width(str.c_str(), after);
+	widthCache.Set(key, CachedText{str, after, width, string()});
+	return width;
 }
 
 
@@ -216,6 +273,141 @@ int Font::Width(const char *str, char after) const
 
 
 string Font::Truncate(const string &str, int width) const
+{
+	return Truncated(str, width, TRUNCATE_BACK);
+}
+
+
+
+string Font::TruncateFront(const string &str, int width) const
+{
+	return Truncated(str, width, TRUNCATE_FRONT);
+}
+
+
+
+string Font::TruncateMiddle(const string &str, int width) const
+{
+	return Truncated(str, width, TRUNCATE_MIDDLE);
+}
+
+
+
+int Font::Height() const
+{
+	return height;
+}
+
+
+
+int Font::Space() const
+{
+	return space;
+}
+
+
+
+void Font::ShowUnderlines(bool show)
+{
+	showUnderlines = show;
+}
+
+
+
+// Get statistics on how well the cached measurements are working.
+CacheStats Font::WidthCacheStats() const
+{
+	return widthCache.Stats();
+}
+
+
+
+CacheStats Font::TruncateCacheStats() const
+{
+	return truncateCache.Stats();
+}
+
+
+
+// Draw all the text that has been batched since the last flush.
+void Font::Flush()
+{
+	if(pending.empty())
+		return;
+	
+	if(!shader.Object())
+		SetUpShader();
+	
+	glUseProgram(shader.Object());
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	
+	GLfloat scale[2] = {2.f / Screen::Width(), -2.f / Screen::Height()};
+	glUniform2fv(scaleI, 1, scale);
+	
+	for(const Font *font : pending)
+	{
+		if(!font->texture)
+			font->LoadTexture();
+		
+		glBindTexture(GL_TEXTURE_2D, font->texture);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * font->vertices.size(),
+			font->vertices.data(), GL_STREAM_DRAW);
+		glDrawArrays(GL_TRIANGLES, 0, font->vertices.size() / VERTEX_SIZE);
+		
+		// Clearing the vector keeps its capacity for the next frame.
+		font->vertices.clear();
+	}
+	pending.clear();
+	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
+
+
+
+// Throw away any batched text without drawing it.
+void Font::Discard()
+{
+	for(const Font *font : pending)
+		font->vertices.clear();
+	pending.clear();
+}
+
+
+
+int Font::Glyph(char c, bool isAfterSpace)
+{
+	// Curly quotes.
+	if(c == '\'' && isAfterSpace)
+		return 96;
+	if(c == '"' && isAfterSpace)
+		return 97;
+	
+	return max(0, min(GLYPHS - 3, c - 32));
+}
+
+
+
+// Check if the given truncation is cached, and calculate it if not.
+string Font::Truncated(const string &str, int width, int mode) const
+{
+	// Each mode and width gets a different hash for the same string.
+	int parameter = width * 3 + mode;
+	uint64_t key = LayoutHash(str.data(), str.length(), parameter);
+	const CachedText *cached = truncateCache.Get(key);
+	if(cached && cached->parameter == parameter && cached->text == str)
+		return cached->result;
+	
+	string result = (mode == TRUNCATE_FRONT) ? DoTruncateFront(str, width) :
+		(mode == TRUNCATE_MIDDLE) ? DoTruncateMiddle(str, width) : DoTruncate(str, width);
+	return truncateCache.Set(key, CachedText{str, parameter, 0, result}).result;
+}
+
+
+
+string Font::DoTruncate(const string &str, int width) const
 {
 	int prevChars = str.size();
 	int prevWidth = Width(str);
@@ -236,7 +428,7 @@ string Font::Truncate(const string &str, int width) const
 		bool prevWorks = (prevWidth <= width);
 		nextChars += (prevWorks ? isSame : -isSame);
 		
-		int nextWidth = Width(str.substr(0, nextChars), '.');
+		int nextWidth = Width(str.substr(0, nextChars).c_str(), '.');
 		bool nextWorks = (nextWidth <= width);
 		if(prevWorks != nextWorks && abs(nextChars - prevChars) == 1)
 			return str.substr(0, min(prevChars, nextChars)) + "...";
@@ -249,7 +441,7 @@ string Font::Truncate(const string &str, int width) const
 
 
 
-string Font::TruncateFront(const string &str, int width) const
+string Font::DoTruncateFront(const string &str, int width) const
 {
 	int prevChars = str.size();
 	int prevWidth = Width(str);
@@ -270,7 +462,7 @@ string Font::TruncateFront(const string &str, int width) const
 		bool prevWorks = (prevWidth <= width);
 		nextChars += (prevWorks ? isSame : -isSame);
 		
-		int nextWidth = Width(str.substr(str.size() - nextChars));
+		int nextWidth = Width(str.substr(str.size() - nextChars).c_str());
 		bool nextWorks = (nextWidth <= width);
 		if(prevWorks != nextWorks && abs(nextChars - prevChars) == 1)
 			return "..." + str.substr(str.size() - min(prevChars, nextChars));
@@ -283,7 +475,7 @@ string Font::TruncateFront(const string &str, int width) const
 
 
 
-string Font::TruncateMiddle(const string &str, int width) const
+string Font::DoTruncateMiddle(const string &str, int width) const
 {
 	int prevChars = str.size();
 	int prevWidth = Width(str);
@@ -306,7 +498,7 @@ string Font::TruncateMiddle(const string &str, int width) const
 		
 		int leftChars = nextChars / 2;
 		int rightChars = nextChars - leftChars;
-		int nextWidth = Width(str.substr(0, leftChars) + str.substr(str.size() - rightChars));
+		int nextWidth = Width((str.substr(0, leftChars) + str.substr(str.size() - rightChars)).c_str());
 		bool nextWorks = (nextWidth <= width);
 		if(prevWorks != nextWorks && abs(nextChars - prevChars) == 1)
 		{
@@ -323,41 +515,7 @@ string Font::TruncateMiddle(const string &str, int width) const
 
 
 
-int Font::Height() const
-{
-	return height;
-}
-
-
-
-int Font::Space() const
-{
-	return space;
-}
-
-
-
-void Font::ShowUnderlines(bool show)
-{
-	showUnderlines = show;
-}
-
-
-
-int Font::Glyph(char c, bool isAfterSpace)
-{
-	// Curly quotes.
-	if(c == '\'' && isAfterSpace)
-		return 96;
-	if(c == '"' && isAfterSpace)
-		return 97;
-	
-	return max(0, min(GLYPHS - 3, c - 32));
-}
-
-
-
-void Font::LoadTexture(ImageBuffer &image)
+void Font::LoadTexture() const
 {
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
@@ -369,6 +527,9 @@ void Font::LoadTexture(ImageBuffer &image)
 	
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.Width(), image.Height(), 0,
 		GL_BGRA, GL_UNSIGNED_BYTE, image.Pixels());
+	
+	// The pixel data is no longer needed once it is on the GPU.
+	image.Clear();
 }
 
 
@@ -435,49 +596,27 @@ void Font::CalculateAdvances(ImageBuffer &image)
 
 
 
-void Font::SetUpShader(float glyphW, float glyphH)
+// Add a quad for the given glyph, with its top left corner at (x, y).
+void Font::AddGlyph(int glyph, float x, float y, float aspect, const float *color) const
 {
-	glyphW *= .5f;
-	glyphH *= .5f;
-	
-	shader = Shader(vertexCode, fragmentCode);
-	glUseProgram(shader.Object());
-	glUniform1i(shader.Uniform("tex"), 0);
-	glUseProgram(0);
-	
-	// Create the VAO and VBO.
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	float left = x;
+	float right = x + aspect * glyphWidth;
+	float top = y;
+	float bottom = y + glyphHeight;
+	float s0 = glyph / static_cast<float>(GLYPHS);
+	float s1 = (glyph + 1) / static_cast<float>(GLYPHS);
 	
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	
-	GLfloat vertices[] = {
-		   0.f,    0.f, 0.f, 0.f,
-		   0.f, glyphH, 0.f, 1.f,
-		glyphW,    0.f, 1.f, 0.f,
-		glyphW, glyphH, 1.f, 1.f
+	const float corners[6][4] = {
+		{left, top, s0, 0.f},
+		{left, bottom, s0, 1.f},
+		{right, top, s1, 0.f},
+		{right, top, s1, 0.f},
+		{left, bottom, s0, 1.f},
+		{right, bottom, s1, 1.f}
 	};
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-	
-	// connect the xy to the "vert" attribute of the vertex shader
-	glEnableVertexAttribArray(shader.Attrib("vert"));
-	glVertexAttribPointer(shader.Attrib("vert"), 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
-	
-	glEnableVertexAttribArray(shader.Attrib("corner"));
-	glVertexAttribPointer(shader.Attrib("corner"), 2, GL_FLOAT, GL_FALSE,
-		4 * sizeof(GLfloat), (const GLvoid*)(2 * sizeof(GLfloat)));
-	
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	
-	// We must update the screen size next time we draw.
-	screenWidth = 0;
-	screenHeight = 0;
-	
-	colorI = shader.Uniform("color");
-	scaleI = shader.Uniform("scale");
-	glyphI = shader.Uniform("glyph");
-	aspectI = shader.Uniform("aspect");
-	positionI = shader.Uniform("position");
+	for(const float *corner : corners)
+	{
+		vertices.insert(vertices.end(), corner, corner + 4);
+		vertices.insert(vertices.end(), color, color + 4);
+	}
 }
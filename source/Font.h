@@ -13,14 +13,14 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef FONT_H_
 #define FONT_H_
 
-#include "Shader.h"
-
-#include "gl_header.h"
+#include "ImageBuffer.h"
+#include "LayoutCache.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class Color;
-class ImageBuffer;
 class Point;
 
 
@@ -29,6 +29,10 @@ class Point;
 // glyphs for each character in ASCII order (not counting control characters).
 // The kerning between characters is automatically adjusted to look good. At the
 // moment only plain ASCII characters are supported, not Unicode.
+// Drawing text does not issue any OpenGL commands right away. Instead, a quad
+// for each glyph is added to a batch, and all the batched text is drawn with a
+// single draw call per font when Flush() is called. Any other shader must call
+// Flush() before it draws anything, so that text is layered correctly.
 class Font {
 public:
 	Font();
@@ -37,7 +41,9 @@ public:
 	void Load(const std::string &imagePath);
 	
 	void Draw(const std::string &str, const Point &point, const Color &color) const;
+	void Draw(const char *str, const Point &point, const Color &color) const;
 	void DrawAliased(const std::string &str, double x, double y, const Color &color) const;
+	void DrawAliased(const char *str, double x, double y, const Color &color) const;
 	
 	int Width(const std::string &str, char after = ' ') const;
 	int Width(const char *str, char after = ' ') const;
@@ -51,33 +57,62 @@ public:
 	
 	static void ShowUnderlines(bool show);
 	
+	// Get statistics on how well the cached measurements are working.
+	CacheStats WidthCacheStats() const;
+	CacheStats TruncateCacheStats() const;
+	
+	// Draw all the text that has been batched since the last flush.
+	static void Flush();
+	// Throw away any batched text without drawing it. This is only useful if
+	// there is no OpenGL context, e.g. when measuring how long layout takes.
+	static void Discard();
+	
 	
 private:
 	static int Glyph(char c, bool isAfterSpace);
-	void LoadTexture(ImageBuffer &image);
+	void LoadTexture() const;
 	void CalculateAdvances(ImageBuffer &image);
-	void SetUpShader(float glyphW, float glyphH);
+	void AddGlyph(int glyph, float x, float y, float aspect, const float *color) const;
+	
+	std::string Truncated(const std::string &str, int width, int mode) const;
+	std::string DoTruncate(const std::string &str, int width) const;
+	std::string DoTruncateFront(const std::string &str, int width) const;
+	std::string DoTruncateMiddle(const std::string &str, int width) const;
 	
 	
 private:
-	Shader shader;
-	GLuint texture;
-	GLuint vao;
-	GLuint vbo;
+	// A cached measurement, along with the text and parameter it applies to.
+	class CachedText {
+	public:
+		std::string text;
+		int parameter;
+		int width;
+		std::string result;
+	};
 	
-	GLint colorI;
-	GLint scaleI;
-	GLint glyphI;
-	GLint aspectI;
-	GLint positionI;
+	
+private:
+	// The glyph image is only uploaded the first time this font is flushed, so
+	// that the metrics can be used even if there is no OpenGL context.
+	mutable ImageBuffer image;
+	mutable uint32_t texture;
 	
 	int height;
 	int space;
-	mutable int screenWidth;
-	mutable int screenHeight;
+	float glyphWidth;
+	float glyphHeight;
 	
 	static const int GLYPHS = 98;
 	int advance[GLYPHS * GLYPHS];
+	
+	// Batched glyph quads, as two triangles each. Each vertex has an (x, y)
+	// position in pixels, (s, t) texture coordinates, and an RGBA color.
+	mutable std::vector<float> vertices;
+	
+	// Most strings are measured or truncated every frame, so remember the
+	// results for the most recently used ones.
+	mutable LayoutCache<uint64_t, CachedText> widthCache;
+	mutable LayoutCache<uint64_t, CachedText> truncateCache;
 };
 
 
@@ -0,0 +1,134 @@
+/* FrameArena.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+
+
+FrameArena::FrameArena(size_t capacity)
+	: capacity(capacity)
+{
+}
+
+
+
+void *FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	++allocations;
+	// The buffer itself is aligned for any type, so only the offset into it
+	// needs to be rounded up.
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+	if(start >= capacity || bytes > capacity - start)
+	{
+		++overflows;
+		return ::operator new(bytes);
+	}
+	if(!buffer)
+		buffer.reset(new char[capacity]);
+	used = start + bytes;
+	peak = max(peak, used);
+	return buffer.get() + start;
+}
+
+
+
+void FrameArena::Deallocate(void *pointer, size_t bytes)
+{
+	char *it = static_cast<char *>(pointer);
+	if(!buffer || it < buffer.get() || it >= buffer.get() + capacity)
+		::operator delete(pointer);
+	// Scratch lists are often freed in the reverse of the order they were
+	// allocated, so the most recent allocation can be given back.
+	else if(it + bytes == buffer.get() + used)
+		used = it - buffer.get();
+	// Anything past the end of the used space was already freed by Rewind().
+	else if(it < buffer.get() + used)
+	{
+		++lost;
+		lostBytes += bytes;
+	}
+}
+
+
+
+// Free everything in the arena. Anything allocated from it must already
+// have been destroyed.
+void FrameArena::Reset()
+{
+	used = 0;
+	allocations = 0;
+	overflows = 0;
+	peak = 0;
+	lost = 0;
+	lostBytes = 0;
+}
+
+
+
+// Remember how much of the arena is in use, so that scratch data that is
+// only needed for one function call can be freed all at once afterwards.
+size_t FrameArena::Mark() const
+{
+	return used;
+}
+
+
+
+void FrameArena::Rewind(size_t mark)
+{
+	used = mark;
+}
+
+
+
+// Get the number of allocations since the arena was reset, and how many of
+// them did not fit and had to come from the heap instead.
+size_t FrameArena::Allocations() const
+{
+	return allocations;
+}
+
+
+
+size_t FrameArena::Overflows() const
+{
+	return overflows;
+}
+
+
+
+// Get the most bytes that were in use at once since the arena was reset.
+size_t FrameArena::Peak() const
+{
+	return peak;
+}
+
+
+
+// Get how many allocations were freed but could not be given back, and how
+// many bytes they held.
+size_t FrameArena::Lost() const
+{
+	return lost;
+}
+
+
+
+size_t FrameArena::LostBytes() const
+{
+	return lostBytes;
+}
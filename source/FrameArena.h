@@ -0,0 +1,99 @@
+/* FrameArena.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef FRAME_ARENA_H_
+#define FRAME_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+
+
+
+// Class representing a fixed-size block of memory for scratch data that only
+// lasts for one step of the game, such as lists of ships that are rebuilt every
+// step. Allocating memory just advances a pointer, and freeing it does nothing
+// unless it was the most recent allocation. Instead, the whole arena is reset
+// at the start of each step. If the arena is full, memory comes from the heap.
+// The memory for the arena is not allocated until it is first used.
+class FrameArena {
+public:
+	// Allocator for using an arena in a standard container. The container must
+	// be destroyed or cleared before the arena is reset.
+	template <class Type>
+	class Allocator {
+	public:
+		typedef Type value_type;
+		template <class Other>
+		struct rebind { typedef Allocator<Other> other; };
+		
+		Allocator(FrameArena &arena) : arena(&arena) {}
+		template <class Other>
+		Allocator(const Allocator<Other> &other) : arena(other.arena) {}
+		
+		Type *allocate(size_t n) { return static_cast<Type *>(arena->Allocate(n * sizeof(Type), alignof(Type))); }
+		void deallocate(Type *pointer, size_t n) { arena->Deallocate(pointer, n * sizeof(Type)); }
+		
+		template <class Other>
+		bool operator==(const Allocator<Other> &other) const { return arena == other.arena; }
+		template <class Other>
+		bool operator!=(const Allocator<Other> &other) const { return arena != other.arena; }
+	
+	private:
+		FrameArena *arena;
+		
+		template <class Other>
+		friend class Allocator;
+	};
+	
+	
+public:
+	explicit FrameArena(size_t capacity);
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+	
+	void *Allocate(size_t bytes, size_t alignment);
+	void Deallocate(void *pointer, size_t bytes);
+	// Free everything in the arena. Anything allocated from it must already
+	// have been destroyed.
+	void Reset();
+	// Remember how much of the arena is in use, so that scratch data that is
+	// only needed for one function call can be freed all at once afterwards.
+	size_t Mark() const;
+	void Rewind(size_t mark);
+	
+	// Get the number of allocations since the arena was reset, and how many of
+	// them did not fit and had to come from the heap instead.
+	size_t Allocations() const;
+	size_t Overflows() const;
+	// Get the most bytes that were in use at once since the arena was reset.
+	size_t Peak() const;
+	// Get how many allocations were freed but could not be given back, and
+	// how many bytes they held. This is mostly the old buffers left behind
+	// when a vector grows. That memory is not reused until the next reset.
+	size_t Lost() const;
+	size_t LostBytes() const;
+	
+	
+private:
+	std::unique_ptr<char[]> buffer;
+	size_t capacity;
+	size_t used = 0;
+	size_t allocations = 0;
+	size_t overflows = 0;
+	size_t peak = 0;
+	size_t lost = 0;
+	size_t lostBytes = 0;
+};
+
+
+
+#endif
@@ -0,0 +1,208 @@
+/* FrameQueue.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "FrameQueue.h"
+
+#include "gl_header.h"
+
+#include <algorithm>
+#include <deque>
+
+using namespace std;
+
+namespace {
+	class Frame {
+	public:
+		FrameQueue::Clock::time_point time[FrameQueue::STAGE_COUNT];
+		bool has[FrameQueue::STAGE_COUNT] = {};
+		GLsync fence = nullptr;
+	};
+	
+	// The frame that is currently being stepped and drawn.
+	Frame current;
+	// Frames that have been submitted, but that the GPU may not be done with.
+	deque<Frame> inFlight;
+	// The most recent completed frames, for calculating statistics.
+	const size_t HISTORY = 60;
+	deque<Frame> history;
+	
+	// Don't wait forever for a fence, in case the driver is misbehaving.
+	const GLuint64 MAX_WAIT = 100000000;
+	
+	// Check if fences can be used to find out when the GPU is done.
+	bool HasSync()
+	{
+#ifdef __APPLE__
+		return true;
+#else
+		static const bool hasSync = (GLEW_VERSION_3_2 || GLEW_ARB_sync);
+		return hasSync;
+#endif
+	}
+	
+	double Seconds(FrameQueue::Clock::duration duration)
+	{
+		return chrono::duration_cast<chrono::duration<double>>(duration).count();
+	}
+	
+	// Move the oldest frame that was in flight into the history.
+	void Retire()
+	{
+		Frame &frame = inFlight.front();
+		if(frame.fence)
+			glDeleteSync(frame.fence);
+		frame.fence = nullptr;
+		frame.time[FrameQueue::COMPLETE] = FrameQueue::Clock::now();
+		frame.has[FrameQueue::COMPLETE] = true;
+		
+		history.push_back(frame);
+		if(history.size() > HISTORY)
+			history.pop_front();
+		inFlight.pop_front();
+	}
+	
+	// Retire all the frames that the GPU has finished, without waiting.
+	void Poll()
+	{
+		while(!inFlight.empty())
+		{
+			GLsync fence = inFlight.front().fence;
+			if(fence)
+			{
+				GLint status = GL_UNSIGNALED;
+				glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+				if(status != GL_SIGNALED)
+					break;
+			}
+			Retire();
+		}
+	}
+}
+
+
+
+// Start a new frame, recording the current time as its input time.
+void FrameQueue::BeginFrame()
+{
+	// Checking here as well as in Submit() means that a frame's completion
+	// time is never off by more than the time it takes to step the panels.
+	Poll();
+	
+	current = Frame();
+	Mark(INPUT);
+}
+
+
+
+// Record that the current frame reached the given stage now, unless a time
+// was already given for that stage.
+void FrameQueue::Mark(Stage stage)
+{
+	if(!current.has[stage])
+		Mark(stage, Clock::now());
+}
+
+
+
+// Record that the current frame reached the given stage at the given time.
+void FrameQueue::Mark(Stage stage, Clock::time_point time)
+{
+	current.time[stage] = time;
+	current.has[stage] = true;
+}
+
+
+
+// Get the time that the current frame reached the given stage.
+FrameQueue::Clock::time_point FrameQueue::Time(Stage stage)
+{
+	return current.time[stage];
+}
+
+
+
+// Call this after swapping buffers. If more than the given number of frames
+// are now waiting for the GPU, wait until the oldest one is done.
+void FrameQueue::Submit(int depth)
+{
+	Mark(SUBMIT);
+	if(HasSync())
+		current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	inFlight.push_back(current);
+	current = Frame();
+	
+	Poll();
+	while(depth > 0 && static_cast<int>(inFlight.size()) > depth)
+	{
+		GLenum result = glClientWaitSync(inFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, MAX_WAIT);
+		if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			break;
+		Retire();
+	}
+}
+
+
+
+// Get the average time from input to a completed frame over the last 60 frames.
+double FrameQueue::Latency()
+{
+	if(history.empty())
+		return 0.;
+	
+	Clock::duration sum = Clock::duration::zero();
+	for(const Frame &frame : history)
+		sum += frame.time[COMPLETE] - frame.time[INPUT];
+	return Seconds(sum) / history.size();
+}
+
+
+
+double FrameQueue::MaxLatency()
+{
+	Clock::duration worst = Clock::duration::zero();
+	for(const Frame &frame : history)
+		worst = max(worst, frame.time[COMPLETE] - frame.time[INPUT]);
+	return Seconds(worst);
+}
+
+
+
+// Get the average time spent reaching the given stage from the one before it.
+// Frames that skipped this stage are not counted.
+double FrameQueue::StageTime(Stage stage)
+{
+	Clock::duration sum = Clock::duration::zero();
+	int count = 0;
+	for(const Frame &frame : history)
+	{
+		if(!frame.has[stage])
+			continue;
+		
+		int previous = stage - 1;
+		while(previous > INPUT && !frame.has[previous])
+			--previous;
+		if(previous < INPUT)
+			continue;
+		
+		sum += frame.time[stage] - frame.time[previous];
+		++count;
+	}
+	return count ? Seconds(sum) / count : 0.;
+}
+
+
+
+// Get the number of frames that the GPU has not finished yet.
+int FrameQueue::InFlight()
+{
+	return inFlight.size();
+}
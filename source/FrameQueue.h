@@ -0,0 +1,81 @@
+/* FrameQueue.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef FRAME_QUEUE_H_
+#define FRAME_QUEUE_H_
+
+#include <chrono>
+
+
+
+// Class that follows each frame through the stages of the game loop, from the
+// time the input it reflects was read until the GPU has finished drawing it,
+// and that limits how many frames can be waiting for the GPU at once. Without
+// a limit, the driver may let the game get two or three frames ahead of what
+// is actually on screen, which adds that much latency to every key press.
+// All of these functions must only be called from the drawing thread.
+class FrameQueue {
+public:
+	typedef std::chrono::steady_clock Clock;
+	
+	// The stages of a frame, in the order that they happen.
+	enum Stage {
+		// The input that this frame reflects was read.
+		INPUT,
+		// All the panels were stepped forward.
+		STEP,
+		// The calculation thread took the game step shown in this frame off of
+		// its queue and started it, and then finished it. These are only
+		// recorded for the main game view.
+		CALCULATE,
+		CALCULATED,
+		// Drawing started, and then all drawing was done and the buffers were
+		// swapped.
+		DRAW,
+		SUBMIT,
+		// The GPU finished drawing this frame.
+		COMPLETE,
+		STAGE_COUNT
+	};
+	
+	
+public:
+	// Start a new frame, recording the current time as its input time.
+	static void BeginFrame();
+	// Record that the current frame reached the given stage now, unless a time
+	// was already given for that stage.
+	static void Mark(Stage stage);
+	// Record that the current frame reached the given stage at the given time.
+	// Anything reflecting older input can override the input time this way.
+	static void Mark(Stage stage, Clock::time_point time);
+	// Get the time that the current frame reached the given stage.
+	static Clock::time_point Time(Stage stage);
+	
+	// Call this after swapping buffers. If more than the given number of frames
+	// are now waiting for the GPU, wait until the oldest one is done. A depth of
+	// zero means to let the driver decide how far ahead the game can get.
+	static void Submit(int depth);
+	
+	// Get the average and worst time from input to a completed frame over the
+	// last 60 frames, in seconds.
+	static double Latency();
+	static double MaxLatency();
+	// Get the average time spent reaching the given stage from the one before
+	// it, over the last 60 frames, in seconds.
+	static double StageTime(Stage stage);
+	// Get the number of frames that the GPU has not finished yet.
+	static int InFlight();
+};
+
+
+
+#endif
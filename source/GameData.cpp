@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "GameData.h"
 
+#include "Allocations.h"
 #include "Audio.h"
 #include "BatchShader.h"
 #include "Color.h"
@@ -20,6 +21,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "DataFile.h"
 #include "DataNode.h"
 #include "DataWriter.h"
+#include "DotShader.h"
 #include "Effect.h"
 #include "Files.h"
 #include "FillShader.h"
@@ -31,6 +33,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Government.h"
 #include "ImageSet.h"
 #include "Interface.h"
+#include "Journal.h"
 #include "LineShader.h"
 #include "Minable.h"
 #include "Mission.h"
@@ -52,11 +55,21 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "SpriteShader.h"
 #include "StarField.h"
 #include "StartConditions.h"
+#include "StellarObject.h"
 #include "System.h"
+#include "SystemGrid.h"
+#include "WellKnown.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -81,17 +94,22 @@ namespace {
 	Set<Planet> planets;
 	Set<Ship> ships;
 	Set<System> systems;
+	// Spatial index of the systems, for finding each one's neighbors.
+	SystemGrid systemGrid;
 	
 	Set<Sale<Ship>> shipSales;
 	Set<Sale<Outfit>> outfitSales;
 	
-	Set<Fleet> defaultFleets;
-	Set<Government> defaultGovernments;
-	Set<Planet> defaultPlanets;
-	Set<System> defaultSystems;
-	Set<Galaxy> defaultGalaxies;
-	Set<Sale<Ship>> defaultShipSales;
-	Set<Sale<Outfit>> defaultOutfitSales;
+	// Events can modify these sets. Each journal saves the original state of
+	// anything that is modified, so it can be restored when a new pilot is
+	// loaded without having to keep a copy of the entire universe.
+	Journal<Fleet> fleetJournal(fleets);
+	Journal<Government> governmentJournal(governments);
+	Journal<Planet> planetJournal(planets);
+	Journal<System> systemJournal(systems);
+	Journal<Galaxy> galaxyJournal(galaxies);
+	Journal<Sale<Ship>> shipSaleJournal(shipSales);
+	Journal<Sale<Outfit>> outfitSaleJournal(outfitSales);
 	
 	Politics politics;
 	StartConditions startConditions;
@@ -115,9 +133,187 @@ namespace {
 	
 	vector<string> sources;
 	map<const Sprite *, shared_ptr<ImageSet>> deferred;
-	map<const Sprite *, int> preloaded;
+	// The deferred sprites that are loaded, with the most recently used first.
+	list<const Sprite *> preloaded;
 	
 	const Government *playerGovernment = nullptr;
+	bool isLoaded = false;
+	
+	// Check whether the given sprite is the landscape of a planet in the given
+	// system.
+	bool IsLandscapeIn(const Sprite *sprite, const System *system)
+	{
+		if(!system)
+			return false;
+		
+		for(const StellarObject &object : system->Objects())
+			if(object.GetPlanet() && object.GetPlanet()->Landscape() == sprite)
+				return true;
+		return false;
+	}
+	
+	// Begin loading a deferred sprite. If too many are already loaded, unload
+	// the one that was used least recently, unless it is a landscape in the
+	// system that must be kept loaded.
+	void LoadDeferred(const Sprite *sprite, const System *keep)
+	{
+		// Make sure this sprite actually is one that uses deferred loading.
+		auto dit = deferred.find(sprite);
+		if(!sprite || dit == deferred.end())
+			return;
+		
+		// If this sprite is one of the currently loaded ones, there is no need to
+		// load it again. But, make note of the fact that it is the most recently
+		// asked-for sprite.
+		auto pit = find(preloaded.begin(), preloaded.end(), sprite);
+		if(pit != preloaded.end())
+		{
+			preloaded.splice(preloaded.begin(), preloaded, pit);
+			return;
+		}
+		
+		// This sprite is not currently preloaded. Check to see whether we already
+		// have the maximum number of sprites loaded, in which case the oldest one
+		// must be unloaded to make room for this one.
+		if(preloaded.size() >= 20)
+		{
+			auto oldest = find_if(preloaded.rbegin(), preloaded.rend(),
+				[keep](const Sprite *loaded) { return !IsLandscapeIn(loaded, keep); });
+			if(oldest == preloaded.rend())
+				return;
+			spriteQueue.Unload((*oldest)->Name());
+			preloaded.erase(next(oldest).base());
+		}
+		
+		// Now, load all the files for this sprite.
+		preloaded.push_front(sprite);
+		spriteQueue.Add(dit->second, true);
+	}
+	
+	// Update the neighbor lists after the given systems have been changed. The
+	// only systems whose neighbors can change are the ones near where each one
+	// was before (as given in the map) and where it is now. Any other systems
+	// that must be updated anyway are given in the set.
+	void UpdateNeighborsNear(const map<System *, Point> &changed, set<System *> affected)
+	{
+		for(const auto &it : changed)
+			systemGrid.Place(it.first);
+		
+		for(const auto &it : changed)
+		{
+			for(System *other : systemGrid.Near(it.second))
+				affected.insert(other);
+			for(System *other : systemGrid.Near(it.first->Position()))
+				affected.insert(other);
+			affected.insert(it.first);
+		}
+		
+		for(System *other : affected)
+			systemJournal.Modify(other->Name())->UpdateNeighbors(systemGrid);
+	}
+	
+	// Loading a system tells each planet in it what system it is in, so any
+	// planets that the given system node mentions will be modified.
+	void ModifyPlanets(const DataNode &node)
+	{
+		for(const DataNode &child : node)
+		{
+			bool isAdded = (child.Token(0) == "add");
+			if(child.Size() < 1 + isAdded || child.Token(isAdded) != "object")
+				continue;
+			
+			if(child.Size() >= 2 + isAdded)
+				planetJournal.Modify(child.Token(1 + isAdded));
+			ModifyPlanets(child);
+		}
+	}
+	
+	// Parse the given data files on worker threads, and pass each one to the
+	// given function, in order, as soon as it and all the files before it have
+	// been parsed. Only a few files are parsed ahead of the one being loaded, so
+	// the whole data tree never needs to be held in memory at once.
+	void ParseInOrder(const vector<string> &paths, const function<void(const DataFile &)> &load)
+	{
+		vector<unique_ptr<DataFile>> parsed(paths.size());
+		size_t next = 0;
+		size_t loaded = 0;
+		mutex parsedMutex;
+		condition_variable parsedCondition;
+		
+		// The main thread is busy loading while the workers parse.
+		unsigned count = thread::hardware_concurrency();
+		vector<thread> threads(count > 2 ? count - 1 : 1);
+		const size_t LOOKAHEAD = 4 * threads.size();
+		for(thread &t : threads)
+			t = thread([&]()
+			{
+				unique_lock<mutex> lock(parsedMutex);
+				while(true)
+				{
+					parsedCondition.wait(lock, [&](){ return next == paths.size() || next < loaded + LOOKAHEAD; });
+					if(next == paths.size())
+						return;
+					
+					size_t index = next++;
+					lock.unlock();
+					unique_ptr<DataFile> file(new DataFile(paths[index]));
+					lock.lock();
+					parsed[index] = move(file);
+					parsedCondition.notify_all();
+				}
+			});
+		
+		for(size_t i = 0; i < paths.size(); ++i)
+		{
+			unique_ptr<DataFile> file;
+			{
+				unique_lock<mutex> lock(parsedMutex);
+				parsedCondition.wait(lock, [&](){ return parsed[i] != nullptr; });
+				file = move(parsed[i]);
+				++loaded;
+			}
+			parsedCondition.notify_all();
+			load(*file);
+		}
+		for(thread &t : threads)
+			t.join();
+	}
+	
+	// Add the objects in the given set to the totals. This only counts the set
+	// itself, not any memory that the objects point to.
+	template <class Type>
+	void Measure(const Set<Type> &set, int64_t &bytes, int64_t &objects)
+	{
+		objects += set.size();
+		bytes += set.size() * (sizeof(pair<const string, Type>) + sizeof(Type *));
+	}
+	
+	// Keep track of how much memory the sets of game objects are taking up.
+	void UpdateMemory()
+	{
+		int64_t bytes = 0;
+		int64_t objects = 0;
+		Measure(colors, bytes, objects);
+		Measure(conversations, bytes, objects);
+		Measure(effects, bytes, objects);
+		Measure(events, bytes, objects);
+		Measure(fleets, bytes, objects);
+		Measure(galaxies, bytes, objects);
+		Measure(governments, bytes, objects);
+		Measure(interfaces, bytes, objects);
+		Measure(minables, bytes, objects);
+		Measure(missions, bytes, objects);
+		Measure(outfits, bytes, objects);
+		Measure(persons, bytes, objects);
+		Measure(phrases, bytes, objects);
+		Measure(planets, bytes, objects);
+		Measure(ships, bytes, objects);
+		Measure(systems, bytes, objects);
+		Measure(shipSales, bytes, objects);
+		Measure(outfitSales, bytes, objects);
+		Measure(news, bytes, objects);
+		Allocations::Set(Allocations::GAME_DATA, bytes, objects);
+	}
 }
 
 
@@ -170,18 +366,31 @@ bool GameData::BeginLoad(const char * const *argv)
 	// Generate a catalog of music files.
 	Music::Init(sources);
 	
+	// Iterate through the paths starting with the last directory given. That
+	// is, things in folders near the start of the path have the ability to
+	// override things in folders later in the path.
+	vector<string> dataFiles;
 	for(const string &source : sources)
+		for(const string &path : Files::RecursiveList(source + "data/"))
+			if(path.length() >= 4 && !path.compare(path.length() - 4, 4, ".txt"))
+				dataFiles.push_back(path);
+	
+	// Parsing each file does not depend on any others, so it can be done in
+	// parallel, but the files must be loaded in order.
+	size_t index = 0;
+	ParseInOrder(dataFiles, [&](const DataFile &data)
 	{
-		// Iterate through the paths starting with the last directory given. That
-		// is, things in folders near the start of the path have the ability to
-		// override things in folders later in the path.
-		vector<string> dataFiles = Files::RecursiveList(source + "data/");
-		for(const string &path : dataFiles)
-			LoadFile(path, debugMode);
-	}
+		if(debugMode)
+			Files::LogError("Parsing: " + dataFiles[index]);
+		++index;
+		LoadFile(data);
+	});
 	
 	// Now that all the stars are loaded, update the neighbor lists.
 	UpdateNeighbors();
+	// The effects and sounds that the engine uses can be looked up now. Each
+	// sound is filled in once Audio::Init() loads it.
+	WellKnown::Init();
 	// And, update the ships with the outfits we've now finished loading.
 	for(auto &it : ships)
 		it.second.FinishLoading(true);
@@ -190,16 +399,17 @@ bool GameData::BeginLoad(const char * const *argv)
 	startConditions.FinishLoading();
 	
 	// Store the current state, to revert back to later.
-	defaultFleets = fleets;
-	defaultGovernments = governments;
-	defaultPlanets = planets;
-	defaultSystems = systems;
-	defaultGalaxies = galaxies;
-	defaultShipSales = shipSales;
-	defaultOutfitSales = outfitSales;
+	fleetJournal.Snapshot();
+	governmentJournal.Snapshot();
+	planetJournal.Snapshot();
+	systemJournal.Snapshot();
+	galaxyJournal.Snapshot();
+	shipSaleJournal.Snapshot();
+	outfitSaleJournal.Snapshot();
 	playerGovernment = governments.Get("Escort");
 	
 	politics.Reset();
+	UpdateMemory();
 	
 	if(printShips)
 		PrintShipTable();
@@ -293,6 +503,7 @@ void GameData::LoadShaders()
 	Command::LoadSettings(Files::Resources() + "keys.txt");
 	Command::LoadSettings(Files::Config() + "keys.txt");
 	
+	DotShader::Init();
 	FillShader::Init();
 	FogShader::Init();
 	LineShader::Init();
@@ -309,7 +520,14 @@ void GameData::LoadShaders()
 
 double GameData::Progress()
 {
-	return min(spriteQueue.Progress(), Audio::Progress());
+	double progress = min(spriteQueue.Progress(), Audio::Progress());
+	// Measure the game data again once everything has finished loading.
+	if(progress == 1. && !isLoaded)
+	{
+		isLoaded = true;
+		UpdateMemory();
+	}
+	return progress;
 }
 
 
@@ -318,45 +536,28 @@ double GameData::Progress()
 // done with all landscapes to speed up the program's startup.
 void GameData::Preload(const Sprite *sprite)
 {
-	// Make sure this sprite actually is one that uses deferred loading.
-	auto dit = deferred.find(sprite);
-	if(!sprite || dit == deferred.end())
-		return;
-	
-	// If this sprite is one of the currently loaded ones, there is no need to
-	// load it again. But, make note of the fact that it is the most recently
-	// asked-for sprite.
-	map<const Sprite *, int>::iterator pit = preloaded.find(sprite);
-	if(pit != preloaded.end())
-	{
-		for(pair<const Sprite * const, int> &it : preloaded)
-			if(it.second < pit->second)
-				++it.second;
-		
-		pit->second = 0;
+	LoadDeferred(sprite, nullptr);
+}
+
+
+
+// Make sure the sprites for the given system are loaded by the time the player
+// arrives there: its stellar objects, its haze, and its planets' landscapes.
+// The landscapes of the current system are never unloaded to make room.
+void GameData::Prefetch(const System *system, const System *current)
+{
+	if(!system || system == current)
 		return;
-	}
 	
-	// This sprite is not currently preloaded. Check to see whether we already
-	// have the maximum number of sprites loaded, in which case the oldest one
-	// must be unloaded to make room for this one.
-	const string &name = sprite->Name();
-	pit = preloaded.begin();
-	while(pit != preloaded.end())
+	for(const StellarObject &object : system->Objects())
 	{
-		++pit->second;
-		if(pit->second >= 20)
-		{
-			spriteQueue.Unload(name);
-			pit = preloaded.erase(pit);
-		}
-		else
-			++pit;
+		if(object.GetSprite())
+			object.GetSprite()->MarkDrawn();
+		if(object.GetPlanet())
+			LoadDeferred(object.GetPlanet()->Landscape(), current);
 	}
-	
-	// Now, load all the files for this sprite.
-	preloaded[sprite] = 0;
-	spriteQueue.Add(dit->second);
+	if(system->Haze())
+		system->Haze()->MarkDrawn();
 }
 
 
@@ -364,6 +565,15 @@ void GameData::Preload(const Sprite *sprite)
 void GameData::FinishLoading()
 {
 	spriteQueue.Finish();
+	UpdateMemory();
+}
+
+
+
+// Get the statistics for the sprite textures that are uploaded to the GPU.
+const TextureResidency &GameData::Textures()
+{
+	return spriteQueue.Residency();
 }
 
 
@@ -379,18 +589,33 @@ const vector<string> &GameData::Sources()
 // Revert any changes that have been made to the universe.
 void GameData::Revert()
 {
-	fleets.Revert(defaultFleets);
-	governments.Revert(defaultGovernments);
-	planets.Revert(defaultPlanets);
-	systems.Revert(defaultSystems);
-	galaxies.Revert(defaultGalaxies);
-	shipSales.Revert(defaultShipSales);
-	outfitSales.Revert(defaultOutfitSales);
+	fleetJournal.Revert();
+	governmentJournal.Revert();
+	planetJournal.Revert();
+	galaxyJournal.Revert();
+	shipSaleJournal.Revert();
+	outfitSaleJournal.Revert();
+	
+	// The neighbor lists were reverted along with the systems, but any systems
+	// that were moved must also be put back where they were in the grid. If
+	// any systems were created, the grid must be rebuilt from scratch.
+	int systemCount = systems.size();
+	vector<System *> restored = systemJournal.Revert();
+	if(systems.size() != systemCount)
+		UpdateNeighbors();
+	else
+		for(System *system : restored)
+			systemGrid.Place(system);
+	
+	// The economy changes every day, so it is not tracked by the journal.
+	for(auto &it : systems)
+		it.second.ResetEconomy();
 	for(auto &it : persons)
 		it.second.Restore();
 	
 	politics.Reset();
 	purchases.clear();
+	UpdateMemory();
 }
 
 
@@ -520,41 +745,88 @@ void GameData::AddPurchase(const System &system, const string &commodity, int to
 
 
 
-// Apply the given change to the universe.
-void GameData::Change(const DataNode &node)
+// Apply the given changes to the universe.
+void GameData::Change(const list<DataNode> &changes)
 {
-	if(node.Token(0) == "fleet" && node.Size() >= 2)
-		fleets.Get(node.Token(1))->Load(node);
-	else if(node.Token(0) == "galaxy" && node.Size() >= 2)
-		galaxies.Get(node.Token(1))->Load(node);
-	else if(node.Token(0) == "government" && node.Size() >= 2)
-		governments.Get(node.Token(1))->Load(node);
-	else if(node.Token(0) == "outfitter" && node.Size() >= 2)
-		outfitSales.Get(node.Token(1))->Load(node, outfits);
-	else if(node.Token(0) == "planet" && node.Size() >= 2)
-		planets.Get(node.Token(1))->Load(node);
-	else if(node.Token(0) == "shipyard" && node.Size() >= 2)
-		shipSales.Get(node.Token(1))->Load(node, ships);
-	else if(node.Token(0) == "system" && node.Size() >= 2)
-		systems.Get(node.Token(1))->Load(node, planets);
-	else if(node.Token(0) == "news" && node.Size() >= 2)
-		news.Get(node.Token(1))->Load(node);
-	else if(node.Token(0) == "link" && node.Size() >= 3)
-		systems.Get(node.Token(1))->Link(systems.Get(node.Token(2)));
-	else if(node.Token(0) == "unlink" && node.Size() >= 3)
-		systems.Get(node.Token(1))->Unlink(systems.Get(node.Token(2)));
+	int systemCount = systems.size();
+	// Remember where each changed system was before any of the changes.
+	map<System *, Point> changedSystems;
+	// Whether a system is "uninhabited" depends on its planets, so the systems
+	// that any changed planets are in must be updated too.
+	set<const Planet *> changedPlanets;
+	
+	for(const DataNode &node : changes)
+	{
+		if(node.Token(0) == "fleet" && node.Size() >= 2)
+			fleetJournal.Modify(node.Token(1))->Load(node);
+		else if(node.Token(0) == "galaxy" && node.Size() >= 2)
+			galaxyJournal.Modify(node.Token(1))->Load(node);
+		else if(node.Token(0) == "government" && node.Size() >= 2)
+			governmentJournal.Modify(node.Token(1))->Load(node);
+		else if(node.Token(0) == "outfitter" && node.Size() >= 2)
+			outfitSaleJournal.Modify(node.Token(1))->Load(node, outfits);
+		else if(node.Token(0) == "planet" && node.Size() >= 2)
+		{
+			Planet *planet = planetJournal.Modify(node.Token(1));
+			planet->Load(node);
+			changedPlanets.insert(planet);
+		}
+		else if(node.Token(0) == "shipyard" && node.Size() >= 2)
+			shipSaleJournal.Modify(node.Token(1))->Load(node, ships);
+		else if(node.Token(0) == "system" && node.Size() >= 2)
+		{
+			System *system = systemJournal.Modify(node.Token(1));
+			// Any planets that are removed from this system will be modified too.
+			for(const StellarObject &object : system->Objects())
+				if(object.GetPlanet())
+					planetJournal.Modify(object.GetPlanet()->TrueName());
+			ModifyPlanets(node);
+		
+			changedSystems.emplace(system, system->Position());
+			system->Load(node, planets);
+		}
+		else if(node.Token(0) == "news" && node.Size() >= 2)
+			news.Get(node.Token(1))->Load(node);
+		else if(node.Token(0) == "link" && node.Size() >= 3)
+		{
+			System *other = systemJournal.Modify(node.Token(2));
+			systemJournal.Modify(node.Token(1))->Link(other);
+		}
+		else if(node.Token(0) == "unlink" && node.Size() >= 3)
+		{
+			System *other = systemJournal.Modify(node.Token(2));
+			systemJournal.Modify(node.Token(1))->Unlink(other);
+		}
+		else
+			node.PrintTrace("Invalid \"event\" data:");
+	}
+	
+	// Any systems that these changes created are not in the grid yet. That is
+	// rare enough that it is simplest to just start over from scratch.
+	if(systems.size() != systemCount)
+		UpdateNeighbors();
 	else
-		node.PrintTrace("Invalid \"event\" data:");
+	{
+		set<System *> affected;
+		for(const Planet *planet : changedPlanets)
+			for(const System *system : planet->WormholeSystems())
+				affected.insert(systemJournal.Modify(system->Name()));
+		UpdateNeighborsNear(changedSystems, affected);
+	}
+	UpdateMemory();
 }
 
 
 
-// Update the neighbor lists of all the systems. This must be done any time
-// that a change creates or moves a system.
+// Update the neighbor lists of all the systems, after the star map has been
+// loaded from scratch.
 void GameData::UpdateNeighbors()
 {
+	systemGrid.Clear();
+	for(auto &it : systems)
+		systemGrid.Place(&it.second);
 	for(auto &it : systems)
-		it.second.UpdateNeighbors(systems);
+		it.second.UpdateNeighbors(systemGrid);
 }
 
 
@@ -905,16 +1177,8 @@ void GameData::LoadSources()
 
 
 
-void GameData::LoadFile(const string &path, bool debugMode)
+void GameData::LoadFile(const DataFile &data)
 {
-	// This is an ordinary file. Check to see if it is an image.
-	if(path.length() < 4 || path.compare(path.length() - 4, 4, ".txt"))
-		return;
-	
-	DataFile data(path);
-	if(debugMode)
-		Files::LogError("Parsing: " + path);
-	
 	for(const DataNode &node : data)
 	{
 		const string &key = node.Token(0);
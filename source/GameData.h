@@ -17,6 +17,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Set.h"
 #include "Trade.h"
 
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
@@ -24,6 +25,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 class Color;
 class Conversation;
+class DataFile;
 class DataNode;
 class DataWriter;
 class Date;
@@ -47,6 +49,7 @@ class Sprite;
 class StarField;
 class StartConditions;
 class System;
+class TextureResidency;
 
 
 
@@ -66,7 +69,12 @@ public:
 	// Begin loading a sprite that was previously deferred. Currently this is
 	// done with all landscapes to speed up the program's startup.
 	static void Preload(const Sprite *sprite);
+	// Begin loading any sprites that the given system needs, before the player
+	// arrives there, without unloading the current system's landscapes.
+	static void Prefetch(const System *system, const System *current);
 	static void FinishLoading();
+	// Get the statistics for the sprite textures that are uploaded to the GPU.
+	static const TextureResidency &Textures();
 	
 	// Get the list of resource sources (i.e. plugin folders).
 	static const std::vector<std::string> &Sources();
@@ -79,10 +87,11 @@ public:
 	static void WriteEconomy(DataWriter &out);
 	static void StepEconomy();
 	static void AddPurchase(const System &system, const std::string &commodity, int tons);
-	// Apply the given change to the universe.
-	static void Change(const DataNode &node);
-	// Update the neighbor lists of all the systems. This must be done any time
-	// that a change creates or moves a system.
+	// Apply the given changes to the universe. Once they have all been applied,
+	// the neighbor lists of the systems near any changed systems are updated.
+	static void Change(const std::list<DataNode> &changes);
+	// Update the neighbor lists of all the systems, after the star map has been
+	// loaded from scratch.
 	static void UpdateNeighbors();
 	
 	// Re-activate any special persons that were created previously but that are
@@ -143,7 +152,7 @@ public:
 	
 private:
 	static void LoadSources();
-	static void LoadFile(const std::string &path, bool debugMode);
+	static void LoadFile(const DataFile &data);
 	static std::map<std::string, std::shared_ptr<ImageSet>> FindImages();
 	
 	static void PrintShipTable();
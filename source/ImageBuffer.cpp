@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "ImageBuffer.h"
 
+#include "Allocations.h"
 #include "File.h"
 
 #include <png.h>
@@ -47,6 +48,8 @@ ImageBuffer::~ImageBuffer()
 // Set the number of frames. This must be called before allocating.
 void ImageBuffer::Clear(int frames)
 {
+	if(pixels)
+		Allocations::Remove(Allocations::IMAGE_BUFFERS, sizeof(uint32_t) * width * height * this->frames);
 	delete [] pixels;
 	pixels = nullptr;
 	this->frames = frames;
@@ -66,6 +69,7 @@ void ImageBuffer::Allocate(int width, int height)
 	this->width = width;
 	this->height = height;
 	pixels = new uint32_t[width * height * frames];
+	Allocations::Add(Allocations::IMAGE_BUFFERS, sizeof(uint32_t) * width * height * frames);
 }
 
 
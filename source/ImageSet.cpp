@@ -198,8 +198,9 @@ void ImageSet::Load()
 	buffer[0].Clear(frames);
 	buffer[1].Clear(frames);
 	
-	// Check whether we need to generate collision masks.
-	bool makeMasks = IsMasked(name);
+	// Check whether we need to generate collision masks. If this sprite is being
+	// loaded again, it still has the masks from the first time.
+	bool makeMasks = IsMasked(name) && !hasMasks;
 	if(makeMasks)
 		masks.resize(frames);
 	
@@ -224,5 +225,9 @@ void ImageSet::Upload(Sprite *sprite)
 	// Load the frames. This will clear the buffers and the mask vector.
 	sprite->AddFrames(buffer[0], false);
 	sprite->AddFrames(buffer[1], true);
-	sprite->AddMasks(masks);
+	if(!masks.empty())
+	{
+		sprite->AddMasks(masks);
+		hasMasks = true;
+	}
 }
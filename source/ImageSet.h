@@ -75,6 +75,8 @@ private:
 	// Data loaded from the images:
 	ImageBuffer buffer[2];
 	std::vector<Mask> masks;
+	// Whether the masks have already been given to the sprite.
+	bool hasMasks = false;
 };
 
 
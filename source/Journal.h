@@ -0,0 +1,114 @@
+/* Journal.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include "Set.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+// Template that keeps track of changes to the objects in a Set, so that the set
+// can be returned to the state it was in when a snapshot was taken. Rather than
+// copying the whole set, this only saves a copy of each object the first time
+// it is modified, so reverting takes time proportional to the number of objects
+// that were changed. Any code that modifies an object must go through Modify().
+template<class Type>
+class Journal {
+public:
+	explicit Journal(Set<Type> &set) : set(set) {}
+	
+	// Remember which objects are in the set now, and forget any changes that
+	// have already been recorded. Revert() will return the set to this state.
+	void Snapshot();
+	// Get the named object in order to modify it, creating it if necessary.
+	Type *Modify(const std::string &name);
+	
+	// Undo all the changes since the snapshot, and remove any objects that were
+	// created since then. This returns the objects that were restored.
+	std::vector<Type *> Revert();
+	
+	// Get the number of objects that have been modified since the snapshot.
+	size_t Size() const { return original.size(); }
+	
+	
+private:
+	Set<Type> &set;
+	// Whether the object with each handle existed when the snapshot was taken.
+	// Any handles given out since then are for objects that did not.
+	std::vector<bool> existed;
+	int existedCount = 0;
+	// The state of each modified object before its first modification, by
+	// the object's handle.
+	std::map<int, Type> original;
+};
+
+
+
+template <class Type>
+void Journal<Type>::Snapshot()
+{
+	existed.assign(set.Handles(), false);
+	for(int handle = 0; handle < set.Handles(); ++handle)
+		existed[handle] = (set.FromHandle(handle) != nullptr);
+	existedCount = set.size();
+	
+	original.clear();
+}
+
+
+
+template <class Type>
+Type *Journal<Type>::Modify(const std::string &name)
+{
+	int handle = set.Handle(name);
+	Type *object = set.FromHandle(handle);
+	// Objects that were created after the snapshot will just be removed when
+	// reverting, so there is no need to save a copy of them.
+	if(handle < static_cast<int>(existed.size()) && existed[handle] && !original.count(handle))
+		original.emplace(handle, *object);
+	return object;
+}
+
+
+
+template <class Type>
+std::vector<Type *> Journal<Type>::Revert()
+{
+	std::vector<Type *> restored;
+	restored.reserve(original.size());
+	for(auto &it : original)
+	{
+		Type *object = set.FromHandle(it.first);
+		*object = std::move(it.second);
+		restored.push_back(object);
+	}
+	original.clear();
+	
+	// Objects are never removed except here, so if the set is the same size as
+	// it was, nothing can have been added to it.
+	if(set.size() != existedCount)
+		for(int handle = 0; handle < set.Handles(); ++handle)
+			if(set.FromHandle(handle) && (handle >= static_cast<int>(existed.size()) || !existed[handle]))
+				set.Erase(handle);
+	
+	return restored;
+}
+
+
+
+#endif
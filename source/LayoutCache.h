@@ -0,0 +1,158 @@
+/* LayoutCache.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef LAYOUT_CACHE_H_
+#define LAYOUT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+
+
+// Hash the given text, combined with a seed that can be used to distinguish
+// different layout parameters. This is the 64-bit FNV-1a hash.
+inline uint64_t LayoutHash(const char *text, size_t length, uint64_t seed = 0)
+{
+	uint64_t hash = 14695981039346656037ull ^ seed;
+	for(size_t i = 0; i < length; ++i)
+		hash = (hash ^ static_cast<unsigned char>(text[i])) * 1099511628211ull;
+	return hash;
+}
+
+
+
+// Counters describing how well a LayoutCache is performing, so that its
+// capacity can be tuned.
+class CacheStats {
+public:
+	double HitRate() const { return (hits + misses) ? static_cast<double>(hits) / (hits + misses) : 0.; }
+	
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	size_t size = 0;
+	size_t capacity = 0;
+};
+
+
+
+// A small least-recently-used cache for the results of text layout. Most text
+// that is drawn in one frame was also drawn in the previous frame, so caching
+// the widths and word positions avoids measuring the same strings over and
+// over again. The key type must be hashable with the given hash function.
+// Usually the key is just a hash of the text and layout parameters, and the
+// cached value holds a copy of the text so that collisions can be ruled out.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class LayoutCache {
+public:
+	explicit LayoutCache(size_t capacity) : capacity(capacity) {}
+	
+	// Get the cached value for the given key, or null if it is not cached.
+	// This marks the value as the most recently used one.
+	const Value *Get(const Key &key);
+	// Store a value, evicting the least recently used one if the cache is full.
+	const Value &Set(const Key &key, Value value);
+	
+	void Clear();
+	CacheStats Stats() const;
+	
+	
+private:
+	typedef std::list<std::pair<Key, Value>> List;
+	
+	// Entries are kept in order of use, with the most recent at the front.
+	List entries;
+	std::unordered_map<Key, typename List::iterator, Hash> index;
+	size_t capacity;
+	
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+};
+
+
+
+template <class Key, class Value, class Hash>
+const Value *LayoutCache<Key, Value, Hash>::Get(const Key &key)
+{
+	auto it = index.find(key);
+	if(it == index.end())
+	{
+		++misses;
+		return nullptr;
+	}
+	
+	++hits;
+	entries.splice(entries.begin(), entries, it->second);
+	return &it->second->second;
+}
+
+
+
+template <class Key, class Value, class Hash>
+const Value &LayoutCache<Key, Value, Hash>::Set(const Key &key, Value value)
+{
+	auto it = index.find(key);
+	if(it != index.end())
+	{
+		it->second->second = std::move(value);
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->second;
+	}
+	
+	if(capacity && index.size() >= capacity)
+	{
+		// Reuse the least recently used entry's list node.
+		++evictions;
+		index.erase(entries.back().first);
+		entries.splice(entries.begin(), entries, std::prev(entries.end()));
+		entries.front().first = key;
+		entries.front().second = std::move(value);
+	}
+	else
+		entries.emplace_front(key, std::move(value));
+	
+	index[key] = entries.begin();
+	return entries.front().second;
+}
+
+
+
+template <class Key, class Value, class Hash>
+void LayoutCache<Key, Value, Hash>::Clear()
+{
+	entries.clear();
+	index.clear();
+}
+
+
+
+template <class Key, class Value, class Hash>
+CacheStats LayoutCache<Key, Value, Hash>::Stats() const
+{
+	CacheStats stats;
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.evictions = evictions;
+	stats.size = index.size();
+	stats.capacity = capacity;
+	return stats;
+}
+
+
+
+#endif
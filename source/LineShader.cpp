@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "LineShader.h"
 
 #include "Color.h"
+#include "Font.h"
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
@@ -102,6 +103,7 @@ void LineShader::Draw(const Point &from, const Point &to, float width, const Col
 	if(!shader.Object())
 		throw runtime_error("LineShader: Draw() called before Init().");
 	
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
@@ -17,6 +17,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Font.h"
 #include "FontSet.h"
 #include "Format.h"
+#include "FrameQueue.h"
 #include "FrameTimer.h"
 #include "GameData.h"
 #include "Government.h"
@@ -176,6 +177,36 @@ void MainPanel::Draw()
 			loadCount = 0;
 		}
 	}
+	
+	if(Preferences::Has("Show frame latency"))
+	{
+		// Show how long it takes from reading the input to the GPU finishing
+		// a frame, and how much of that time is spent in each stage.
+		static const vector<pair<FrameQueue::Stage, string>> STAGES = {
+			{FrameQueue::STEP, "step: "},
+			{FrameQueue::CALCULATE, "queued: "},
+			{FrameQueue::CALCULATED, "calculate: "},
+			{FrameQueue::DRAW, "wait: "},
+			{FrameQueue::SUBMIT, "draw: "},
+			{FrameQueue::COMPLETE, "GPU: "}
+		};
+		const Font &font = FontSet::Get(14);
+		const Color &color = *GameData::Colors().Get("medium");
+		Point point(10., Screen::Height() * -.5 + 25.);
+		
+		string latency = "latency: " + Format::Decimal(1000. * FrameQueue::Latency(), 1)
+			+ " ms (max " + Format::Decimal(1000. * FrameQueue::MaxLatency(), 1) + ")";
+		font.Draw(latency, point, color);
+		for(const auto &it : STAGES)
+		{
+			point.Y() += 20.;
+			font.Draw(it.second + Format::Decimal(1000. * FrameQueue::StageTime(it.first), 1) + " ms", point, color);
+		}
+		point.Y() += 20.;
+		font.Draw("frames awaiting GPU: " + to_string(FrameQueue::InFlight()), point, color);
+	}
+	
+	engine.AddFrame(loadTimer.Time());
 }
 
 
@@ -13,11 +13,16 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 
 #include "ImageBuffer.h"
+#include "pi.h"
 
 #include <algorithm>
 #include <cmath>
 #include <limits>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace {
@@ -206,6 +211,487 @@ namespace {
 			radius = max(radius, p.LengthSquared());
 		return sqrt(radius);
 	}
+	
+	
+	// The number of consecutive edges covered by each of the bounding boxes
+	// that queries use to skip over parts of large outlines. This must be a
+	// multiple of four. Outlines with fewer points than MIN_INDEXED are quicker
+	// to just check in their entirety.
+	const size_t CHUNK = 16;
+	const size_t MIN_INDEXED = 192;
+	
+	// The number of ranges of facings that each get their own bounding box in
+	// a mask's facing cache. This must be a power of two.
+	const int FACINGS = 256;
+	const double FACING_DEGREES = 360. / FACINGS;
+	
+	// The outline is also stored as separate arrays of edge start coordinates
+	// and edge deltas, so that several edges can be tested at once. Each array
+	// is padded to a multiple of four with copies of the first point and edges
+	// of zero length, which never count as an intersection. The padding always
+	// includes at least one extra point, so the start of the next edge can be
+	// read for every real edge.
+	size_t PaddedSize(size_t count)
+	{
+		return (count + 4) & ~static_cast<size_t>(3);
+	}
+	
+	
+	void MakeEdges(const vector<Point> &outline, vector<double> *edges)
+	{
+		edges->clear();
+		if(outline.empty())
+			return;
+		
+		size_t size = PaddedSize(outline.size());
+		edges->resize(4 * size, 0.);
+		double *x = edges->data();
+		double *y = x + size;
+		double *dx = y + size;
+		double *dy = dx + size;
+		for(size_t i = 0; i < size; ++i)
+		{
+			const Point &start = outline[i < outline.size() ? i : 0];
+			x[i] = start.X();
+			y[i] = start.Y();
+			if(i < outline.size())
+			{
+				Point delta = outline[(i + 1) % outline.size()] - start;
+				dx[i] = delta.X();
+				dy[i] = delta.Y();
+			}
+		}
+	}
+	
+	
+	// Find the bounding box of each run of CHUNK consecutive edges, so that
+	// queries can skip over any part of the outline that is nowhere near them.
+	void MakeBounds(const vector<Point> &outline, const vector<double> &edges, vector<double> *bounds)
+	{
+		bounds->clear();
+		if(outline.size() < MIN_INDEXED)
+			return;
+		
+		size_t size = edges.size() / 4;
+		const double *x = edges.data();
+		const double *y = x + size;
+		for(size_t begin = 0; begin < size; begin += CHUNK)
+		{
+			// Each edge runs from its own point to the next one. The padding at
+			// the end is all copies of the first point, which is where the last
+			// edge ends, so it does not need to be skipped.
+			size_t end = min(begin + CHUNK, size);
+			double left = x[begin];
+			double top = y[begin];
+			double right = left;
+			double bottom = top;
+			for(size_t i = begin; i <= end && i <= outline.size(); ++i)
+			{
+				left = min(left, x[i]);
+				top = min(top, y[i]);
+				right = max(right, x[i]);
+				bottom = max(bottom, y[i]);
+			}
+			bounds->push_back(left);
+			bounds->push_back(top);
+			bounds->push_back(right);
+			bounds->push_back(bottom);
+		}
+	}
+	
+	
+	// Run the given query on each run of consecutive edges whose bounding boxes
+	// pass the given test, stopping if the query returns false. Neighboring
+	// chunks are combined into one run, so that the query's own loop does as
+	// much of the work as possible.
+	template <class Test, class Query>
+	void ForEachRun(const vector<double> &bounds, size_t size, Test test, Query query)
+	{
+		size_t begin = 0;
+		size_t end = 0;
+		for(size_t i = 0; i < bounds.size(); i += 4)
+		{
+			if(!test(&bounds[i]))
+				continue;
+			
+			size_t chunk = i / 4 * CHUNK;
+			if(chunk != end)
+			{
+				if(begin != end && !query(begin, end))
+					return;
+				begin = chunk;
+			}
+			end = min(chunk + CHUNK, size);
+		}
+		if(begin != end)
+			query(begin, end);
+	}
+	
+	
+	// Get the squared distance from a point to the given bounding box.
+	double DistanceSquared(const double *box, Point point)
+	{
+		double dx = max(0., max(box[0] - point.X(), point.X() - box[2]));
+		double dy = max(0., max(box[1] - point.Y(), point.Y() - box[3]));
+		return dx * dx + dy * dy;
+	}
+	
+	
+	// The mask queries, for a range of the edges. There are versions that test
+	// two or four edges at once, but each of them does exactly the same
+	// arithmetic as the scalar version, so the results are identical no matter
+	// which one is used. A query for a range of the edges that starts and ends
+	// on a multiple of four is safe for any of them.
+	class Kernels {
+	public:
+		double (*intersection)(const double *edges, size_t size, size_t begin, size_t end, Point sA, Point vA);
+		bool (*contains)(const double *edges, size_t size, size_t begin, size_t end, Point point);
+		bool (*withinRange)(const double *edges, size_t size, size_t begin, size_t end, Point point, double range);
+		double (*rangeSquared)(const double *edges, size_t size, size_t begin, size_t end, Point point);
+	};
+	
+	
+	double IntersectionScalar(const double *edges, size_t size, size_t begin, size_t end, Point sA, Point vA)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		// Keep track of the closest intersection point found.
+		double closest = 1.;
+		for(size_t i = begin; i < end; ++i)
+		{
+			// Check if there is an intersection. (If not, the cross would be 0.) If
+			// there is, handle it only if it is a point where the segment is
+			// entering the polygon rather than exiting it (i.e. cross > 0).
+			Point vB(dx[i], dy[i]);
+			double cross = vB.Cross(vA);
+			if(cross > 0.)
+			{
+				Point vS = Point(x[i], y[i]) - sA;
+				double uB = vA.Cross(vS);
+				double uA = vB.Cross(vS);
+				// If the intersection occurs somewhere within this segment of the
+				// outline, find out how far along the query vector it occurs and
+				// remember it if it is the closest so far.
+				if((uB >= 0.) & (uB < cross) & (uA >= 0.))
+					closest = min(closest, uA / cross);
+			}
+		}
+		return closest;
+	}
+	
+	
+	// Check whether an odd number of these edges are below the given point.
+	bool ContainsScalar(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		// If this point is contained within the mask, a ray drawn out from it will
+		// intersect the mask an even number of times. If that ray coincides with an
+		// edge, ignore that edge, and count all segments as closed at the start and
+		// open at the end to avoid double-counting.
+		
+		// For simplicity, use a ray pointing straight downwards. A segment then
+		// intersects only if its x coordinates span the point's coordinates.
+		int intersections = 0;
+		for(size_t i = begin; i < end; ++i)
+			if(dx[i] != 0. && (x[i] <= point.X()) == (point.X() < x[i + 1]))
+			{
+				double intersection = y[i] + dy[i] * (point.X() - x[i]) / dx[i];
+				intersections += (intersection >= point.Y());
+			}
+		return (intersections & 1);
+	}
+	
+	
+	bool WithinRangeScalar(const double *edges, size_t size, size_t begin, size_t end, Point point, double range)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		for(size_t i = begin; i < end; ++i)
+			if(Point(x[i], y[i]).DistanceSquared(point) < range)
+				return true;
+		return false;
+	}
+	
+	
+	double RangeSquaredScalar(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		double range = numeric_limits<double>::infinity();
+		for(size_t i = begin; i < end; ++i)
+			range = min(range, Point(x[i], y[i]).DistanceSquared(point));
+		return range;
+	}
+	
+	
+	const Kernels SCALAR_KERNELS = {IntersectionScalar, ContainsScalar, WithinRangeScalar, RangeSquaredScalar};
+	
+	
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__attribute__((target("sse2")))
+	double IntersectionSSE2(const double *edges, size_t size, size_t begin, size_t end, Point sA, Point vA)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		__m128d ax = _mm_set1_pd(sA.X());
+		__m128d ay = _mm_set1_pd(sA.Y());
+		__m128d vx = _mm_set1_pd(vA.X());
+		__m128d vy = _mm_set1_pd(vA.Y());
+		__m128d zero = _mm_setzero_pd();
+		__m128d closest = _mm_set1_pd(1.);
+		for(size_t i = begin; i < end; i += 2)
+		{
+			__m128d bx = _mm_loadu_pd(dx + i);
+			__m128d by = _mm_loadu_pd(dy + i);
+			__m128d sx = _mm_sub_pd(_mm_loadu_pd(x + i), ax);
+			__m128d sy = _mm_sub_pd(_mm_loadu_pd(y + i), ay);
+			__m128d cross = _mm_sub_pd(_mm_mul_pd(bx, vy), _mm_mul_pd(by, vx));
+			__m128d uB = _mm_sub_pd(_mm_mul_pd(vx, sy), _mm_mul_pd(vy, sx));
+			__m128d uA = _mm_sub_pd(_mm_mul_pd(bx, sy), _mm_mul_pd(by, sx));
+			__m128d hit = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(cross, zero), _mm_cmpge_pd(uB, zero)),
+				_mm_and_pd(_mm_cmplt_pd(uB, cross), _mm_cmpge_pd(uA, zero)));
+			__m128d u = _mm_or_pd(_mm_and_pd(hit, _mm_div_pd(uA, cross)), _mm_andnot_pd(hit, closest));
+			closest = _mm_min_pd(closest, u);
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, closest);
+		return min(lanes[0], lanes[1]);
+	}
+	
+	
+	__attribute__((target("sse2")))
+	bool ContainsSSE2(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		__m128d px = _mm_set1_pd(point.X());
+		__m128d py = _mm_set1_pd(point.Y());
+		__m128d zero = _mm_setzero_pd();
+		int intersections = 0;
+		for(size_t i = begin; i < end; i += 2)
+		{
+			__m128d startX = _mm_loadu_pd(x + i);
+			__m128d endX = _mm_loadu_pd(x + i + 1);
+			__m128d bx = _mm_loadu_pd(dx + i);
+			__m128d spans = _mm_andnot_pd(_mm_xor_pd(_mm_cmple_pd(startX, px), _mm_cmplt_pd(px, endX)),
+				_mm_cmpneq_pd(bx, zero));
+			__m128d t = _mm_div_pd(_mm_mul_pd(_mm_loadu_pd(dy + i), _mm_sub_pd(px, startX)), bx);
+			__m128d above = _mm_cmpge_pd(_mm_add_pd(_mm_loadu_pd(y + i), t), py);
+			intersections += __builtin_popcount(_mm_movemask_pd(_mm_and_pd(spans, above)));
+		}
+		return (intersections & 1);
+	}
+	
+	
+	__attribute__((target("sse2")))
+	bool WithinRangeSSE2(const double *edges, size_t size, size_t begin, size_t end, Point point, double range)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		__m128d px = _mm_set1_pd(point.X());
+		__m128d py = _mm_set1_pd(point.Y());
+		__m128d r = _mm_set1_pd(range);
+		for(size_t i = begin; i < end; i += 2)
+		{
+			__m128d ex = _mm_sub_pd(_mm_loadu_pd(x + i), px);
+			__m128d ey = _mm_sub_pd(_mm_loadu_pd(y + i), py);
+			__m128d d = _mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey));
+			if(_mm_movemask_pd(_mm_cmplt_pd(d, r)))
+				return true;
+		}
+		return false;
+	}
+	
+	
+	__attribute__((target("sse2")))
+	double RangeSquaredSSE2(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		__m128d px = _mm_set1_pd(point.X());
+		__m128d py = _mm_set1_pd(point.Y());
+		__m128d closest = _mm_set1_pd(numeric_limits<double>::infinity());
+		for(size_t i = begin; i < end; i += 2)
+		{
+			__m128d ex = _mm_sub_pd(_mm_loadu_pd(x + i), px);
+			__m128d ey = _mm_sub_pd(_mm_loadu_pd(y + i), py);
+			closest = _mm_min_pd(closest, _mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey)));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, closest);
+		return min(lanes[0], lanes[1]);
+	}
+	
+	
+	__attribute__((target("avx")))
+	double IntersectionAVX(const double *edges, size_t size, size_t begin, size_t end, Point sA, Point vA)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		__m256d ax = _mm256_set1_pd(sA.X());
+		__m256d ay = _mm256_set1_pd(sA.Y());
+		__m256d vx = _mm256_set1_pd(vA.X());
+		__m256d vy = _mm256_set1_pd(vA.Y());
+		__m256d zero = _mm256_setzero_pd();
+		__m256d closest = _mm256_set1_pd(1.);
+		for(size_t i = begin; i < end; i += 4)
+		{
+			__m256d bx = _mm256_loadu_pd(dx + i);
+			__m256d by = _mm256_loadu_pd(dy + i);
+			__m256d sx = _mm256_sub_pd(_mm256_loadu_pd(x + i), ax);
+			__m256d sy = _mm256_sub_pd(_mm256_loadu_pd(y + i), ay);
+			__m256d cross = _mm256_sub_pd(_mm256_mul_pd(bx, vy), _mm256_mul_pd(by, vx));
+			__m256d uB = _mm256_sub_pd(_mm256_mul_pd(vx, sy), _mm256_mul_pd(vy, sx));
+			__m256d uA = _mm256_sub_pd(_mm256_mul_pd(bx, sy), _mm256_mul_pd(by, sx));
+			__m256d hit = _mm256_and_pd(
+				_mm256_and_pd(_mm256_cmp_pd(cross, zero, _CMP_GT_OQ), _mm256_cmp_pd(uB, zero, _CMP_GE_OQ)),
+				_mm256_and_pd(_mm256_cmp_pd(uB, cross, _CMP_LT_OQ), _mm256_cmp_pd(uA, zero, _CMP_GE_OQ)));
+			closest = _mm256_min_pd(closest, _mm256_blendv_pd(closest, _mm256_div_pd(uA, cross), hit));
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, closest);
+		return min(min(lanes[0], lanes[1]), min(lanes[2], lanes[3]));
+	}
+	
+	
+	__attribute__((target("avx")))
+	bool ContainsAVX(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		const double *dx = y + size;
+		const double *dy = dx + size;
+		__m256d px = _mm256_set1_pd(point.X());
+		__m256d py = _mm256_set1_pd(point.Y());
+		__m256d zero = _mm256_setzero_pd();
+		int intersections = 0;
+		for(size_t i = begin; i < end; i += 4)
+		{
+			__m256d startX = _mm256_loadu_pd(x + i);
+			__m256d endX = _mm256_loadu_pd(x + i + 1);
+			__m256d bx = _mm256_loadu_pd(dx + i);
+			__m256d spans = _mm256_andnot_pd(
+				_mm256_xor_pd(_mm256_cmp_pd(startX, px, _CMP_LE_OQ), _mm256_cmp_pd(px, endX, _CMP_LT_OQ)),
+				_mm256_cmp_pd(bx, zero, _CMP_NEQ_OQ));
+			__m256d t = _mm256_div_pd(_mm256_mul_pd(_mm256_loadu_pd(dy + i), _mm256_sub_pd(px, startX)), bx);
+			__m256d above = _mm256_cmp_pd(_mm256_add_pd(_mm256_loadu_pd(y + i), t), py, _CMP_GE_OQ);
+			intersections += __builtin_popcount(_mm256_movemask_pd(_mm256_and_pd(spans, above)));
+		}
+		return (intersections & 1);
+	}
+	
+	
+	__attribute__((target("avx")))
+	bool WithinRangeAVX(const double *edges, size_t size, size_t begin, size_t end, Point point, double range)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		__m256d px = _mm256_set1_pd(point.X());
+		__m256d py = _mm256_set1_pd(point.Y());
+		__m256d r = _mm256_set1_pd(range);
+		for(size_t i = begin; i < end; i += 4)
+		{
+			__m256d ex = _mm256_sub_pd(_mm256_loadu_pd(x + i), px);
+			__m256d ey = _mm256_sub_pd(_mm256_loadu_pd(y + i), py);
+			__m256d d = _mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey));
+			if(_mm256_movemask_pd(_mm256_cmp_pd(d, r, _CMP_LT_OQ)))
+				return true;
+		}
+		return false;
+	}
+	
+	
+	__attribute__((target("avx")))
+	double RangeSquaredAVX(const double *edges, size_t size, size_t begin, size_t end, Point point)
+	{
+		const double *x = edges;
+		const double *y = x + size;
+		__m256d px = _mm256_set1_pd(point.X());
+		__m256d py = _mm256_set1_pd(point.Y());
+		__m256d closest = _mm256_set1_pd(numeric_limits<double>::infinity());
+		for(size_t i = begin; i < end; i += 4)
+		{
+			__m256d ex = _mm256_sub_pd(_mm256_loadu_pd(x + i), px);
+			__m256d ey = _mm256_sub_pd(_mm256_loadu_pd(y + i), py);
+			closest = _mm256_min_pd(closest, _mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey)));
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, closest);
+		return min(min(lanes[0], lanes[1]), min(lanes[2], lanes[3]));
+	}
+	
+	
+	const Kernels SSE2_KERNELS = {IntersectionSSE2, ContainsSSE2, WithinRangeSSE2, RangeSquaredSSE2};
+	const Kernels AVX_KERNELS = {IntersectionAVX, ContainsAVX, WithinRangeAVX, RangeSquaredAVX};
+	
+	
+	// Get the kernels for the given instructions, or null if this processor
+	// does not support them.
+	const Kernels *GetKernels(Mask::Instructions instructions)
+	{
+		__builtin_cpu_init();
+		if(instructions == Mask::AVX)
+			return __builtin_cpu_supports("avx") ? &AVX_KERNELS : nullptr;
+		if(instructions == Mask::SSE2)
+			return __builtin_cpu_supports("sse2") ? &SSE2_KERNELS : nullptr;
+		return &SCALAR_KERNELS;
+	}
+#else
+	// On other processors, only the scalar versions are available.
+	const Kernels *GetKernels(Mask::Instructions instructions)
+	{
+		return (instructions == Mask::SCALAR) ? &SCALAR_KERNELS : nullptr;
+	}
+#endif
+	
+	// The kernels that are in use. By default, these are the widest ones that
+	// this processor supports.
+	const Kernels *&Selected()
+	{
+		static const Kernels *kernels = []() {
+			const Kernels *widest = GetKernels(Mask::AVX);
+			if(!widest)
+				widest = GetKernels(Mask::SSE2);
+			return widest ? widest : GetKernels(Mask::SCALAR);
+		}();
+		return kernels;
+	}
+	
+	const Kernels &Active()
+	{
+		return *Selected();
+	}
+}
+
+
+
+// Check whether this processor supports the given instructions.
+bool Mask::Supports(Instructions instructions)
+{
+	return GetKernels(instructions);
+}
+
+
+
+// Use the given instructions for all mask queries, if this processor supports
+// them. This is only meant for testing that they all give the same results.
+bool Mask::UseInstructions(Instructions instructions)
+{
+	const Kernels *kernels = GetKernels(instructions);
+	if(kernels)
+		Selected() = kernels;
+	return kernels;
 }
 
 
@@ -230,6 +716,8 @@ void Mask::Create(const ImageBuffer &image, int frame)
 	Simplify(raw, &outline);
 	
 	radius = ComputeRadius(outline);
+	MakeEdges(outline, &edges);
+	MakeBounds(outline, edges, &bounds);
 }
 
 
@@ -254,6 +742,17 @@ double Mask::Collide(Point sA, Point vA, Angle facing) const
 	if(outline.empty() || distance > radius + vA.Length())
 		return 1.;
 	
+	// If the segment's bounding box does not touch the outline's, it cannot
+	// possibly intersect it.
+	const double *box = FacingBounds(facing);
+	if(box)
+	{
+		Point end = sA + vA;
+		if(max(sA.X(), end.X()) < box[0] || min(sA.X(), end.X()) > box[2]
+				|| max(sA.Y(), end.Y()) < box[1] || min(sA.Y(), end.Y()) > box[3])
+			return 1.;
+	}
+	
 	// Rotate into the mask's frame of reference.
 	sA = (-facing).Rotate(sA);
 	vA = (-facing).Rotate(vA);
@@ -279,6 +778,10 @@ bool Mask::Contains(Point point, Angle facing) const
 	if(outline.empty() || point.Length() > radius)
 		return false;
 	
+	const double *box = FacingBounds(facing);
+	if(box && (point.X() < box[0] || point.X() > box[2] || point.Y() < box[1] || point.Y() > box[3]))
+		return false;
+	
 	// Rotate into the mask's frame of reference.
 	return Contains((-facing).Rotate(point));
 }
@@ -293,16 +796,25 @@ bool Mask::WithinRange(Point point, Angle facing, double range) const
 	if(outline.empty() || range < point.Length() - radius)
 		return false;
 	
+	const double *box = FacingBounds(facing);
+	if(box && DistanceSquared(box, point) >= range * range)
+		return false;
+	
 	// Rotate into the mask's frame of reference.
 	point = (-facing).Rotate(point);
 	// For efficiency, compare to range^2 instead of range.
 	range *= range;
 	
-	for(const Point &p : outline)
-		if(p.DistanceSquared(point) < range)
-			return true;
+	const Kernels &kernels = Active();
+	size_t size = edges.size() / 4;
+	if(bounds.empty())
+		return kernels.withinRange(edges.data(), size, 0, size, point, range);
 	
-	return false;
+	bool isWithin = false;
+	ForEachRun(bounds, size,
+		[&](const double *box) { return DistanceSquared(box, point) < range; },
+		[&](size_t begin, size_t end) { isWithin = kernels.withinRange(edges.data(), size, begin, end, point, range); return !isWithin; });
+	return isWithin;
 }
 
 
@@ -319,10 +831,23 @@ double Mask::Range(Point point, Angle facing) const
 	if(Contains(point))
 		return 0.;
 	
-	for(const Point &p : outline)
-		range = min(range, p.Distance(point));
+	const Kernels &kernels = Active();
+	size_t size = edges.size() / 4;
+	if(bounds.empty())
+		return sqrt(kernels.rangeSquared(edges.data(), size, 0, size, point));
 	
-	return range;
+	// Start out with the distance to the closest of the points where each run
+	// of edges begins, and then skip any run that is farther away than the
+	// closest point found so far.
+	const double *x = edges.data();
+	const double *y = x + size;
+	for(size_t begin = 0; begin < size; begin += CHUNK)
+		range = min(range, Point(x[begin], y[begin]).DistanceSquared(point));
+	ForEachRun(bounds, size,
+		[&](const double *box) { return DistanceSquared(box, point) < range; },
+		[&](size_t begin, size_t end) { range = min(range, kernels.rangeSquared(edges.data(), size, begin, end, point)); return true; });
+	
+	return sqrt(range);
 }
 
 
@@ -342,60 +867,103 @@ const vector<Point> &Mask::Points() const
 
 
 
-double Mask::Intersection(Point sA, Point vA) const
+// Store a bounding box of the rotated outline for each range of facings, so
+// that queries nowhere near it can be rejected without rotating them into the
+// mask's frame of reference.
+void Mask::CacheFacings() const
 {
-	// Keep track of the closest intersection point found.
-	double closest = 1.;
+	if(outline.empty() || !facingBounds.empty())
+		return;
 	
-	Point prev = outline.back();
-	for(const Point &next : outline)
+	// Rotating a point by up to half the width of a range of facings moves it
+	// by less than its distance from the center times that angle, in radians.
+	// Pad each box by the full width, which is more than enough to also cover
+	// any rounding in where the facing falls and in the rotation itself.
+	double pad = radius * FACING_DEGREES * PI / 180.;
+	facingBounds.reserve(4 * FACINGS);
+	for(int i = 0; i < FACINGS; ++i)
 	{
-		// Check if there is an intersection. (If not, the cross would be 0.) If
-		// there is, handle it only if it is a point where the segment is
-		// entering the polygon rather than exiting it (i.e. cross > 0).
-		Point vB = next - prev;
-		double cross = vB.Cross(vA);
-		if(cross > 0.)
+		Angle center(-180. + (i + .5) * FACING_DEGREES);
+		double left = numeric_limits<double>::infinity();
+		double top = left;
+		double right = -left;
+		double bottom = -left;
+		for(const Point &point : outline)
 		{
-			Point vS = prev - sA;
-			double uB = vA.Cross(vS);
-			double uA = vB.Cross(vS);
-			// If the intersection occurs somewhere within this segment of the
-			// outline, find out how far along the query vector it occurs and
-			// remember it if it is the closest so far.
-			if((uB >= 0.) & (uB < cross) & (uA >= 0.))
-				closest = min(closest, uA / cross);
+			Point rotated = center.Rotate(point);
+			left = min(left, rotated.X());
+			top = min(top, rotated.Y());
+			right = max(right, rotated.X());
+			bottom = max(bottom, rotated.Y());
 		}
-		
-		prev = next;
+		facingBounds.push_back(left - pad);
+		facingBounds.push_back(top - pad);
+		facingBounds.push_back(right + pad);
+		facingBounds.push_back(bottom + pad);
 	}
+}
+
+
+
+// Get how much memory the facing cache takes up, if it exists.
+size_t Mask::CacheBytes() const
+{
+	return facingBounds.size() * sizeof(double);
+}
+
+
+
+double Mask::Intersection(Point sA, Point vA) const
+{
+	const Kernels &kernels = Active();
+	size_t size = edges.size() / 4;
+	if(bounds.empty())
+		return kernels.intersection(edges.data(), size, 0, size, sA, vA);
+	
+	// Only the edges whose bounding boxes overlap the segment's can intersect
+	// it. Pad the segment's box slightly, in case rounding puts an intersection
+	// just outside of it.
+	Point end = sA + vA;
+	double margin = 1e-9 * (radius + vA.Length());
+	double left = min(sA.X(), end.X()) - margin;
+	double top = min(sA.Y(), end.Y()) - margin;
+	double right = max(sA.X(), end.X()) + margin;
+	double bottom = max(sA.Y(), end.Y()) + margin;
+	
+	double closest = 1.;
+	ForEachRun(bounds, size,
+		[&](const double *box) { return box[0] <= right && box[2] >= left && box[1] <= bottom && box[3] >= top; },
+		[&](size_t begin, size_t end) { closest = min(closest, kernels.intersection(edges.data(), size, begin, end, sA, vA)); return true; });
 	return closest;
 }
 
 
 
+// Get the cached bounding box for the given facing, or null if there is none.
+const double *Mask::FacingBounds(Angle facing) const
+{
+	if(facingBounds.empty())
+		return nullptr;
+	
+	int i = static_cast<int>((facing.Degrees() + 180.) / FACING_DEGREES) & (FACINGS - 1);
+	return &facingBounds[4 * i];
+}
+
+
+
 bool Mask::Contains(Point point) const
 {
-	// If this point is contained within the mask, a ray drawn out from it will
-	// intersect the mask an even number of times. If that ray coincides with an
-	// edge, ignore that edge, and count all segments as closed at the start and
-	// open at the end to avoid double-counting.
+	const Kernels &kernels = Active();
+	size_t size = edges.size() / 4;
+	if(bounds.empty())
+		return kernels.contains(edges.data(), size, 0, size, point);
 	
-	// For simplicity, use a ray pointing straight downwards. A segment then
-	// intersects only if its x coordinates span the point's coordinates.
-	int intersections = 0;
-	Point prev = outline.back();
-	for(const Point &next : outline)
-	{
-		if(prev.X() != next.X())
-			if((prev.X() <= point.X()) == (point.X() < next.X()))
-			{
-				double y = prev.Y() + (next.Y() - prev.Y()) *
-					(point.X() - prev.X()) / (next.X() - prev.X());
-				intersections += (y >= point.Y());
-			}
-		prev = next;
-	}
-	// If the number of intersections is odd, the point is within the mask.
-	return (intersections & 1);
+	// An edge can only be below the point if its x coordinates span the point's,
+	// so any run of edges entirely to one side of it can be skipped. If the
+	// number of intersections is odd, the point is within the mask.
+	bool isInside = false;
+	ForEachRun(bounds, size,
+		[&](const double *box) { return box[0] <= point.X() && point.X() <= box[2]; },
+		[&](size_t begin, size_t end) { isInside ^= kernels.contains(edges.data(), size, begin, end, point); return true; });
+	return isInside;
 }
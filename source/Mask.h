@@ -16,6 +16,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Angle.h"
 #include "Point.h"
 
+#include <cstddef>
 #include <vector>
 
 class ImageBuffer;
@@ -29,6 +30,24 @@ class ImageBuffer;
 // the image itself.
 class Mask {
 public:
+	// The sets of instructions that the queries can be done with. Each one
+	// gives exactly the same results. By default, the widest one that this
+	// processor supports is used.
+	enum Instructions {
+		SCALAR,
+		SSE2,
+		AVX
+	};
+	
+	
+public:
+	// Check whether this processor supports the given instructions.
+	static bool Supports(Instructions instructions);
+	// Use the given instructions for all mask queries, if this processor
+	// supports them. This is only meant for testing that they all give the same
+	// results, and must not be called while any other thread is using a mask.
+	static bool UseInstructions(Instructions instructions);
+	
 	// Default constructor.
 	Mask();
 	
@@ -60,14 +79,34 @@ public:
 	// Get the list of points in the outline.
 	const std::vector<Point> &Points() const;
 	
+	// Store a bounding box of the rotated outline for each range of facings, so
+	// that queries nowhere near it can be rejected without rotating them into
+	// the mask's frame of reference. This is only worth doing for the masks
+	// that are queried most often. It must not be called while another thread
+	// may be using this mask.
+	void CacheFacings() const;
+	// Get how much memory the facing cache takes up, if it exists.
+	size_t CacheBytes() const;
+	
 	
 private:
 	double Intersection(Point sA, Point vA) const;
 	bool Contains(Point point) const;
+	// Get the cached bounding box for the given facing, or null if there is none.
+	const double *FacingBounds(Angle facing) const;
 	
 	
 private:
 	std::vector<Point> outline;
+	// The same outline, as separate arrays of edge coordinates, for testing
+	// several edges at once.
+	std::vector<double> edges;
+	// The bounding box (left, top, right, bottom) of each run of edges, so that
+	// queries on large outlines can skip the parts that are far away from them.
+	std::vector<double> bounds;
+	// The bounding box (left, top, right, bottom) of the outline at each range
+	// of facings, relative to the center of the rotated mask.
+	mutable std::vector<double> facingBounds;
 	double radius;
 };
 
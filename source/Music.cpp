@@ -12,7 +12,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Music.h"
 
+#include "Allocations.h"
 #include "Files.h"
+#include "Profiler.h"
 
 #include <mad.h>
 
@@ -64,6 +66,7 @@ void Music::Init(const vector<string> &sources)
 Music::Music()
 	: silence(OUTPUT_CHUNK, 0)
 {
+	Allocations::Add(Allocations::MUSIC, 0);
 	// Don't start the thread until this object is fully constructed.
 	thread = std::thread(&Music::Decode, this);
 }
@@ -85,6 +88,7 @@ Music::~Music()
 	// our job to close it.
 	if(nextFile)
 		fclose(nextFile);
+	Allocations::Remove(Allocations::MUSIC, bufferSize);
 }
 
 
@@ -134,6 +138,11 @@ const vector<int16_t> &Music::NextChunk()
 	current.insert(current.begin(), next.begin(), next.begin() + OUTPUT_CHUNK);
 	next.erase(next.begin(), next.begin() + OUTPUT_CHUNK);
 	
+	// Keep track of how much memory the decoded audio is taking up.
+	int64_t size = INPUT_CHUNK + sizeof(int16_t) * (silence.capacity() + next.capacity() + current.capacity());
+	Allocations::Add(Allocations::MUSIC, size - bufferSize, 0);
+	bufferSize = size;
+	
 	// Once the lock is unlocked, notify the decoding thread to continue.
 	lock.unlock();
 	condition.notify_all();
@@ -150,6 +159,7 @@ void Music::Decode()
 {
 	// This vector will store the input from the file.
 	vector<unsigned char> input(INPUT_CHUNK, 0);
+	Profiler::SetThreadName("Music decoder");
 	// Objects for MP3 decoding:
 	mad_stream stream;
 	mad_frame frame;
@@ -195,6 +205,7 @@ void Music::Decode()
 			
 			// The lock can be freed until we start filling the output buffer.
 			lock.unlock();
+			Profiler::Zone zone("Music::Decode");
 			
 			// See if any input data is left undecoded in the stream. Typically
 			// this is because the last block of input contained a fraction of a
@@ -52,6 +52,8 @@ private:
 	std::vector<int16_t> silence;
 	std::vector<int16_t> next;
 	std::vector<int16_t> current;
+	// The memory used by the buffers, the last time it was measured.
+	int64_t bufferSize = 0;
 	
 	std::string previousPath;
 	// This pointer holds the file for as long as it is owned by the main
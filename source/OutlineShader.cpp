@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "OutlineShader.h"
 
 #include "Color.h"
+#include "Font.h"
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
@@ -150,6 +151,7 @@ void OutlineShader::Init()
 
 void OutlineShader::Draw(const Sprite *sprite, const Point &pos, const Point &size, const Color &color, const Point &unit, float frame)
 {
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
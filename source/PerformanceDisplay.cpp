@@ -0,0 +1,213 @@
+/* PerformanceDisplay.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "PerformanceDisplay.h"
+
+#include "Color.h"
+#include "Format.h"
+#include "GameData.h"
+#include "Point.h"
+#include "Table.h"
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+namespace {
+	// Keep five seconds' worth of steps and frames.
+	const size_t WINDOW = 300;
+	
+	const char *TIMER_NAMES[PerformanceDisplay::TIMER_COUNT] = {
+		"AI",
+		"move ships",
+		"move objects",
+		"collisions",
+		"draw lists",
+		"total step",
+		"draw",
+		"frame interval"
+	};
+	const char *COUNTER_NAMES[PerformanceDisplay::COUNTER_COUNT] = {
+		"ships",
+		"projectiles",
+		"visuals",
+		"flotsam",
+		"draw items",
+		"batch vertices",
+		"collision entries",
+		"scratch allocations",
+		"scratch overflows",
+		"scratch allocations lost",
+		"scratch bytes lost",
+		"AI scratch bytes (peak)"
+	};
+	
+	double Seconds(chrono::steady_clock::duration duration)
+	{
+		return chrono::duration_cast<chrono::duration<double>>(duration).count();
+	}
+	
+	string Megabytes(size_t bytes)
+	{
+		return Format::Decimal(bytes / 1048576., 1) + " MB";
+	}
+}
+
+
+
+// Begin a new step, clearing out the previous one.
+void PerformanceDisplay::Sample::Start()
+{
+	fill(time, time + TIMER_COUNT, 0.);
+	fill(count, count + COUNTER_COUNT, 0);
+	start = chrono::steady_clock::now();
+	last = start;
+}
+
+
+
+// Add the time since the last call to Start() or Lap() to the given timer.
+void PerformanceDisplay::Sample::Lap(Timer timer)
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	time[timer] += Seconds(now - last);
+	last = now;
+}
+
+
+
+// Record how long the whole step took.
+void PerformanceDisplay::Sample::Finish()
+{
+	time[STEP] = Seconds(chrono::steady_clock::now() - start);
+}
+
+
+
+PerformanceDisplay::PerformanceDisplay()
+	: lastFrame(chrono::steady_clock::now())
+{
+}
+
+
+
+// Add the results of one game step.
+void PerformanceDisplay::Add(const Sample &sample)
+{
+	for(int i = 0; i <= STEP; ++i)
+		windows[i].Add(sample.time[i]);
+	copy(sample.count, sample.count + COUNTER_COUNT, count);
+}
+
+
+
+// Add the time it took to draw a frame. The time since the previous frame
+// is measured here.
+void PerformanceDisplay::AddFrame(double drawTime)
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	windows[DRAW].Add(drawTime);
+	windows[FRAME].Add(Seconds(now - lastFrame));
+	lastFrame = now;
+}
+
+
+
+// Draw the statistics, with the given point as the top left corner.
+void PerformanceDisplay::Draw(const Point &topLeft) const
+{
+	const Color &bright = *GameData::Colors().Get("bright");
+	const Color &medium = *GameData::Colors().Get("medium");
+	
+	Table table;
+	table.AddColumn(0, Table::LEFT);
+	table.AddColumn(160, Table::RIGHT);
+	table.AddColumn(210, Table::RIGHT);
+	table.AddColumn(260, Table::RIGHT);
+	table.DrawAt(topLeft);
+	
+	table.SetColor(bright);
+	table.Draw("time (ms)");
+	table.Draw("p50");
+	table.Draw("p95");
+	table.Draw("p99");
+	table.SetColor(medium);
+	for(int i = 0; i < TIMER_COUNT; ++i)
+	{
+		double p50;
+		double p95;
+		double p99;
+		windows[i].Percentiles(&p50, &p95, &p99);
+		table.Draw(TIMER_NAMES[i], i == STEP || i == FRAME ? bright : medium);
+		table.Draw(Format::Decimal(p50, 2));
+		table.Draw(Format::Decimal(p95, 2));
+		table.Draw(Format::Decimal(p99, 2));
+	}
+	
+	table.Advance(4);
+	for(int i = 0; i < COUNTER_COUNT; ++i)
+	{
+		table.Draw(COUNTER_NAMES[i]);
+		table.Draw(to_string(count[i]));
+		table.Advance(2);
+	}
+	
+	const TextureResidency &textures = GameData::Textures();
+	table.Advance(4);
+	table.Draw("textures");
+	table.Draw(Megabytes(textures.Bytes()));
+	table.Advance(2);
+	if(textures.Budget())
+	{
+		table.Draw("texture budget");
+		table.Draw(Megabytes(textures.Budget()));
+		table.Advance(2);
+	}
+	table.Draw("sprites resident");
+	table.Draw(to_string(textures.Resident()));
+	table.Advance(2);
+	table.Draw("sprites evicted");
+	table.Draw(to_string(textures.Evicted()));
+	table.Advance(2);
+}
+
+
+
+void PerformanceDisplay::Window::Add(double value)
+{
+	if(values.size() < WINDOW)
+		values.push_back(value);
+	else
+		values[next] = value;
+	next = (next + 1) % WINDOW;
+}
+
+
+
+// Get the given percentiles of the values, in milliseconds.
+void PerformanceDisplay::Window::Percentiles(double *p50, double *p95, double *p99) const
+{
+	if(values.empty())
+	{
+		*p50 = *p95 = *p99 = 0.;
+		return;
+	}
+	
+	vector<double> sorted = values;
+	sort(sorted.begin(), sorted.end());
+	size_t last = sorted.size() - 1;
+	*p50 = 1000. * sorted[last * 50 / 100];
+	*p95 = 1000. * sorted[last * 95 / 100];
+	*p99 = 1000. * sorted[last * 99 / 100];
+}
@@ -0,0 +1,116 @@
+/* PerformanceDisplay.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef PERFORMANCE_DISPLAY_H_
+#define PERFORMANCE_DISPLAY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+class Point;
+
+
+
+// Class that keeps track of how long the recent game steps and frames took, and
+// how many objects the latest step involved, and draws a summary of them. Times
+// are shown as percentiles over the last few seconds rather than as averages,
+// because an average hides the occasional slow frame that shows up as a stutter.
+// This class should only be used from the main thread.
+class PerformanceDisplay {
+public:
+	// The parts of a game step that are timed separately, followed by the time
+	// the whole step took, the time spent drawing a frame, and the time from
+	// the start of one frame to the start of the next.
+	enum Timer {
+		AI_STEP,
+		MOVE_SHIPS,
+		MOVE_OBJECTS,
+		COLLISIONS,
+		FILL_DRAW_LISTS,
+		STEP,
+		DRAW,
+		FRAME,
+		TIMER_COUNT
+	};
+	enum Counter {
+		SHIPS,
+		PROJECTILES,
+		VISUALS,
+		FLOTSAM,
+		DRAW_ITEMS,
+		BATCH_VERTICES,
+		COLLISION_ENTRIES,
+		SCRATCH_ALLOCATIONS,
+		SCRATCH_OVERFLOWS,
+		SCRATCH_LOST,
+		SCRATCH_LOST_BYTES,
+		AI_SCRATCH_PEAK_BYTES,
+		COUNTER_COUNT
+	};
+	
+	// The times and counts from a single game step. The game engine fills one
+	// of these in while it calculates each step.
+	class Sample {
+	public:
+		// Begin a new step, clearing out the previous one.
+		void Start();
+		// Add the time since the last call to Start() or Lap() to the given timer.
+		void Lap(Timer timer);
+		// Record how long the whole step took.
+		void Finish();
+		
+		double time[TIMER_COUNT] = {};
+		size_t count[COUNTER_COUNT] = {};
+	
+	private:
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point last;
+	};
+	
+	
+public:
+	PerformanceDisplay();
+	
+	// Add the results of one game step.
+	void Add(const Sample &sample);
+	// Add the time it took to draw a frame. The time since the previous frame
+	// is measured here.
+	void AddFrame(double drawTime);
+	
+	// Draw the statistics, with the given point as the top left corner.
+	void Draw(const Point &topLeft) const;
+	
+	
+private:
+	// The most recent values of one timer, in seconds.
+	class Window {
+	public:
+		void Add(double value);
+		// Get the given percentiles of the values, in milliseconds.
+		void Percentiles(double *p50, double *p95, double *p99) const;
+	
+	private:
+		std::vector<double> values;
+		size_t next = 0;
+	};
+	
+	
+private:
+	Window windows[TIMER_COUNT];
+	size_t count[COUNTER_COUNT] = {};
+	std::chrono::steady_clock::time_point lastFrame;
+};
+
+
+
+#endif
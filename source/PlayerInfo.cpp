@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "PlayerInfo.h"
 
 #include "Audio.h"
+#include "ChangeCompactor.h"
 #include "ConversationPanel.h"
 #include "DataFile.h"
 #include "DataWriter.h"
@@ -54,6 +55,7 @@ void PlayerInfo::Clear()
 	*this = PlayerInfo();
 	
 	Random::Seed(time(nullptr));
+	seed = Random::Int();
 	GameData::Revert();
 	Messages::Reset();
 }
@@ -130,6 +132,8 @@ void PlayerInfo::Load(const string &path)
 		}
 		else if(child.Token(0) == "date" && child.Size() >= 4)
 			date = Date(child.Value(1), child.Value(2), child.Value(3));
+		else if(child.Token(0) == "seed" && child.Size() >= 2)
+			seed = child.Value(1);
 		else if(child.Token(0) == "system" && child.Size() >= 2)
 			system = GameData::Systems().Get(child.Token(1));
 		else if(child.Token(0) == "planet" && child.Size() >= 2)
@@ -374,12 +378,12 @@ void PlayerInfo::AddChanges(list<DataNode> &changes)
 		changedSystems |= (change.Token(0) == "system");
 		changedSystems |= (change.Token(0) == "link");
 		changedSystems |= (change.Token(0) == "unlink");
-		GameData::Change(change);
 	}
+	GameData::Change(changes);
 	if(changedSystems)
 	{
-		// Recalculate what systems have been seen.
-		GameData::UpdateNeighbors();
+		// Recalculate what systems have been seen. GameData::Change() has
+		// already updated the neighbors of any systems that were changed.
 		seen.clear();
 		for(const System *system : visitedSystems)
 		{
@@ -581,6 +585,23 @@ void PlayerInfo::IncrementDate()
 
 
 
+// Get the seed for the random numbers that the game's simulation uses.
+uint32_t PlayerInfo::Seed() const
+{
+	return seed;
+}
+
+
+
+// Replace the seed, so that a new pilot created for a test scenario also
+// plays out the same way every time.
+void PlayerInfo::SetSeed(uint32_t seed)
+{
+	this->seed = seed;
+}
+
+
+
 // Set the player's current start system, and mark that system as visited.
 void PlayerInfo::SetSystem(const System *system)
 {
@@ -2148,6 +2169,9 @@ void PlayerInfo::ApplyChanges()
 	for(const auto &it : reputationChanges)
 		it.first->SetReputation(it.second);
 	reputationChanges.clear();
+	// Fold together any saved changes to the same objects, so that they can be
+	// applied quickly. The compacted changes will be saved in their place.
+	ChangeCompactor::Compact(dataChanges);
 	AddChanges(dataChanges);
 	GameData::ReadEconomy(economy);
 	economy = DataNode();
@@ -2411,6 +2435,7 @@ void PlayerInfo::Save(const string &path) const
 	// Pilot information:
 	out.Write("pilot", firstName, lastName);
 	out.Write("date", date.Day(), date.Month(), date.Year());
+	out.Write("seed", seed);
 	if(system)
 		out.Write("system", system->Name());
 	if(planet)
@@ -21,6 +21,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "GameEvent.h"
 #include "Mission.h"
 
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
@@ -86,6 +87,12 @@ public:
 	// Get or change the current date.
 	const Date &GetDate() const;
 	void IncrementDate();
+	// Get the seed for the random numbers that the game's simulation uses, so
+	// that a saved game will always play out the same way.
+	uint32_t Seed() const;
+	// Replace the seed, so that a new pilot created for a test scenario also
+	// plays out the same way every time.
+	void SetSeed(uint32_t seed);
 	
 	// Set the system the player is in. This must be stored here so that even if
 	// the player sells all their ships, we still know where the player is.
@@ -272,6 +279,7 @@ private:
 	std::string filePath;
 	
 	Date date;
+	uint32_t seed = 0;
 	const System *system = nullptr;
 	const Planet *planet = nullptr;
 	bool shouldLaunch = false;
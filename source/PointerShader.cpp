@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "PointerShader.h"
 
 #include "Color.h"
+#include "Font.h"
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
@@ -119,6 +120,7 @@ void PointerShader::Bind()
 	if(!shader.Object())
 		throw runtime_error("PointerShader: Bind() called before Init().");
 	
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
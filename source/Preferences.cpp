@@ -27,6 +27,11 @@ using namespace std;
 namespace {
 	map<string, bool> settings;
 	int scrollSpeed = 60;
+	int frameQueueDepth = 0;
+	const int MAX_FRAME_QUEUE_DEPTH = 3;
+	int stepsAhead = 0;
+	const int MAX_STEPS_AHEAD = 2;
+	int textureBudget = 0;
 	
 	// Strings for ammo expenditure:
 	const string EXPEND_AMMO = "Escorts expend ammo";
@@ -68,6 +73,12 @@ void Preferences::Load()
 			Audio::SetVolume(node.Value(1) * VOLUME_SCALE);
 		else if(node.Token(0) == "scroll speed" && node.Size() >= 2)
 			scrollSpeed = node.Value(1);
+		else if(node.Token(0) == "frame queue depth" && node.Size() >= 2)
+			frameQueueDepth = max(0, min<int>(MAX_FRAME_QUEUE_DEPTH, node.Value(1)));
+		else if(node.Token(0) == "steps calculated ahead" && node.Size() >= 2)
+			stepsAhead = max(0, min<int>(MAX_STEPS_AHEAD, node.Value(1)));
+		else if(node.Token(0) == "texture budget" && node.Size() >= 2)
+			textureBudget = max<int>(0, node.Value(1));
 		else if(node.Token(0) == "view zoom")
 			zoomIndex = node.Value(1);
 		else
@@ -86,6 +97,9 @@ void Preferences::Save()
 	out.Write("zoom", Screen::UserZoom());
 	out.Write("scroll speed", scrollSpeed);
 	out.Write("view zoom", zoomIndex);
+	out.Write("frame queue depth", frameQueueDepth);
+	out.Write("steps calculated ahead", stepsAhead);
+	out.Write("texture budget", textureBudget);
 	
 	for(const auto &it : settings)
 		out.Write(it.first, it.second);
@@ -140,6 +154,45 @@ void Preferences::SetScrollSpeed(int speed)
 
 
 
+int Preferences::FrameQueueDepth()
+{
+	return frameQueueDepth;
+}
+
+
+
+// Cycle between letting the driver decide, and allowing one to three frames.
+void Preferences::ToggleFrameQueueDepth()
+{
+	frameQueueDepth = (frameQueueDepth + 1) % (MAX_FRAME_QUEUE_DEPTH + 1);
+}
+
+
+
+int Preferences::StepsAhead()
+{
+	return stepsAhead;
+}
+
+
+
+// Cycle between zero and two steps.
+void Preferences::ToggleStepsAhead()
+{
+	stepsAhead = (stepsAhead + 1) % (MAX_STEPS_AHEAD + 1);
+}
+
+
+
+// How many megabytes of sprite textures may be uploaded at once (zero means
+// there is no limit).
+int Preferences::TextureBudget()
+{
+	return textureBudget;
+}
+
+
+
 // View zoom.
 double Preferences::ViewZoom()
 {
@@ -34,6 +34,20 @@ public:
 	static int ScrollSpeed();
 	static void SetScrollSpeed(int speed);
 	
+	// How many frames may be waiting for the GPU at once, or zero to let the
+	// graphics driver decide.
+	static int FrameQueueDepth();
+	static void ToggleFrameQueueDepth();
+	
+	// How many steps the game engine may queue up beyond the one that it is
+	// calculating, if it falls behind the drawing.
+	static int StepsAhead();
+	static void ToggleStepsAhead();
+	
+	// How many megabytes of sprite textures to keep uploaded to the GPU, or zero
+	// for no limit. This can only be set in the preferences file.
+	static int TextureBudget();
+	
 	// View zoom.
 	static double ViewZoom();
 	static bool ZoomViewIn();
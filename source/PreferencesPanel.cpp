@@ -52,6 +52,8 @@ namespace {
 	const string REACTIVATE_HELP = "Reactivate first-time help";
 	const string SCROLL_SPEED = "Scroll speed";
 	const string FIGHTER_REPAIR = "Repair fighters in";
+	const string FRAME_QUEUE = "Max frames awaiting GPU";
+	const string STEPS_AHEAD = "Steps calculated ahead";
 }
 
 
@@ -176,6 +178,10 @@ bool PreferencesPanel::Click(int x, int y, int clicks)
 				for(const auto &it : GameData::HelpTemplates())
 					Preferences::Set("help: " + it.first, false);
 			}
+			else if(zone.Value() == FRAME_QUEUE)
+				Preferences::ToggleFrameQueueDepth();
+			else if(zone.Value() == STEPS_AHEAD)
+				Preferences::ToggleStepsAhead();
 			else if(zone.Value() == SCROLL_SPEED)
 			{
 				// Toogle between three different speeds.
@@ -434,6 +440,9 @@ void PreferencesPanel::DrawSettings()
 		"\n",
 		"Performance",
 		"Show CPU / GPU load",
+		"Show frame latency",
+		FRAME_QUEUE,
+		STEPS_AHEAD,
 		"Render motion blur",
 		"Reduce large graphics",
 		"Draw background haze",
@@ -536,6 +545,16 @@ void PreferencesPanel::DrawSettings()
 			isOn = true;
 			text = to_string(Preferences::ScrollSpeed());
 		}
+		else if(setting == FRAME_QUEUE)
+		{
+			isOn = Preferences::FrameQueueDepth();
+			text = isOn ? to_string(Preferences::FrameQueueDepth()) : "driver";
+		}
+		else if(setting == STEPS_AHEAD)
+		{
+			isOn = Preferences::StepsAhead();
+			text = isOn ? to_string(Preferences::StepsAhead()) : "off";
+		}
 		else
 			text = isOn ? "on" : "off";
 		
@@ -0,0 +1,203 @@
+/* Profiler.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Profiler.h"
+
+#include "Files.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// The number of zones each thread remembers. At a few hundred zones per
+	// frame in the busiest thread, this covers the last several seconds.
+	const size_t CAPACITY = 1 << 17;
+	
+	class Event {
+	public:
+		const char *name;
+		int64_t start;
+		int64_t end;
+	};
+	
+	// The zones recorded by one thread. Only that thread adds to it, but the
+	// thread that writes out the trace also needs to read it.
+	class ThreadBuffer {
+	public:
+		mutex lock;
+		string name;
+		int id = 0;
+		vector<Event> events;
+		size_t next = 0;
+		size_t count = 0;
+	};
+	
+	// Every thread that has ever recorded a zone or been given a name. These
+	// are never freed, so that a trace can still include threads that have
+	// since ended. Some threads start during static initialization, so the
+	// registry must be created on first use.
+	class Registry {
+	public:
+		mutex lock;
+		vector<unique_ptr<ThreadBuffer>> buffers;
+	};
+	
+	Registry &GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+	
+	thread_local ThreadBuffer *threadBuffer = nullptr;
+	
+	ThreadBuffer &GetBuffer()
+	{
+		if(!threadBuffer)
+		{
+			Registry &registry = GetRegistry();
+			lock_guard<mutex> lock(registry.lock);
+			registry.buffers.emplace_back(new ThreadBuffer);
+			threadBuffer = registry.buffers.back().get();
+			threadBuffer->id = registry.buffers.size();
+			threadBuffer->name = "Thread " + to_string(threadBuffer->id);
+		}
+		return *threadBuffer;
+	}
+	
+	// Names are string literals, but escape them anyway in case one contains
+	// something that is not allowed in a JSON string.
+	void WriteString(ostringstream &out, const string &text)
+	{
+		out << '"';
+		for(char c : text)
+		{
+			if(c == '"' || c == '\\')
+				out << '\\' << c;
+			else if(static_cast<unsigned char>(c) >= 0x20)
+				out << c;
+		}
+		out << '"';
+	}
+}
+
+atomic<bool> Profiler::isRunning(false);
+
+
+
+// Start or stop recording. Starting again discards the previous recording.
+void Profiler::Start()
+{
+	{
+		Registry &registry = GetRegistry();
+		lock_guard<mutex> lock(registry.lock);
+		for(const unique_ptr<ThreadBuffer> &buffer : registry.buffers)
+		{
+			lock_guard<mutex> bufferLock(buffer->lock);
+			buffer->next = 0;
+			buffer->count = 0;
+		}
+	}
+	isRunning = true;
+}
+
+
+
+void Profiler::Stop()
+{
+	isRunning = false;
+}
+
+
+
+// Set the name that the calling thread is shown with in the trace.
+void Profiler::SetThreadName(const string &name)
+{
+	ThreadBuffer &buffer = GetBuffer();
+	lock_guard<mutex> lock(buffer.lock);
+	buffer.name = name;
+}
+
+
+
+// Write out everything that has been recorded, in the trace event format.
+bool Profiler::Write(const string &path)
+{
+	ostringstream out;
+	out << fixed << setprecision(3);
+	out << "{\"traceEvents\":[\n";
+	bool isFirst = true;
+	{
+		Registry &registry = GetRegistry();
+		lock_guard<mutex> lock(registry.lock);
+		for(const unique_ptr<ThreadBuffer> &buffer : registry.buffers)
+		{
+			lock_guard<mutex> bufferLock(buffer->lock);
+			// Each thread gets a metadata event giving its name.
+			out << (isFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+				<< ",\"args\":{\"name\":";
+			WriteString(out, buffer->name);
+			out << "}}";
+			isFirst = false;
+			
+			// The times are in microseconds.
+			size_t first = (buffer->next + CAPACITY - buffer->count) % CAPACITY;
+			for(size_t i = 0; i < buffer->count; ++i)
+			{
+				const Event &event = buffer->events[(first + i) % CAPACITY];
+				out << ",\n{\"name\":";
+				WriteString(out, event.name);
+				out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+					<< ",\"ts\":" << event.start * .001 << ",\"dur\":" << (event.end - event.start) * .001 << "}";
+			}
+		}
+	}
+	out << "\n]}\n";
+	
+	FILE *file = Files::Open(path, true);
+	if(!file)
+		return false;
+	Files::Write(file, out.str());
+	fclose(file);
+	return true;
+}
+
+
+
+// Get the time since the profiler was first used, in nanoseconds.
+int64_t Profiler::Now()
+{
+	static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+
+
+void Profiler::Record(const char *name, int64_t start, int64_t end)
+{
+	ThreadBuffer &buffer = GetBuffer();
+	lock_guard<mutex> lock(buffer.lock);
+	// Only allocate space for threads that actually record something.
+	if(buffer.events.empty())
+		buffer.events.resize(CAPACITY);
+	
+	buffer.events[buffer.next] = {name, start, end};
+	buffer.next = (buffer.next + 1) % CAPACITY;
+	buffer.count = min(buffer.count + 1, CAPACITY);
+}
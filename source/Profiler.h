@@ -0,0 +1,99 @@
+/* Profiler.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+
+// Class for measuring how long each part of the game takes, in every thread. To
+// measure a block of code, create a Profiler::Zone at the start of it; the zone
+// ends when it goes out of scope, and zones may be nested. While the profiler
+// is running, each thread records its zones in its own ring buffer, so only the
+// most recent few seconds are kept. The recording can be written out in the
+// "trace event" format that Chrome's about:tracing and other trace viewers can
+// display. When the profiler is not running, a zone costs one branch.
+// Each zone is named for the function it measures, as "Class::Function". If it
+// only covers part of that function, the name of that part follows, as in
+// "Class::Function: part".
+class Profiler {
+public:
+	class Zone {
+	public:
+		// The name must be a string literal, or otherwise outlive the profiler.
+		explicit Zone(const char *name);
+		~Zone();
+		
+		Zone(const Zone &) = delete;
+		Zone &operator=(const Zone &) = delete;
+	
+	private:
+		const char *name;
+		// The time this zone began, or -1 if the profiler was not running.
+		int64_t start;
+	};
+	
+	
+public:
+	// Start or stop recording. Starting again discards the previous recording.
+	static void Start();
+	static void Stop();
+	static bool IsRunning();
+	
+	// Set the name that the calling thread is shown with in the trace.
+	static void SetThreadName(const std::string &name);
+	
+	// Write out everything that has been recorded, in the trace event format.
+	// Returns false if the file could not be written.
+	static bool Write(const std::string &path);
+	
+	
+private:
+	static int64_t Now();
+	static void Record(const char *name, int64_t start, int64_t end);
+	
+	
+private:
+	static std::atomic<bool> isRunning;
+};
+
+
+
+// These are defined here so that when the profiler is not running, checking
+// that is the only cost of a zone.
+inline bool Profiler::IsRunning()
+{
+	return isRunning.load(std::memory_order_relaxed);
+}
+
+
+
+inline Profiler::Zone::Zone(const char *name)
+	: name(name), start(isRunning.load(std::memory_order_relaxed) ? Now() : -1)
+{
+}
+
+
+
+inline Profiler::Zone::~Zone()
+{
+	if(start >= 0)
+		Record(name, start, Now());
+}
+
+
+
+#endif
@@ -37,7 +37,8 @@ namespace {
 
 Projectile::Projectile(const Ship &parent, Point position, Angle angle, const Weapon *weapon)
 	: Body(weapon->WeaponSprite(), position, parent.Velocity(), angle),
-	weapon(weapon), targetShip(parent.GetTargetShip()), lifetime(weapon->Lifetime())
+	weapon(weapon), targetShip(parent.GetTargetShip()), lifetime(weapon->Lifetime()),
+	randomKey(Random::Key())
 {
 	government = parent.GetGovernment();
 	
@@ -63,7 +64,8 @@ Projectile::Projectile(const Ship &parent, Point position, Angle angle, const We
 
 Projectile::Projectile(const Projectile &parent, const Weapon *weapon)
 	: Body(weapon->WeaponSprite(), parent.position + parent.velocity, parent.velocity, parent.angle),
-	weapon(weapon), targetShip(parent.targetShip), lifetime(weapon->Lifetime())
+	weapon(weapon), targetShip(parent.targetShip), lifetime(weapon->Lifetime()),
+	randomKey(Random::Key())
 {
 	government = parent.government;
 	targetGovernment = parent.targetGovernment;
@@ -285,6 +287,14 @@ shared_ptr<Ship> Projectile::TargetPtr() const
 
 
 
+// Get the key that identifies this projectile's random number streams.
+uint64_t Projectile::RandomKey() const
+{
+	return randomKey;
+}
+
+
+
 void Projectile::CheckLock(const Ship &target)
 {
 	double base = hasLock ? 1. : .5;
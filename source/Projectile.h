@@ -18,6 +18,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Angle.h"
 #include "Point.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -73,6 +74,9 @@ public:
 	// non-const shared pointer to the target.
 	std::shared_ptr<Ship> TargetPtr() const;
 	
+	// Get the key that identifies this projectile's random number streams.
+	uint64_t RandomKey() const;
+	
 	
 private:
 	void CheckLock(const Ship &target);
@@ -88,6 +92,7 @@ private:
 	double clip = 1.;
 	int lifetime = 0;
 	bool hasLock = true;
+	uint64_t randomKey = 0;
 };
 
 
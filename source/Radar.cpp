@@ -12,11 +12,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Radar.h"
 
+#include "DotShader.h"
 #include "GameData.h"
 #include "LineShader.h"
 #include "PointerShader.h"
 #include "RingShader.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -31,11 +33,33 @@ const int Radar::ANOMALOUS = 6;
 const int Radar::BLINK = 7;
 const int Radar::VIEWPORT = 8;
 
+namespace {
+	// Size of the grid cells used to merge dots, in radar pixels.
+	const double CELL_SIZE = 2.;
+	
+	// Marker for a grid cell that does not have a dot in it yet.
+	const size_t NO_DOT = static_cast<size_t>(-1);
+	
+	// Get the key of the grid cell containing the given point (in radar
+	// pixels) for a dot of the given type. The key is never zero.
+	uint64_t CellKey(int type, const Point &point)
+	{
+		uint64_t x = static_cast<uint32_t>(static_cast<int32_t>(floor(point.X() / CELL_SIZE)));
+		uint64_t y = static_cast<uint32_t>(static_cast<int32_t>(floor(point.Y() / CELL_SIZE)));
+		return (1ull << 63) | (x & 0x7FFFFFF) << 35 | (y & 0x7FFFFFF) << 8 | (type & 0xFF);
+	}
+}
+
 
 
 void Radar::Clear()
 {
 	objects.clear();
+	// Keep the per-type lists so their memory can be reused.
+	for(auto &it : dots)
+		it.second.clear();
+	fill(cells.begin(), cells.end(), make_pair(0ull, NO_DOT));
+	usedCells = 0;
 	pointers.clear();
 	lines.clear();
 }
@@ -49,11 +73,40 @@ void Radar::SetCenter(const Point &center)
 
 
 
+void Radar::SetScale(double scale)
+{
+	gridScale = scale;
+}
+
+
+
 // Add an object. If "inner" is 0 it is a dot; otherwise, it is a ring. The
 // given position should be in world units (not shrunk to radar units).
 void Radar::Add(int type, Point position, double outer, double inner)
 {
-	objects.emplace_back(GetColor(type).Opaque(), position - center, outer, inner);
+	position -= center;
+	if(inner)
+	{
+		objects.emplace_back(GetColor(type).Opaque(), position, outer, inner);
+		return;
+	}
+	
+	vector<Dot> &list = dots[type];
+	if(gridScale)
+	{
+		// If there is already a dot in this grid cell, merge with it.
+		size_t &index = Cell(CellKey(type, position * gridScale)).second;
+		if(index != NO_DOT)
+		{
+			Dot &dot = list[index];
+			dot.position += position;
+			dot.count += 1.;
+			dot.outer = max(dot.outer, outer);
+			return;
+		}
+		index = list.size();
+	}
+	list.emplace_back(position, outer);
 }
 
 
@@ -107,7 +160,7 @@ void Radar::Draw(const Point &center, double scale, double radius, double pointe
 		LineShader::Draw(start + center, start + v + center, 1.f, line.color);
 	}
 	
-	// Draw StellarObjects and ships.
+	// Draw StellarObjects.
 	RingShader::Bind();
 	for(const Object &object : objects)
 	{
@@ -121,6 +174,29 @@ void Radar::Draw(const Point &center, double scale, double radius, double pointe
 	}
 	RingShader::Unbind();
 	
+	// Draw ships and projectiles, one batch for each color.
+	DotShader::Bind();
+	vector<float> batch;
+	for(const auto &it : dots)
+	{
+		batch.clear();
+		for(const Dot &dot : it.second)
+		{
+			Point position = dot.position * (scale / dot.count);
+			double length = position.Length();
+			if(length > radius)
+				position *= radius / length;
+			position += center;
+			
+			batch.insert(batch.end(), {
+				static_cast<float>(position.X()),
+				static_cast<float>(position.Y()),
+				static_cast<float>(dot.outer)});
+		}
+		DotShader::Add(batch, GetColor(it.first).Opaque());
+	}
+	DotShader::Unbind();
+	
 	// Draw neighboring system indicators.
 	PointerShader::Bind();
 	for(const Pointer &pointer : pointers)
@@ -159,6 +235,41 @@ Radar::Object::Object(const Color &color, const Point &pos, double out, double i
 
 
 
+// Find the given grid cell's hash table entry, adding it if necessary.
+pair<uint64_t, size_t> &Radar::Cell(uint64_t key)
+{
+	// Keep the table no more than half full.
+	if(2 * (usedCells + 1) > cells.size())
+	{
+		vector<pair<uint64_t, size_t>> old(max<size_t>(256, 2 * cells.size()), make_pair(0ull, NO_DOT));
+		old.swap(cells);
+		usedCells = 0;
+		for(const auto &cell : old)
+			if(cell.first)
+				Cell(cell.first).second = cell.second;
+	}
+	
+	size_t mask = cells.size() - 1;
+	size_t i = (key * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+	while(cells[i].first && cells[i].first != key)
+		i = (i + 1) & mask;
+	if(!cells[i].first)
+	{
+		cells[i].first = key;
+		++usedCells;
+	}
+	return cells[i];
+}
+
+
+
+Radar::Dot::Dot(const Point &pos, double out)
+	: position(pos), count(1.), outer(out)
+{
+}
+
+
+
 Radar::Pointer::Pointer(const Color &color, const Point &unit)
 	: color(color), unit(unit)
 {
@@ -16,6 +16,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Color.h"
 #include "Point.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
 #include <vector>
 
 
@@ -39,6 +43,11 @@ public:
 public:
 	void Clear();
 	void SetCenter(const Point &center);
+	// Set the scale that the radar will be drawn at. If this is nonzero, dots
+	// of the same type that would be drawn within a couple of pixels of each
+	// other are merged into one, so that drawing a large fleet only takes as
+	// much work as the area it covers on the radar.
+	void SetScale(double scale);
 	
 	// Add an object. If "inner" is 0 it is a dot; otherwise, it is a ring. The
 	// given position should be in world units (not shrunk to radar units).
@@ -55,6 +64,11 @@ public:
 	static const Color &GetColor(int type);
 	
 	
+private:
+	// Find the given grid cell's hash table entry, adding it if necessary.
+	std::pair<uint64_t, size_t> &Cell(uint64_t key);
+	
+	
 private:
 	class Object {
 	public:
@@ -66,6 +80,17 @@ private:
 		double inner;
 	};
 	
+	// A dot, or a group of dots of the same type that have been merged. The
+	// position is the sum of all the merged positions.
+	class Dot {
+	public:
+		Dot(const Point &pos, double out);
+		
+		Point position;
+		double count;
+		double outer;
+	};
+	
 	class Pointer {
 	public:
 		Pointer(const Color &color, const Point &unit);
@@ -85,7 +110,14 @@ private:
 	
 private:
 	Point center;
+	double gridScale = 0.;
 	std::vector<Object> objects;
+	// Dots are grouped by type, because each type is drawn in one batch.
+	std::map<int, std::vector<Dot>> dots;
+	// Open-addressed hash table from each occupied grid cell to the index of
+	// the dot in that cell. A key of zero marks an empty slot.
+	std::vector<std::pair<uint64_t, size_t>> cells;
+	size_t usedCells = 0;
 	std::vector<Pointer> pointers;
 	std::vector<Line> lines;
 };
@@ -20,7 +20,9 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 using namespace std;
 
-// Right now thread_local storage is only supported under Linux.
+// Right now thread_local storage of objects is only supported under Linux.
+// Elsewhere, the global generator is shared by all threads. Each thread still
+// has its own current stream, because a pointer can be thread_local anywhere.
 namespace {
 #ifndef __linux__
 	mutex workaroundMutex;
@@ -32,6 +34,57 @@ namespace {
 	thread_local uniform_int_distribution<uint32_t> uniform;
 	thread_local uniform_real_distribution<double> real;
 #endif
+	thread_local Random::Stream *current = nullptr;
+	
+	const uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+	
+	// Scramble the bits of the given number (the SplitMix64 output function).
+	uint64_t Mix(uint64_t x)
+	{
+		x += GOLDEN;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+	
+	// Get the stream that random numbers on this thread should come from, if any.
+	Random::Stream *Active()
+	{
+		return current;
+	}
+}
+
+
+
+// Begin a stream for the given step of the game with the given seed.
+Random::Stream::Stream(uint64_t seed, uint64_t step, uint64_t entity, Purpose purpose)
+	: seed(seed), step(step), key(Mix(Mix(Mix(Mix(seed) ^ step) ^ entity) ^ purpose)), previous(current)
+{
+	current = this;
+}
+
+
+
+// Begin a stream for one entity, within the stream that is currently active on
+// this thread. If there is none, the seed and step are both zero.
+Random::Stream::Stream(uint64_t entity, Purpose purpose)
+	: Stream(Active() ? Active()->seed : 0, Active() ? Active()->step : 0, entity, purpose)
+{
+}
+
+
+
+Random::Stream::~Stream()
+{
+	current = previous;
+}
+
+
+
+// Get the next number in this stream.
+Random::Stream::result_type Random::Stream::operator()()
+{
+	return Mix(key + counter++ * GOLDEN);
 }
 
 
@@ -50,6 +103,10 @@ void Random::Seed(uint64_t seed)
 
 uint32_t Random::Int()
 {
+	Stream *stream = Active();
+	if(stream)
+		return (*stream)() >> 32;
+	
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
@@ -60,16 +117,30 @@ uint32_t Random::Int()
 
 uint32_t Random::Int(uint32_t modulus)
 {
-#ifndef __linux__
-	lock_guard<mutex> lock(workaroundMutex);
-#endif
-	return uniform(gen) % modulus;
+	return Int() % modulus;
+}
+
+
+
+// Get a 64-bit number, e.g. to use as the entity key of a new stream.
+uint64_t Random::Key()
+{
+	Stream *stream = Active();
+	if(stream)
+		return (*stream)();
+	
+	return (static_cast<uint64_t>(Int()) << 32) | Int();
 }
 
 
 
 double Random::Real()
 {
+	// Use the top 53 bits, which is all that a double can hold.
+	Stream *stream = Active();
+	if(stream)
+		return ((*stream)() >> 11) * (1. / (static_cast<uint64_t>(1) << 53));
+	
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
@@ -83,6 +154,10 @@ double Random::Real()
 uint32_t Random::Polya(uint32_t k, double p)
 {
 	negative_binomial_distribution<uint32_t> polya(k, p);
+	Stream *stream = Active();
+	if(stream)
+		return polya(*stream);
+	
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
@@ -95,6 +170,10 @@ uint32_t Random::Polya(uint32_t k, double p)
 uint32_t Random::Binomial(uint32_t t, double p)
 {
 	binomial_distribution<uint32_t> binomial(t, p);
+	Stream *stream = Active();
+	if(stream)
+		return binomial(*stream);
+	
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
@@ -107,6 +186,10 @@ uint32_t Random::Binomial(uint32_t t, double p)
 double Random::Normal()
 {
 	normal_distribution<double> normal;
+	Stream *stream = Active();
+	if(stream)
+		return normal(*stream);
+	
 #ifndef __linux__
 	lock_guard<mutex> lock(workaroundMutex);
 #endif
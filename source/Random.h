@@ -14,6 +14,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #define RANDOM_H_
 
 #include <cstdint>
+#include <thread>
 
 
 
@@ -21,6 +22,53 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 // different distributions. (This is done partly because on some systems the
 // random number generation is not thread-safe.)
 class Random {
+public:
+	// What a random stream is being used for. Two streams for the same object
+	// in the same step produce different numbers if their purposes differ.
+	enum Purpose : uint64_t {
+		STEP,
+		PLACE,
+		AI,
+		MOVE,
+		PROJECTILE
+	};
+	
+	// A counter-based stream of random numbers. While a stream exists, all the
+	// random numbers drawn on the thread that created it come from that stream
+	// instead of from the global generator. The numbers depend only on the
+	// stream's seed, step, entity, and purpose, and on how many numbers have
+	// been drawn from it, so the game's simulation produces the same results no
+	// matter what order the objects in it are updated in, or on what thread.
+	class Stream {
+	public:
+		// Begin a stream for the given step of the game with the given seed.
+		Stream(uint64_t seed, uint64_t step, uint64_t entity, Purpose purpose);
+		// Begin a stream for one entity, within the stream that is currently
+		// active on this thread (sharing its seed and step).
+		Stream(uint64_t entity, Purpose purpose);
+		~Stream();
+		
+		Stream(const Stream &) = delete;
+		Stream &operator=(const Stream &) = delete;
+		
+		// Get the next number in this stream. This also allows a stream to be
+		// used with the standard library's random distributions.
+		typedef uint64_t result_type;
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return UINT64_MAX; }
+		result_type operator()();
+		
+		
+	private:
+		uint64_t seed;
+		uint64_t step;
+		uint64_t key;
+		uint64_t counter = 0;
+		
+		Stream *previous;
+	};
+	
+	
 public:
 	// Seed the generator (e.g. to make it produce exactly the same random
 	// numbers it produced previously).
@@ -28,6 +76,8 @@ public:
 	
 	static uint32_t Int();
 	static uint32_t Int(uint32_t modulus);
+	// Get a 64-bit number, e.g. to use as the entity key of a new stream.
+	static uint64_t Key();
 	
 	static double Real();
 	
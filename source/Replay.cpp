@@ -0,0 +1,427 @@
+/* Replay.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Replay.h"
+
+#include "Command.h"
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Engine.h"
+#include "Files.h"
+#include "GameData.h"
+#include "PlayerInfo.h"
+#include "Point.h"
+#include "Preferences.h"
+#include "Screen.h"
+#include "ShipEvent.h"
+#include "Sprite.h"
+#include "UI.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// The input that the engine was given in one step. Runs of identical steps
+	// are stored as a single line of the recording.
+	class Frame {
+	public:
+		bool operator==(const Frame &other) const
+		{
+			return keys == other.keys && hasShift == other.hasShift && clickCommands == other.clickCommands
+				&& isActive == other.isActive && go == other.go && !memcmp(&zoom, &other.zoom, sizeof(zoom));
+		}
+		
+		uint32_t keys = 0;
+		bool hasShift = false;
+		uint32_t clickCommands = 0;
+		bool isActive = false;
+		// Whether the engine went on to calculate the next step.
+		bool go = false;
+		double zoom = 1.;
+	};
+	
+	// State for recording.
+	string recordPath;
+	FILE *out = nullptr;
+	// The most recent step's input, which is not final until the next step
+	// begins (because the engine may or may not go on to the next step).
+	Frame pending;
+	bool hasPending = false;
+	Frame run;
+	int runCount = 0;
+	
+	// State for playing back a recording.
+	bool isPlaying = false;
+	DataFile recording;
+	vector<const DataNode *> events;
+	size_t nextEvent = 0;
+	int usedSteps = 0;
+	int startStep = 0;
+	
+	// Store doubles by their exact bits, so that they are read back exactly.
+	string ToHex(double value)
+	{
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		ostringstream hex;
+		hex << std::hex << setw(16) << setfill('0') << bits;
+		return hex.str();
+	}
+	
+	double FromHex(const string &token)
+	{
+		uint64_t bits = strtoull(token.c_str(), nullptr, 16);
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	
+	void WriteLine(const string &line)
+	{
+		Files::Write(out, line + '\n');
+		fflush(out);
+	}
+	
+	void WriteRun()
+	{
+		if(!runCount)
+			return;
+		
+		ostringstream line;
+		line << "frame " << runCount << ' ' << run.keys << ' ' << run.hasShift << ' ' << run.clickCommands
+			<< ' ' << run.isActive << ' ' << run.go << ' ' << ToHex(run.zoom);
+		WriteLine(line.str());
+		runCount = 0;
+	}
+	
+	void AddToRun(const Frame &frame)
+	{
+		if(runCount && frame == run)
+			++runCount;
+		else
+		{
+			WriteRun();
+			run = frame;
+			runCount = 1;
+		}
+	}
+	
+	// Write out all the input that has been recorded so far.
+	void Flush()
+	{
+		if(hasPending)
+			AddToRun(pending);
+		hasPending = false;
+		WriteRun();
+	}
+	
+	void Close()
+	{
+		if(!out)
+			return;
+		
+		Flush();
+		fclose(out);
+		out = nullptr;
+	}
+	
+	// Make sure the end of the recording is written out when the game exits.
+	class Closer {
+	public:
+		~Closer() { Close(); }
+	} closer;
+	
+	// Check whether the engine will go on to the next step after the next
+	// recorded step of input.
+	bool NextGo()
+	{
+		for(size_t i = nextEvent; i < events.size(); ++i)
+			if(events[i]->Token(0) == "frame")
+				return events[i]->Value(6);
+		return false;
+	}
+	
+	bool HasInput()
+	{
+		for(size_t i = nextEvent; i < events.size(); ++i)
+			if(events[i]->Token(0) == "frame")
+				return true;
+		return false;
+	}
+	
+	void PrintHash(int step, const Engine &engine)
+	{
+		cout << "step " << step << ": " << hex << setw(16) << setfill('0') << engine.StateHash() << dec << endl;
+	}
+}
+
+
+
+// Record the player's flights to the given file.
+void Replay::Record(const string &path)
+{
+	recordPath = path;
+}
+
+
+
+// Play back the recording in the given file without drawing it.
+int Replay::Play(const string &path, int interval)
+{
+	recording.Load(path);
+	string pilot;
+	uint32_t seed = 0;
+	int width = 0;
+	int height = 0;
+	for(const DataNode &node : recording)
+	{
+		const string &key = node.Token(0);
+		if(key == "pilot" && node.Size() >= 2)
+			pilot = node.Token(1);
+		else if(key == "seed" && node.Size() >= 2)
+			seed = node.Value(1);
+		else if(key == "step" && node.Size() >= 2)
+			startStep = node.Value(1);
+		else if(key == "screen" && node.Size() >= 3)
+		{
+			width = node.Value(1);
+			height = node.Value(2);
+		}
+		else if((key == "frame" && node.Size() >= 8) || (key == "click" && node.Size() >= 7)
+				|| (key == "rclick" && node.Size() >= 4) || (key == "group" && node.Size() >= 4))
+			events.push_back(&node);
+		else
+			node.PrintTrace("Skipping unrecognized replay attribute:");
+	}
+	if(pilot.empty() || !Files::Exists(pilot))
+	{
+		cerr << "Unable to find the saved game that \"" << path << "\" begins from." << endl;
+		return 1;
+	}
+	isPlaying = true;
+	
+	// Nothing will be drawn, but the sprites' sizes and masks are needed.
+	Sprite::SetHeadless();
+	GameData::FinishLoading();
+	Preferences::Load();
+	if(width && height)
+		Screen::SetRaw(width, height);
+	
+	PlayerInfo player;
+	player.Load(pilot);
+	if(player.Seed() != seed)
+		cerr << "Warning: the saved game's random seed does not match the recording." << endl;
+	
+	// Any panels that would be shown during the flight are never drawn.
+	UI ui;
+	if(!player.TakeOff(&ui))
+	{
+		cerr << "Unable to take off from the saved game that \"" << path << "\" begins from." << endl;
+		return 1;
+	}
+	
+	// This is the same sequence that MainPanel follows when the player takes off.
+	Engine engine(player);
+	engine.Place();
+	engine.Go();
+	engine.Wait();
+	engine.Step(true);
+	engine.Go();
+	
+	// The first step of input was used above.
+	int steps = 1;
+	int printed = -1;
+	while(HasInput())
+	{
+		engine.Wait();
+		if(interval > 0 && !(steps % interval) && steps != printed)
+		{
+			PrintHash(steps, engine);
+			printed = steps;
+		}
+		
+		bool go = NextGo();
+		engine.Step(true);
+		for(const ShipEvent &event : engine.Events())
+			player.HandleEvent(event, &ui);
+		engine.Events().clear();
+		if(go)
+		{
+			engine.Go();
+			++steps;
+		}
+	}
+	engine.Wait();
+	PrintHash(steps, engine);
+	return 0;
+}
+
+
+
+bool Replay::IsPlaying()
+{
+	return isPlaying;
+}
+
+
+
+bool Replay::IsRecording()
+{
+	return !recordPath.empty();
+}
+
+
+
+// The engine is beginning a new flight.
+void Replay::Begin(const PlayerInfo &player, int &step)
+{
+	if(isPlaying)
+	{
+		step = startStep;
+		return;
+	}
+	if(recordPath.empty())
+		return;
+	
+	// Finish any previous recording, then start over.
+	Close();
+	
+	// The game was saved just before taking off. Keep a copy of that save, since
+	// the game will overwrite it the next time the player lands.
+	string pilot = Files::Saves() + player.Identifier() + ".txt";
+	if(!Files::Exists(pilot))
+	{
+		Files::LogError("Unable to record this flight, because the pilot has not been saved.");
+		return;
+	}
+	string copy = recordPath + ".pilot";
+	Files::Copy(pilot, copy);
+	
+	out = Files::Open(recordPath, true);
+	if(!out)
+	{
+		Files::LogError("Unable to write a recording to \"" + recordPath + "\".");
+		return;
+	}
+	WriteLine("pilot \"" + copy + "\"");
+	WriteLine("seed " + to_string(player.Seed()));
+	WriteLine("step " + to_string(step));
+	WriteLine("screen " + to_string(Screen::RawWidth()) + " " + to_string(Screen::RawHeight()));
+}
+
+
+
+// Record the input for one step, or replace it with the recorded input.
+void Replay::Input(Engine &engine, Command &keys, bool &hasShift, Command &clickCommands, bool &isActive, double &zoom)
+{
+	if(isPlaying)
+	{
+		// Repeat any clicks that were made before this step. They depend on
+		// the zoom level at the time of the click.
+		for( ; nextEvent < events.size() && events[nextEvent]->Token(0) != "frame"; ++nextEvent)
+		{
+			const DataNode &node = *events[nextEvent];
+			const string &key = node.Token(0);
+			if(key == "click")
+			{
+				zoom = FromHex(node.Token(6));
+				engine.Click(Point(FromHex(node.Token(1)), FromHex(node.Token(2))),
+					Point(FromHex(node.Token(3)), FromHex(node.Token(4))), node.Value(5));
+			}
+			else if(key == "rclick")
+			{
+				zoom = FromHex(node.Token(3));
+				engine.RClick(Point(FromHex(node.Token(1)), FromHex(node.Token(2))));
+			}
+			else if(key == "group")
+				engine.SelectGroup(node.Value(1), node.Value(2), node.Value(3));
+		}
+		if(nextEvent == events.size())
+			return;
+		
+		const DataNode &node = *events[nextEvent];
+		keys.SetKeys(node.Value(2));
+		hasShift = node.Value(3);
+		clickCommands = Command();
+		clickCommands.SetKeys(node.Value(4));
+		isActive = node.Value(5);
+		zoom = FromHex(node.Token(7));
+		if(++usedSteps >= node.Value(1))
+		{
+			++nextEvent;
+			usedSteps = 0;
+		}
+		return;
+	}
+	if(!out)
+		return;
+	
+	if(hasPending)
+		AddToRun(pending);
+	pending.keys = keys.Keys();
+	pending.hasShift = hasShift;
+	pending.clickCommands = clickCommands.Keys();
+	pending.isActive = isActive;
+	pending.go = false;
+	pending.zoom = zoom;
+	hasPending = true;
+}
+
+
+
+// The engine is going on to calculate the next step.
+void Replay::Go()
+{
+	if(out && hasPending)
+		pending.go = true;
+}
+
+
+
+void Replay::Click(const Point &from, const Point &to, bool hasShift, double zoom)
+{
+	if(!out)
+		return;
+	
+	Flush();
+	WriteLine("click " + ToHex(from.X()) + " " + ToHex(from.Y()) + " " + ToHex(to.X()) + " " + ToHex(to.Y())
+		+ " " + to_string(hasShift) + " " + ToHex(zoom));
+}
+
+
+
+void Replay::RClick(const Point &point, double zoom)
+{
+	if(!out)
+		return;
+	
+	Flush();
+	WriteLine("rclick " + ToHex(point.X()) + " " + ToHex(point.Y()) + " " + ToHex(zoom));
+}
+
+
+
+void Replay::SelectGroup(int group, bool hasShift, bool hasControl)
+{
+	if(!out)
+		return;
+	
+	Flush();
+	WriteLine("group " + to_string(group) + " " + to_string(hasShift) + " " + to_string(hasControl));
+}
@@ -0,0 +1,57 @@
+/* Replay.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <string>
+
+class Command;
+class Engine;
+class PlayerInfo;
+class Point;
+
+
+
+// Class for recording the player's input to the game engine, so that a flight
+// can be played back later and will turn out exactly the same. A recording
+// holds the saved game the flight began from, the seed for the game's random
+// numbers, and for each step, the keys the player was holding and where they
+// clicked. Playing a recording back without drawing anything and comparing the
+// hashes of the game state shows whether a change to the engine has changed
+// the outcome of the game. Anything that happens in other panels (dialogs,
+// conversations, the map) is not recorded.
+class Replay {
+public:
+	// Record the player's flights to the given file. Each time the player takes
+	// off, the previous recording is replaced by a new one.
+	static void Record(const std::string &path);
+	// Play back the recording in the given file without drawing it, printing a
+	// hash of the game state every "interval" steps. Returns the exit code.
+	static int Play(const std::string &path, int interval);
+	static bool IsPlaying();
+	static bool IsRecording();
+	
+	// The engine calls these functions when it begins a flight, for each step,
+	// and for each click, so that they can be recorded. When a recording is
+	// being played, the input is replaced with the recorded input instead.
+	static void Begin(const PlayerInfo &player, int &step);
+	static void Input(Engine &engine, Command &keys, bool &hasShift, Command &clickCommands, bool &isActive, double &zoom);
+	static void Go();
+	static void Click(const Point &from, const Point &to, bool hasShift, double zoom);
+	static void RClick(const Point &point, double zoom);
+	static void SelectGroup(int group, bool hasShift, bool hasControl);
+};
+
+
+
+#endif
@@ -13,6 +13,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "RingShader.h"
 
 #include "Color.h"
+#include "Font.h"
 #include "pi.h"
 #include "Point.h"
 #include "Screen.h"
@@ -140,6 +141,7 @@ void RingShader::Bind()
 	if(!shader.Object())
 		throw runtime_error("RingShader: Bind() called before Init().");
 	
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
@@ -0,0 +1,206 @@
+/* Scenario.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Scenario.h"
+
+#include "Allocations.h"
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Engine.h"
+#include "Files.h"
+#include "Format.h"
+#include "GameData.h"
+#include "NPC.h"
+#include "Planet.h"
+#include "PlayerInfo.h"
+#include "Preferences.h"
+#include "Random.h"
+#include "Screen.h"
+#include "Ship.h"
+#include "ShipEvent.h"
+#include "Sprite.h"
+#include "System.h"
+#include "UI.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+namespace {
+	bool isRunning = false;
+	
+	// Count how many of the given NPCs' ships have not been destroyed.
+	int CountShips(const list<NPC> &npcs)
+	{
+		int count = 0;
+		for(const NPC &npc : npcs)
+			for(const shared_ptr<Ship> &ship : npc.Ships())
+				count += !ship->IsDestroyed();
+		return count;
+	}
+	
+	// Run one scenario and print the results. Return false if the scenario
+	// could not be set up.
+	bool RunOne(const DataNode &node)
+	{
+		const string &name = node.Token(1);
+		const System *system = nullptr;
+		const Planet *planet = nullptr;
+		const Ship *model = nullptr;
+		uint32_t seed = 0;
+		int steps = 0;
+		for(const DataNode &child : node)
+		{
+			const string &key = child.Token(0);
+			bool hasValue = (child.Size() >= 2);
+			if(key == "system" && hasValue)
+				system = GameData::Systems().Find(child.Token(1));
+			else if(key == "planet" && hasValue)
+				planet = GameData::Planets().Find(child.Token(1));
+			else if(key == "flagship" && hasValue)
+				model = GameData::Ships().Find(child.Token(1));
+			else if(key == "seed" && hasValue)
+				seed = child.Value(1);
+			else if(key == "steps" && hasValue)
+				steps = child.Value(1);
+			else if(key != "npc")
+				child.PrintTrace("Skipping unrecognized attribute:");
+		}
+		if(!system || !planet || !system->FindStellar(planet) || !model || steps <= 0)
+		{
+			cerr << name << ": a scenario must name a system, a planet in that system, a flagship, "
+				<< "and the number of steps to run." << endl;
+			return false;
+		}
+		
+		// Create a new pilot whose only ship is landed on the given planet.
+		PlayerInfo player;
+		player.New();
+		player.SetSeed(seed);
+		Random::Seed(seed);
+		shared_ptr<Ship> flagship(new Ship(*model));
+		flagship->SetSystem(system);
+		flagship->SetPlanet(planet);
+		flagship->SetGovernment(GameData::PlayerGovernment());
+		player.AddShip(flagship);
+		player.SetSystem(system);
+		player.SetPlanet(planet);
+		
+		// Create the NPCs the same way a mission does.
+		list<NPC> npcs;
+		map<string, string> subs;
+		for(const DataNode &child : node)
+			if(child.Token(0) == "npc")
+				npcs.push_back(NPC(child).Instantiate(subs, system, system));
+		
+		UI ui;
+		if(!player.TakeOff(&ui))
+		{
+			cerr << name << ": unable to take off." << endl;
+			return false;
+		}
+		int startShips = CountShips(npcs);
+		
+		// This is the same sequence that MainPanel follows when the player takes
+		// off, except that the NPCs are added as if they belonged to a mission.
+		Engine engine(player);
+		engine.Place();
+		engine.Place(npcs, player.FlagshipPtr());
+		
+		Allocations::Start();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		engine.Go();
+		for(int step = 1; step < steps; ++step)
+		{
+			engine.Wait();
+			engine.Step(true);
+			for(const ShipEvent &event : engine.Events())
+				player.HandleEvent(event, &ui);
+			engine.Events().clear();
+			if(step >= 1742 && step <= 1745 && getenv("DUMP")) engine.StateHash();
+			engine.Go();
+		}
+		engine.Wait();
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		Allocations::Stop();
+		
+		cout << name << ": " << steps << " steps in " << Format::Decimal(seconds, 2) << " s ("
+			<< Format::Decimal(steps / seconds, 1) << " steps per second), "
+			<< Format::Decimal(static_cast<double>(Allocations::Count()) / steps, 1) << " allocations and "
+			<< Allocations::Bytes() / steps << " bytes per step, "
+			<< startShips << " ships (" << CountShips(npcs) << " left), hash "
+			<< hex << setw(16) << setfill('0') << engine.StateHash() << dec << setfill(' ') << endl;
+		return true;
+	}
+}
+
+
+
+// Run every scenario in the given file whose name contains the given string,
+// and print how fast each one ran. Returns the exit code.
+int Scenario::Run(const string &path, const string &filter)
+{
+	if(!Files::Exists(path))
+	{
+		cerr << "Unable to find \"" << path << "\"." << endl;
+		return 1;
+	}
+	DataFile file(path);
+	isRunning = true;
+	
+	// Nothing will be drawn, but the sprites' sizes and masks are needed. The
+	// screen size determines what is put in the draw lists, so it is always
+	// the same rather than being read from the preferences.
+	Sprite::SetHeadless();
+	GameData::FinishLoading();
+	Preferences::Load();
+	Screen::SetRaw(1920, 1080);
+	
+	int count = 0;
+	bool failed = false;
+	for(const DataNode &node : file)
+	{
+		if(node.Token(0) != "scenario" || node.Size() < 2)
+		{
+			node.PrintTrace("Skipping unrecognized scenario attribute:");
+			continue;
+		}
+		if(node.Token(1).find(filter) == string::npos)
+			continue;
+		
+		++count;
+		failed |= !RunOne(node);
+	}
+	if(!count)
+	{
+		cerr << "No scenarios match \"" << filter << "\"." << endl;
+		return 1;
+	}
+	// Show what is still in memory after all the scenarios, to help find
+	// anything that is not freed when a pilot's flight ends.
+	Allocations::Report(cout);
+	return failed;
+}
+
+
+
+bool Scenario::IsRunning()
+{
+	return isRunning;
+}
@@ -0,0 +1,46 @@
+/* Scenario.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef SCENARIO_H_
+#define SCENARIO_H_
+
+#include <string>
+
+
+
+// Class for running the game engine on a situation described in a data file,
+// such as a large battle, without drawing anything or reading any input. This
+// is for measuring how fast the engine runs in the busiest situations the game
+// can get into. Each scenario creates a new pilot with a fixed random seed, so
+// the hash of the game state at the end shows whether a change to the engine
+// has changed the outcome. Scenarios are defined like this:
+//
+// scenario <name>
+//   system <system>
+//   planet <planet the player takes off from>
+//   flagship <ship model>
+//   seed <number>
+//   steps <number>
+//   npc ...
+//
+// where each "npc" is defined the same way as in a mission.
+class Scenario {
+public:
+	// Run every scenario in the given file whose name contains the given
+	// string, and print how fast each one ran. Returns the exit code.
+	static int Run(const std::string &path, const std::string &filter);
+	static bool IsRunning();
+};
+
+
+
+#endif
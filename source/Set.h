@@ -13,26 +13,50 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SET_H_
 #define SET_H_
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 
 
 // Template representing a set of named objects of a given type, where you can
 // query it for a pointer to any object and it will return one, whether or not that
-// object has been loaded yet. (This allows cyclic pointers.)
+// object has been loaded yet. (This allows cyclic pointers.) Objects are stored
+// in a map so that iterating over them gives them in sorted order, but lookups
+// by name go through a hash table. Each name is also given an integer handle
+// that never changes, which can be used to get the object without a lookup.
 template<class Type>
 class Set {
 public:
+	Set() = default;
+	// Copying a set must rebuild the index, since it points to the objects.
+	Set(const Set &other);
+	Set &operator=(const Set &other);
+	
 	// Allow non-const access to the owner of this set; it can hand off only
 	// const references to avoid anyone else modifying the objects.
-	Type *Get(const std::string &name) { return &data[name]; }
-	const Type *Get(const std::string &name) const { return &data[name]; }
+	Type *Get(const std::string &name) { return &entries[Insert(name)]->second; }
+	const Type *Get(const std::string &name) const { return &entries[Insert(name)]->second; }
 	// If an item already exists in this set, get it. Otherwise, return a null
 	// pointer rather than creating the item.
 	const Type *Find(const std::string &name) const;
 	
-	bool Has(const std::string &name) const { return data.count(name); }
+	bool Has(const std::string &name) const { return Find(name); }
+	
+	// Get the handle of the named object, creating the object if necessary.
+	// Handles are numbered from zero in the order that the names were first
+	// used. A name keeps its handle even if its object is erased and created
+	// again, so handles can be used to index arrays of information about the
+	// objects in this set.
+	int Handle(const std::string &name) const { return Insert(name); }
+	// Get the object with the given handle, or a null pointer if it was erased.
+	Type *FromHandle(int handle) { return entries[handle] ? &entries[handle]->second : nullptr; }
+	const Type *FromHandle(int handle) const { return entries[handle] ? &entries[handle]->second : nullptr; }
+	// Get the number of handles that have been given out.
+	int Handles() const { return entries.size(); }
 	
 	typename std::map<std::string, Type>::iterator begin() { return data.begin(); }
 	typename std::map<std::string, Type>::const_iterator begin() const { return data.begin(); }
@@ -40,48 +64,209 @@ public:
 	typename std::map<std::string, Type>::const_iterator end() const { return data.end(); }
 	
 	int size() const { return data.size(); }
-	// Remove any objects in this set that are not in the given set, and for
-	// those that are in the given set, revert to their contents.
-	void Revert(const Set<Type> &other);
+	// Remove the named object from this set. Any pointers to it become invalid.
+	void Erase(const std::string &name);
+	void Erase(int handle);
+	
+	// The hash function used for names. This is the 64-bit FNV-1a hash.
+	static uint64_t Hash(const std::string &name);
+	
+	
+private:
+	typedef std::pair<const std::string, Type> Entry;
+	
+	static const int EMPTY = -1;
+	
+	// A slot in the hash table, giving the handle of a name and its hash, so
+	// that most mismatches can be ruled out without comparing the names.
+	class Slot {
+	public:
+		uint64_t hash = 0;
+		int handle = EMPTY;
+	};
+	
+	// Get the name that the given handle was given to.
+	const std::string &Name(int handle) const;
+	// Find the handle of the given name, or return -1 if it has none.
+	int Lookup(const std::string &name, uint64_t hash) const;
+	// Get the handle of the named object, creating the object if it does not
+	// exist, and giving it a handle if it has none.
+	int Insert(const std::string &name) const;
+	// Add the given handle to the hash table, which must have room for it.
+	void Place(int handle, uint64_t hash) const;
+	// Rebuild the hash table with room for at least the given number of handles.
+	void Rehash(size_t capacity) const;
+	// Make this set a copy of the given one, including its handles.
+	void Copy(const Set &other);
 	
 	
 private:
 	mutable std::map<std::string, Type> data;
+	// The entry for each handle, or null if that object has been erased.
+	mutable std::vector<Entry *> entries;
+	// The names of the objects that have been erased, so that each one gets its
+	// handle back if it is created again. Because of that, there are never more
+	// handles than names that have been used.
+	mutable std::map<int, std::string> erased;
+	// Open addressing hash table with linear probing. Its size is always a
+	// power of two, and it is kept no more than half full.
+	mutable std::vector<Slot> index;
 };
 
 
 
+template <class Type>
+Set<Type>::Set(const Set &other)
+{
+	Copy(other);
+}
+
+
+
+template <class Type>
+Set<Type> &Set<Type>::operator=(const Set &other)
+{
+	if(this != &other)
+		Copy(other);
+	return *this;
+}
+
+
+
 template <class Type>
 const Type *Set<Type>::Find(const std::string &name) const
 {
-	auto it = data.find(name);
-	return (it == data.end() ? nullptr : &it->second);
+	int handle = Lookup(name, Hash(name));
+	return (handle < 0 ? nullptr : FromHandle(handle));
+}
+
+
+
+template <class Type>
+void Set<Type>::Erase(const std::string &name)
+{
+	int handle = Lookup(name, Hash(name));
+	if(handle >= 0)
+		Erase(handle);
 }
 
 
 
 template <class Type>
-void Set<Type>::Revert(const Set<Type> &other)
+void Set<Type>::Erase(int handle)
 {
-	auto it = data.begin();
-	auto oit = other.data.begin();
+	if(!entries[handle])
+		return;
 	
-	while(it != data.end())
+	// The handle stays in the hash table, so the name must be kept.
+	const std::string &name = erased[handle] = entries[handle]->first;
+	entries[handle] = nullptr;
+	data.erase(name);
+}
+
+
+
+template <class Type>
+uint64_t Set<Type>::Hash(const std::string &name)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for(char c : name)
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+	return hash;
+}
+
+
+
+template <class Type>
+const std::string &Set<Type>::Name(int handle) const
+{
+	return entries[handle] ? entries[handle]->first : erased.find(handle)->second;
+}
+
+
+
+template <class Type>
+int Set<Type>::Lookup(const std::string &name, uint64_t hash) const
+{
+	if(index.empty())
+		return -1;
+	
+	size_t mask = index.size() - 1;
+	for(size_t i = hash & mask; index[i].handle != EMPTY; i = (i + 1) & mask)
 	{
-		if(oit == other.data.end() || it->first < oit->first)
-			it = data.erase(it);
-		else if(it->first == oit->first)
-		{
-			// If this is an entry that is in the set we are reverting to, copy
-			// the state we are reverting to.
-			it->second = oit->second;
-			++it;
-			++oit;
-		}
-		
-		// There should never be a case when an entry in the set we are
-		// reverting to has a name that is not also in this set.
+		const Slot &slot = index[i];
+		if(slot.hash == hash && Name(slot.handle) == name)
+			return slot.handle;
 	}
+	return -1;
+}
+
+
+
+template <class Type>
+int Set<Type>::Insert(const std::string &name) const
+{
+	uint64_t hash = Hash(name);
+	int handle = Lookup(name, hash);
+	if(handle < 0)
+	{
+		if(2 * (entries.size() + 1) > index.size())
+			Rehash(entries.size() + 1);
+		handle = entries.size();
+		entries.push_back(nullptr);
+		Place(handle, hash);
+	}
+	else if(entries[handle])
+		return handle;
+	else
+		erased.erase(handle);
+	
+	entries[handle] = &*data.emplace(std::piecewise_construct,
+		std::forward_as_tuple(name), std::forward_as_tuple()).first;
+	return handle;
+}
+
+
+
+template <class Type>
+void Set<Type>::Place(int handle, uint64_t hash) const
+{
+	size_t mask = index.size() - 1;
+	size_t i = hash & mask;
+	while(index[i].handle != EMPTY)
+		i = (i + 1) & mask;
+	
+	index[i].hash = hash;
+	index[i].handle = handle;
+}
+
+
+
+template <class Type>
+void Set<Type>::Rehash(size_t capacity) const
+{
+	size_t size = 16;
+	while(size < 2 * capacity)
+		size *= 2;
+	index.assign(size, Slot());
+	
+	for(size_t i = 0; i < entries.size(); ++i)
+		Place(i, Hash(Name(i)));
+}
+
+
+
+template <class Type>
+void Set<Type>::Copy(const Set &other)
+{
+	data = other.data;
+	entries.assign(other.entries.size(), nullptr);
+	for(size_t i = 0; i < entries.size(); ++i)
+		if(other.entries[i])
+			entries[i] = &*data.find(other.entries[i]->first);
+	erased = other.erased;
+	// The handles are the same, so the hash table can be copied as it is.
+	index = other.index;
 }
 
 
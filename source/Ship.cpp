@@ -35,6 +35,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "StellarObject.h"
 #include "System.h"
 #include "Visual.h"
+#include "WellKnown.h"
 
 #include <algorithm>
 #include <cmath>
@@ -157,21 +158,21 @@ void Ship::Load(const DataNode &node)
 		else if(key == "attributes" || add)
 		{
 			if(!add)
-				baseAttributes.Load(child);
+				baseAttributes.Edit().Load(child);
 			else
 			{
 				addAttributes = true;
-				attributes.Load(child);
+				attributes.Edit().Load(child);
 			}
 		}
 		else if(key == "engine" && child.Size() >= 3)
 		{
 			if(!hasEngine)
 			{
-				enginePoints.clear();
+				enginePoints.Edit().clear();
 				hasEngine = true;
 			}
-			enginePoints.emplace_back(.5 * child.Value(1), .5 * child.Value(2),
+			enginePoints.Edit().emplace_back(.5 * child.Value(1), .5 * child.Value(2),
 				(child.Size() > 3 ? child.Value(3) : 1.));
 		}
 		else if(key == "gun" || key == "turret")
@@ -244,7 +245,7 @@ void Ship::Load(const DataNode &node)
 		{
 			if(!hasLeak)
 			{
-				leaks.clear();
+				leaks.Edit().clear();
 				hasLeak = true;
 			}
 			Leak leak(GameData::Effects().Get(child.Token(1)));
@@ -252,42 +253,42 @@ void Ship::Load(const DataNode &node)
 				leak.openPeriod = child.Value(2);
 			if(child.Size() >= 4)
 				leak.closePeriod = child.Value(3);
-			leaks.push_back(leak);
+			leaks.Edit().push_back(leak);
 		}
 		else if(key == "explode" && child.Size() >= 2)
 		{
 			if(!hasExplode)
 			{
-				explosionEffects.clear();
+				explosionEffects.Edit().clear();
 				explosionTotal = 0;
 				hasExplode = true;
 			}
 			int count = (child.Size() >= 3) ? child.Value(2) : 1;
-			explosionEffects[GameData::Effects().Get(child.Token(1))] += count;
+			explosionEffects.Edit()[GameData::Effects().Get(child.Token(1))] += count;
 			explosionTotal += count;
 		}
 		else if(key == "final explode" && child.Size() >= 2)
 		{
 			if(!hasFinalExplode)
 			{
-				finalExplosions.clear();
+				finalExplosions.Edit().clear();
 				hasFinalExplode = true;
 			}
 			int count = (child.Size() >= 3) ? child.Value(2) : 1;
-			finalExplosions[GameData::Effects().Get(child.Token(1))] += count;
+			finalExplosions.Edit()[GameData::Effects().Get(child.Token(1))] += count;
 		}
 		else if(key == "outfits")
 		{
 			if(!hasOutfits)
 			{
-				outfits.clear();
+				outfits.Edit().clear();
 				hasOutfits = true;
 			}
 			for(const DataNode &grand : child)
 			{
 				int count = (grand.Size() >= 2) ? grand.Value(1) : 1;
 				if(count > 0)
-					outfits[GameData::Outfits().Get(grand.Token(0))] += count;
+					outfits.Edit()[GameData::Outfits().Get(grand.Token(0))] += count;
 				else
 					grand.PrintTrace("Skipping invalid outfit count:");
 			}
@@ -319,11 +320,11 @@ void Ship::Load(const DataNode &node)
 		{
 			if(!hasDescription)
 			{
-				description.clear();
+				description.Edit().clear();
 				hasDescription = true;
 			}
-			description += child.Token(1);
-			description += '\n';
+			description.Edit() += child.Token(1);
+			description.Edit() += '\n';
 		}
 		else if(key != "actions")
 			child.PrintTrace("Skipping unrecognized attribute:");
@@ -360,22 +361,22 @@ void Ship::FinishLoading(bool isNewInstance)
 			reinterpret_cast<Body &>(*this) = *base;
 		if(customSwizzle == -1)
 			customSwizzle = base->CustomSwizzle();
-		if(baseAttributes.Attributes().empty())
+		if(baseAttributes->Attributes().empty())
 			baseAttributes = base->baseAttributes;
 		if(bays.empty() && !base->bays.empty())
 			bays = base->bays;
-		if(enginePoints.empty())
+		if(enginePoints->empty())
 			enginePoints = base->enginePoints;
-		if(explosionEffects.empty())
+		if(explosionEffects->empty())
 		{
 			explosionEffects = base->explosionEffects;
 			explosionTotal = base->explosionTotal;
 		}
-		if(finalExplosions.empty())
+		if(finalExplosions->empty())
 			finalExplosions = base->finalExplosions;
-		if(outfits.empty())
+		if(outfits->empty())
 			outfits = base->outfits;
-		if(description.empty())
+		if(description->empty())
 			description = base->description;
 		
 		bool hasHardpoints = false;
@@ -432,7 +433,7 @@ void Ship::FinishLoading(bool isNewInstance)
 	// warn if any non-weapon outfits are "installed" in a hardpoint.
 	for(auto &it : equipped)
 	{
-		int excess = it.second - outfits[it.first];
+		int excess = it.second - outfits.Edit()[it.first];
 		if(excess > 0)
 		{
 			// If there are more hardpoints specifying this outfit than there
@@ -461,29 +462,29 @@ void Ship::FinishLoading(bool isNewInstance)
 	
 	// Mark any drone that has no "automaton" value as an automaton, to
 	// grandfather in the drones from before that attribute existed.
-	if(baseAttributes.Category() == "Drone" && !baseAttributes.Get("automaton"))
-		baseAttributes.Set("automaton", 1.);
+	if(baseAttributes->Category() == "Drone" && !baseAttributes->Get("automaton"))
+		baseAttributes.Edit().Set("automaton", 1.);
 	
-	baseAttributes.Set("gun ports", armament.GunCount());
-	baseAttributes.Set("turret mounts", armament.TurretCount());
+	baseAttributes.Edit().Set("gun ports", armament.GunCount());
+	baseAttributes.Edit().Set("turret mounts", armament.TurretCount());
 	
 	if(addAttributes)
 	{
 		// Store attributes from an "add attributes" node in the ship's
 		// baseAttributes so they can be written to the save file.
-		baseAttributes.Add(attributes);
+		baseAttributes.Edit().Add(*attributes);
 		addAttributes = false;
 	}
 	// Add the attributes of all your outfits to the ship's base attributes.
 	attributes = baseAttributes;
-	for(const auto &it : outfits)
+	for(const auto &it : *outfits)
 	{
 		if(it.first->Name().empty())
 		{
 			Files::LogError("Unrecognized outfit in " + modelName + " \"" + name + "\"");
 			continue;
 		}
-		attributes.Add(*it.first, it.second);
+		attributes.Edit().Add(*it.first, it.second);
 		// Some ship variant definitions do not specify which weapons
 		// are placed in which hardpoint. Add any weapons that are not
 		// yet installed to the ship's armament.
@@ -516,7 +517,7 @@ void Ship::FinishLoading(bool isNewInstance)
 			Files::LogError(warning);
 		}
 	}
-	cargo.SetSize(attributes.Get("cargo space"));
+	cargo.SetSize(attributes->Get("cargo space"));
 	equipped.clear();
 	armament.FinishLoading();
 	
@@ -533,17 +534,17 @@ void Ship::FinishLoading(bool isNewInstance)
 	// Add a default "launch effect" to any internal bays if this ship is crewed (i.e. pressurized).
 	for(Bay &bay : bays)
 		if(bay.side == Bay::INSIDE && bay.launchEffects.empty() && Crew())
-			bay.launchEffects.emplace_back(GameData::Effects().Get("basic launch"));
+			bay.launchEffects.emplace_back(WellKnown::Get(WellKnown::BASIC_LAUNCH));
 	
 	// Figure out if this ship can be carried.
-	const string &category = attributes.Category();
+	const string &category = attributes->Category();
 	canBeCarried = (category == "Fighter" || category == "Drone");
 	
 	// Issue warnings if this ship has negative outfit, cargo, weapon, or engine capacity.
 	string warning;
 	for(const string &attr : set<string>{"outfit space", "cargo space", "weapon capacity", "engine capacity"})
 	{
-		double val = attributes.Get(attr);
+		double val = attributes->Get(attr);
 		if(val < 0)
 			warning += attr + ": " + Format::Number(val) + "\n";
 	}
@@ -553,7 +554,7 @@ void Ship::FinishLoading(bool isNewInstance)
 		// no names. Print the outfits to facilitate identifying this ship definition.
 		string message = (!name.empty() ? "Ship \"" + name + "\" " : "") + "(" + modelName + "):\n";
 		ostringstream outfitNames("outfits:\n");
-		for(const auto &it : outfits)
+		for(const auto &it : *outfits)
 			outfitNames << '\t' << it.second << " " + it.first->Name() << endl;
 		Files::LogError(message + warning + outfitNames.str());
 	}
@@ -589,19 +590,19 @@ void Ship::Save(DataWriter &out) const
 		out.Write("attributes");
 		out.BeginChild();
 		{
-			out.Write("category", baseAttributes.Category());
-			out.Write("cost", baseAttributes.Cost());
-			out.Write("mass", baseAttributes.Mass());
-			for(const auto &it : baseAttributes.FlareSprites())
+			out.Write("category", baseAttributes->Category());
+			out.Write("cost", baseAttributes->Cost());
+			out.Write("mass", baseAttributes->Mass());
+			for(const auto &it : baseAttributes->FlareSprites())
 				for(int i = 0; i < it.second; ++i)
 					it.first.SaveSprite(out, "flare sprite");
-			for(const auto &it : baseAttributes.FlareSounds())
+			for(const auto &it : baseAttributes->FlareSounds())
 				for(int i = 0; i < it.second; ++i)
 					out.Write("flare sound", it.first->Name());
-			for(const auto &it : baseAttributes.AfterburnerEffects())
+			for(const auto &it : baseAttributes->AfterburnerEffects())
 				for(int i = 0; i < it.second; ++i)
 					out.Write("afterburner effect", it.first->Name());
-			for(const auto &it : baseAttributes.Attributes())
+			for(const auto &it : baseAttributes->Attributes())
 				if(it.second)
 					out.Write(it.first, it.second);
 		}
@@ -610,7 +611,7 @@ void Ship::Save(DataWriter &out) const
 		out.Write("outfits");
 		out.BeginChild();
 		{
-			for(const auto &it : outfits)
+			for(const auto &it : *outfits)
 				if(it.first && it.second)
 				{
 					if(it.second == 1)
@@ -628,7 +629,7 @@ void Ship::Save(DataWriter &out) const
 		out.Write("hull", hull);
 		out.Write("position", position.X(), position.Y());
 		
-		for(const EnginePoint &point : enginePoints)
+		for(const EnginePoint &point : *enginePoints)
 			out.Write("engine", 2. * point.X(), 2. * point.Y(), point.Zoom());
 		for(const Hardpoint &hardpoint : armament.Get())
 		{
@@ -661,12 +662,12 @@ void Ship::Save(DataWriter &out) const
 				out.EndChild();
 			}
 		}
-		for(const Leak &leak : leaks)
+		for(const Leak &leak : *leaks)
 			out.Write("leak", leak.effect->Name(), leak.openPeriod, leak.closePeriod);
-		for(const auto &it : explosionEffects)
+		for(const auto &it : *explosionEffects)
 			if(it.first && it.second)
 				out.Write("explode", it.first->Name(), it.second);
-		for(const auto &it : finalExplosions)
+		for(const auto &it : *finalExplosions)
 			if(it.first && it.second)
 				out.Write("final explode", it.first->Name(), it.second);
 		
@@ -723,7 +724,7 @@ const string &Ship::Noun() const
 // Get this ship's description.
 const string &Ship::Description() const
 {
-	return description;
+	return *description;
 }
 
 
@@ -739,7 +740,7 @@ const Sprite *Ship::Thumbnail() const
 // Get this ship's cost.
 int64_t Ship::Cost() const
 {
-	return attributes.Cost();
+	return attributes->Cost();
 }
 
 
@@ -747,7 +748,7 @@ int64_t Ship::Cost() const
 // Get the cost of this ship's chassis, with no outfits installed.
 int64_t Ship::ChassisCost() const
 {
-	return baseAttributes.Cost();
+	return baseAttributes->Cost();
 }
 
 
@@ -756,22 +757,22 @@ int64_t Ship::ChassisCost() const
 // or impossible to fly.
 string Ship::FlightCheck() const
 {
-	double generation = attributes.Get("energy generation") - attributes.Get("energy consumption");
-	double burning = attributes.Get("fuel energy");
-	double solar = attributes.Get("solar collection");
-	double battery = attributes.Get("energy capacity");
+	double generation = attributes->Get("energy generation") - attributes->Get("energy consumption");
+	double burning = attributes->Get("fuel energy");
+	double solar = attributes->Get("solar collection");
+	double battery = attributes->Get("energy capacity");
 	double energy = generation + burning + solar + battery;
-	double fuelChange = attributes.Get("fuel generation") - attributes.Get("fuel consumption");
-	double fuelCapacity = attributes.Get("fuel capacity");
+	double fuelChange = attributes->Get("fuel generation") - attributes->Get("fuel consumption");
+	double fuelCapacity = attributes->Get("fuel capacity");
 	double fuel = fuelCapacity + fuelChange;
-	double thrust = attributes.Get("thrust");
-	double reverseThrust = attributes.Get("reverse thrust");
-	double afterburner = attributes.Get("afterburner thrust");
-	double thrustEnergy = attributes.Get("thrusting energy");
-	double turn = attributes.Get("turn");
-	double turnEnergy = attributes.Get("turning energy");
-	double hyperDrive = attributes.Get("hyperdrive");
-	double jumpDrive = attributes.Get("jump drive");
+	double thrust = attributes->Get("thrust");
+	double reverseThrust = attributes->Get("reverse thrust");
+	double afterburner = attributes->Get("afterburner thrust");
+	double thrustEnergy = attributes->Get("thrusting energy");
+	double turn = attributes->Get("turn");
+	double turnEnergy = attributes->Get("turning energy");
+	double hyperDrive = attributes->Get("hyperdrive");
+	double jumpDrive = attributes->Get("jump drive");
 	
 	// Error conditions:
 	if(IdleHeat() >= MaximumHeat())
@@ -807,7 +808,7 @@ string Ship::FlightCheck() const
 		if(fuelCapacity < JumpFuel())
 			return "no fuel?";
 	}
-	for(const auto &it : outfits)
+	for(const auto &it : *outfits)
 		if(it.first->IsWeapon() && it.first->FiringEnergy() > energy)
 			return "insufficient energy to fire?";
 	
@@ -829,6 +830,7 @@ void Ship::Place(Point position, Point velocity, Angle angle)
 	this->position = position;
 	this->velocity = velocity;
 	this->angle = angle;
+	randomKey = Random::Key();
 	
 	// If landed, place the ship right above the planet.
 	// Escorts should take off a bit behind their flagships.
@@ -903,6 +905,14 @@ bool Ship::IsSpecial() const
 
 
 
+// Get the key that identifies this ship's random number streams.
+uint64_t Ship::RandomKey() const
+{
+	return randomKey;
+}
+
+
+
 void Ship::SetIsYours(bool yours)
 {
 	isYours = yours;
@@ -1003,7 +1013,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		return;
 	}
 	isInSystem = false;
-	if(!fuel || !(attributes.Get("hyperdrive") || attributes.Get("jump drive")))
+	if(!fuel || !(attributes->Get("hyperdrive") || attributes->Get("jump drive")))
 		hyperspaceSystem = nullptr;
 	
 	// Adjust the error in the pilot's targeting.
@@ -1014,11 +1024,11 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 
 	// Handle ionization effects, etc.
 	if(ionization)
-		CreateSparks(visuals, "ion spark", ionization * .1);
+		CreateSparks(visuals, WellKnown::Get(WellKnown::ION_SPARK), ionization * .1);
 	if(disruption)
-		CreateSparks(visuals, "disruption spark", disruption * .1);
+		CreateSparks(visuals, WellKnown::Get(WellKnown::DISRUPTION_SPARK), disruption * .1);
 	if(slowness)
-		CreateSparks(visuals, "slowing spark", slowness * .1);
+		CreateSparks(visuals, WellKnown::Get(WellKnown::SLOWING_SPARK), slowness * .1);
 	// Jettisoned cargo effects (only for ships in the current system).
 	if(!jettisoned.empty() && !forget)
 	{
@@ -1039,16 +1049,16 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		if(!cloak)
 			cloakDisruption = max(0., cloakDisruption - 1.);
 		
-		double cloakingSpeed = attributes.Get("cloak");
+		double cloakingSpeed = attributes->Get("cloak");
 		bool canCloak = (!isDisabled && cloakingSpeed > 0. && !cloakDisruption
-			&& fuel >= attributes.Get("cloaking fuel")
-			&& energy >= attributes.Get("cloaking energy"));
+			&& fuel >= attributes->Get("cloaking fuel")
+			&& energy >= attributes->Get("cloaking energy"));
 		if(commands.Has(Command::CLOAK) && canCloak)
 		{
 			cloak = min(1., cloak + cloakingSpeed);
-			fuel -= attributes.Get("cloaking fuel");
-			energy -= attributes.Get("cloaking energy");
-			heat += attributes.Get("cloaking heat");
+			fuel -= attributes->Get("cloaking fuel");
+			energy -= attributes->Get("cloaking energy");
+			heat += attributes->Get("cloaking heat");
 		}
 		else if(cloakingSpeed)
 		{
@@ -1073,11 +1083,11 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		{
 			if(!forget)
 			{
-				const Effect *effect = GameData::Effects().Get("smoke");
+				const Effect *effect = WellKnown::Get(WellKnown::SMOKE);
 				double size = Width() + Height();
 				double scale = .03 * size + .5;
 				double radius = .2 * size;
-				int debrisCount = attributes.Mass() * .07;
+				int debrisCount = attributes->Mass() * .07;
 				for(int i = 0; i < debrisCount; ++i)
 				{
 					Angle angle = Angle::Random();
@@ -1089,7 +1099,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 					
 				for(unsigned i = 0; i < explosionTotal / 2; ++i)
 					CreateExplosion(visuals, true);
-				for(const auto &it : finalExplosions)
+				for(const auto &it : *finalExplosions)
 					visuals.emplace_back(*it.first, position, velocity, angle);
 				// For everything in this ship's cargo hold there is a 25% chance
 				// that it will survive as flotsam.
@@ -1098,7 +1108,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				for(const auto &it : cargo.Outfits())
 					Jettison(it.first, Random::Binomial(it.second, .25));
 				// Ammunition has a 5% chance to survive as flotsam
-				for(const auto &it : outfits)
+				for(const auto &it : *outfits)
 					if(it.first->Category() == "Ammunition")
 						Jettison(it.first, Random::Binomial(it.second, .05));
 				for(shared_ptr<Flotsam> &it : jettisoned)
@@ -1125,7 +1135,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 			CreateExplosion(visuals);
 		
 		// Handle hull "leaks."
-		for(const Leak &leak : leaks)
+		for(const Leak &leak : *leaks)
 			if(leak.openPeriod > 0 && !Random::Int(leak.openPeriod))
 			{
 				activeLeaks.push_back(leak);
@@ -1169,7 +1179,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		// Create the particle effects for the jump drive. This may create 100
 		// or more particles per ship per turn at the peak of the jump.
 		if(isUsingJumpDrive && !forget)
-			CreateSparks(visuals, "jump drive", hyperspaceCount * Width() * Height() * .000006);
+			CreateSparks(visuals, WellKnown::Get(WellKnown::JUMP_DRIVE_SPARK), hyperspaceCount * Width() * Height() * .000006);
 		
 		if(hyperspaceCount == HYPER_C)
 		{
@@ -1304,7 +1314,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 			}
 		}
 		// Only refuel if this planet has a spaceport.
-		else if(fuel >= attributes.Get("fuel capacity")
+		else if(fuel >= attributes->Get("fuel capacity")
 				|| !landingPlanet || !landingPlanet->HasSpaceport())
 		{
 			zoom = min(1.f, zoom + .02f);
@@ -1312,7 +1322,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 			landingPlanet = nullptr;
 		}
 		else
-			fuel = min(fuel + 1., attributes.Get("fuel capacity"));
+			fuel = min(fuel + 1., attributes->Get("fuel capacity"));
 		
 		// Move the ship at the velocity it had when it began landing, but
 		// scaled based on how small it is now.
@@ -1330,7 +1340,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	else if(commands.Has(Command::JUMP) && IsReadyToJump())
 	{
 		hyperspaceSystem = GetTargetSystem();
-		isUsingJumpDrive = !attributes.Get("hyperdrive") || !currentSystem->Links().count(hyperspaceSystem);
+		isUsingJumpDrive = !attributes->Get("hyperdrive") || !currentSystem->Links().count(hyperspaceSystem);
 		hyperspaceFuelCost = JumpFuel(hyperspaceSystem);
 	}
 	
@@ -1357,13 +1367,13 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	// disabled, all it can do is slow down to a stop.
 	double mass = Mass();
 	if(isDisabled)
-		velocity *= 1. - attributes.Get("drag") / mass;
+		velocity *= 1. - attributes->Get("drag") / mass;
 	else if(!pilotError)
 	{
 		if(commands.Turn())
 		{
 			// Check if we are able to turn.
-			double cost = attributes.Get("turning energy");
+			double cost = attributes->Get("turning energy");
 			if(energy < cost * fabs(commands.Turn()))
 				commands.SetTurn(commands.Turn() * energy / (cost * fabs(commands.Turn())));
 			
@@ -1374,7 +1384,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				// of the turning energy and produce a fraction of the heat.
 				double scale = fabs(commands.Turn());
 				energy -= scale * cost;
-				heat += scale * attributes.Get("turning heat");
+				heat += scale * attributes->Get("turning heat");
 				angle += commands.Turn() * TurnRate() * slowMultiplier;
 			}
 		}
@@ -1383,7 +1393,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 		if(thrustCommand)
 		{
 			// Check if we are able to apply this thrust.
-			double cost = attributes.Get((thrustCommand > 0.) ?
+			double cost = attributes->Get((thrustCommand > 0.) ?
 				"thrusting energy" : "reverse thrusting energy");
 			if(energy < cost)
 				thrustCommand *= energy / cost;
@@ -1393,12 +1403,12 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				// If a reverse thrust is commanded and the capability does not
 				// exist, ignore it (do not even slow under drag).
 				isThrusting = (thrustCommand > 0.);
-				thrust = attributes.Get(isThrusting ? "thrust" : "reverse thrust");
+				thrust = attributes->Get(isThrusting ? "thrust" : "reverse thrust");
 				if(thrust)
 				{
 					double scale = fabs(thrustCommand);
 					energy -= scale * cost;
-					heat += scale * attributes.Get(isThrusting ? "thrusting heat" : "reverse thrusting heat");
+					heat += scale * attributes->Get(isThrusting ? "thrusting heat" : "reverse thrusting heat");
 					acceleration += angle.Unit() * (thrustCommand * thrust / mass);
 				}
 			}
@@ -1407,21 +1417,21 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 				&& !CannotAct();
 		if(applyAfterburner)
 		{
-			thrust = attributes.Get("afterburner thrust");
-			double fuelCost = attributes.Get("afterburner fuel");
-			double energyCost = attributes.Get("afterburner energy");
+			thrust = attributes->Get("afterburner thrust");
+			double fuelCost = attributes->Get("afterburner fuel");
+			double energyCost = attributes->Get("afterburner energy");
 			if(thrust && fuel >= fuelCost && energy >= energyCost)
 			{
-				heat += attributes.Get("afterburner heat");
+				heat += attributes->Get("afterburner heat");
 				fuel -= fuelCost;
 				energy -= energyCost;
 				acceleration += angle.Unit() * thrust / mass;
 				
 				if(!forget)
-					for(const EnginePoint &point : enginePoints)
+					for(const EnginePoint &point : *enginePoints)
 					{
 						Point pos = angle.Rotate(point) * Zoom() + position;
-						for(const auto &it : attributes.AfterburnerEffects())
+						for(const auto &it : attributes->AfterburnerEffects())
 							for(int i = 0; i < it.second; ++i)
 								visuals.emplace_back(*it.first,
 									pos + velocity, velocity - 6. * angle.Unit(), angle);
@@ -1432,7 +1442,7 @@ void Ship::Move(vector<Visual> &visuals, list<shared_ptr<Flotsam>> &flotsam)
 	if(acceleration)
 	{
 		acceleration *= slowMultiplier;
-		Point dragAcceleration = acceleration - velocity * (attributes.Get("drag") / mass);
+		Point dragAcceleration = acceleration - velocity * (attributes->Get("drag") / mass);
 		// Make sure dragAcceleration has nonzero length, to avoid divide by zero.
 		if(dragAcceleration)
 		{
@@ -1559,19 +1569,19 @@ void Ship::DoGeneration()
 		// 4. Shields of carried fighters
 		// 5. Transfer of excess energy and fuel to carried fighters.
 		
-		const double hullAvailable = attributes.Get("hull repair rate");
-		const double hullEnergy = attributes.Get("hull energy") / hullAvailable;
-		const double hullFuel = attributes.Get("hull fuel") / hullAvailable;
-		const double hullHeat = attributes.Get("hull heat") / hullAvailable;
+		const double hullAvailable = attributes->Get("hull repair rate");
+		const double hullEnergy = attributes->Get("hull energy") / hullAvailable;
+		const double hullFuel = attributes->Get("hull fuel") / hullAvailable;
+		const double hullHeat = attributes->Get("hull heat") / hullAvailable;
 		double hullRemaining = hullAvailable;
-		DoRepair(hull, hullRemaining, attributes.Get("hull"), energy, hullEnergy, fuel, hullFuel);
+		DoRepair(hull, hullRemaining, attributes->Get("hull"), energy, hullEnergy, fuel, hullFuel);
 		
-		const double shieldsAvailable = attributes.Get("shield generation");
-		const double shieldsEnergy = attributes.Get("shield energy") / shieldsAvailable;
-		const double shieldsFuel = attributes.Get("shield fuel") / shieldsAvailable;
-		const double shieldsHeat = attributes.Get("shield heat") / shieldsAvailable;
+		const double shieldsAvailable = attributes->Get("shield generation");
+		const double shieldsEnergy = attributes->Get("shield energy") / shieldsAvailable;
+		const double shieldsFuel = attributes->Get("shield fuel") / shieldsAvailable;
+		const double shieldsHeat = attributes->Get("shield heat") / shieldsAvailable;
 		double shieldsRemaining = shieldsAvailable;
-		DoRepair(shields, shieldsRemaining, attributes.Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
+		DoRepair(shields, shieldsRemaining, attributes->Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
 		
 		if(!bays.empty())
 		{
@@ -1598,19 +1608,19 @@ void Ship::DoGeneration()
 			for(const pair<double, Ship *> &it : carried)
 			{
 				Ship &ship = *it.second;
-				DoRepair(ship.hull, hullRemaining, ship.attributes.Get("hull"), energy, hullEnergy, fuel, hullFuel);
-				DoRepair(ship.shields, shieldsRemaining, ship.attributes.Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
+				DoRepair(ship.hull, hullRemaining, ship.attributes->Get("hull"), energy, hullEnergy, fuel, hullFuel);
+				DoRepair(ship.shields, shieldsRemaining, ship.attributes->Get("shields"), energy, shieldsEnergy, fuel, shieldsFuel);
 			}
 			
 			// Now that there is no more need to use energy for hull and shield
 			// repair, if there is still excess energy, transfer it.
-			double energyRemaining = min(0., energy - attributes.Get("energy capacity"));
-			double fuelRemaining = min(0., fuel - attributes.Get("fuel capacity"));
+			double energyRemaining = min(0., energy - attributes->Get("energy capacity"));
+			double fuelRemaining = min(0., fuel - attributes->Get("fuel capacity"));
 			for(const pair<double, Ship *> &it : carried)
 			{
 				Ship &ship = *it.second;
-				DoRepair(ship.energy, energyRemaining, ship.attributes.Get("energy capacity"));
-				DoRepair(ship.fuel, fuelRemaining, ship.attributes.Get("fuel capacity"));
+				DoRepair(ship.energy, energyRemaining, ship.attributes->Get("energy capacity"));
+				DoRepair(ship.fuel, fuelRemaining, ship.attributes->Get("fuel capacity"));
 			}
 		}
 		
@@ -1624,18 +1634,18 @@ void Ship::DoGeneration()
 	}
 	// Handle ionization effects, etc.
 	if(ionization)
-		ionization = max(0., .99 * ionization - attributes.Get("ion resistance"));
+		ionization = max(0., .99 * ionization - attributes->Get("ion resistance"));
 	if(disruption)
-		disruption = max(0., .99 * disruption - attributes.Get("disruption resistance"));
+		disruption = max(0., .99 * disruption - attributes->Get("disruption resistance"));
 	if(slowness)
-		slowness = max(0., .99 * slowness - attributes.Get("slowing resistance"));
+		slowness = max(0., .99 * slowness - attributes->Get("slowing resistance"));
 	
 	// When ships recharge, what actually happens is that they can exceed their
 	// maximum capacity for the rest of the turn, but must be clamped to the
 	// maximum here before they gain more. This is so that, for example, a ship
 	// with no batteries but a good generator can still move.
-	energy = min(energy, attributes.Get("energy capacity"));
-	fuel = min(fuel, attributes.Get("fuel capacity"));
+	energy = min(energy, attributes->Get("energy capacity"));
+	fuel = min(fuel, attributes->Get("fuel capacity"));
 	
 	heat -= heat * HeatDissipation();
 	if(heat > MaximumHeat())
@@ -1643,9 +1653,9 @@ void Ship::DoGeneration()
 	else if(heat < .9 * MaximumHeat())
 		isOverheated = false;
 	
-	double maxShields = attributes.Get("shields");
+	double maxShields = attributes->Get("shields");
 	shields = min(shields, maxShields);
-	double maxHull = attributes.Get("hull");
+	double maxHull = attributes->Get("hull");
 	hull = min(hull, maxHull);
 	
 	isDisabled = isOverheated || hull < MinimumHull() || (!crew && RequiredCrew());
@@ -1670,34 +1680,34 @@ void Ship::DoGeneration()
 		if(currentSystem)
 		{
 			double scale = .2 + 1.8 / (.001 * position.Length() + 1);
-			fuel += currentSystem->SolarWind() * .03 * scale * (sqrt(attributes.Get("ramscoop")) + .05 * scale);
+			fuel += currentSystem->SolarWind() * .03 * scale * (sqrt(attributes->Get("ramscoop")) + .05 * scale);
 		
-			energy += currentSystem->SolarPower() * scale * attributes.Get("solar collection");
+			energy += currentSystem->SolarPower() * scale * attributes->Get("solar collection");
 		}
 		
 		double coolingEfficiency = CoolingEfficiency();
-		energy += attributes.Get("energy generation") - attributes.Get("energy consumption");
+		energy += attributes->Get("energy generation") - attributes->Get("energy consumption");
 		energy -= ionization;
-		fuel += attributes.Get("fuel generation");
-		heat += attributes.Get("heat generation");
-		heat -= coolingEfficiency * attributes.Get("cooling");
+		fuel += attributes->Get("fuel generation");
+		heat += attributes->Get("heat generation");
+		heat -= coolingEfficiency * attributes->Get("cooling");
 		
 		// Convert fuel into energy and heat only when the required amount of fuel is available.
-		if(attributes.Get("fuel consumption") <= fuel)
+		if(attributes->Get("fuel consumption") <= fuel)
 		{	
-			fuel -= attributes.Get("fuel consumption");
-			energy += attributes.Get("fuel energy");
-			heat += attributes.Get("fuel heat");
+			fuel -= attributes->Get("fuel consumption");
+			energy += attributes->Get("fuel energy");
+			heat += attributes->Get("fuel heat");
 		}
 		
 		// Apply active cooling. The fraction of full cooling to apply equals
 		// your ship's current fraction of its maximum temperature.
-		double activeCooling = coolingEfficiency * attributes.Get("active cooling");
+		double activeCooling = coolingEfficiency * attributes->Get("active cooling");
 		if(activeCooling > 0. && heat > 0.)
 		{
 			// Although it's a misuse of this feature, handle the case where
 			// "active cooling" does not require any energy.
-			double coolingEnergy = attributes.Get("cooling energy");
+			double coolingEnergy = attributes->Get("cooling energy");
 			if(coolingEnergy)
 			{
 				double spentEnergy = min(energy, coolingEnergy * min(1., Heat()));
@@ -1738,7 +1748,7 @@ void Ship::Launch(list<shared_ptr<Ship>> &ships, vector<Visual> &visuals)
 				
 				// This ship will refuel naturally based on the carrier's fuel
 				// collection, but the carrier may have some reserves to spare.
-				double maxFuel = bay.ship->attributes.Get("fuel capacity");
+				double maxFuel = bay.ship->attributes->Get("fuel capacity");
 				if(maxFuel)
 				{
 					double spareFuel = fuel - JumpFuel();
@@ -1855,8 +1865,8 @@ int Ship::Scan()
 		return 0;
 	
 	// The range of a scanner is proportional to the square root of its power.
-	double cargoDistance = 100. * sqrt(attributes.Get("cargo scan power"));
-	double outfitDistance = 100. * sqrt(attributes.Get("outfit scan power"));
+	double cargoDistance = 100. * sqrt(attributes->Get("cargo scan power"));
+	double outfitDistance = 100. * sqrt(attributes->Get("outfit scan power"));
 	
 	// Bail out if this ship has no scanners.
 	if(!cargoDistance && !outfitDistance)
@@ -1864,10 +1874,10 @@ int Ship::Scan()
 	
 	// Scanning speed also uses a square root, so you need four scanners to get
 	// twice the speed out of them.
-	double cargoSpeed = sqrt(attributes.Get("cargo scan speed"));
+	double cargoSpeed = sqrt(attributes->Get("cargo scan speed"));
 	if(!cargoSpeed)
 		cargoSpeed = 1.;
-	double outfitSpeed = sqrt(attributes.Get("outfit scan speed"));
+	double outfitSpeed = sqrt(attributes->Get("outfit scan speed"));
 	if(!outfitSpeed)
 		outfitSpeed = 1.;
 	
@@ -1895,7 +1905,7 @@ int Ship::Scan()
 	
 	// Play the scanning sound if the actor or the target is the player's ship.
 	if(isYours || (target->isYours && activeScanning))
-		Audio::Play(Audio::Get("scan"), Position());
+		Audio::Play(WellKnown::Get(WellKnown::SCAN), Position());
 	
 	if(startedScanning && isYours)
 	{
@@ -2127,8 +2137,8 @@ bool Ship::IsReadyToJump(bool waitingIsReady) const
 		return false;
 	
 	Point direction = targetSystem->Position() - currentSystem->Position();
-	bool isJump = !attributes.Get("hyperdrive") || !currentSystem->Links().count(targetSystem);
-	double scramThreshold = attributes.Get("scram drive");
+	bool isJump = !attributes->Get("hyperdrive") || !currentSystem->Links().count(targetSystem);
+	double scramThreshold = attributes->Get("scram drive");
 	
 	// The ship can only enter hyperspace if it is traveling slowly enough
 	// and pointed in the right direction.
@@ -2138,7 +2148,7 @@ bool Ship::IsReadyToJump(bool waitingIsReady) const
 		if(deviation > scramThreshold)
 			return false;
 	}
-	else if(velocity.Length() > attributes.Get("jump speed"))
+	else if(velocity.Length() > attributes->Get("jump speed"))
 		return false;
 	
 	if(!isJump)
@@ -2175,7 +2185,7 @@ bool Ship::IsThrusting() const
 // Get the points from which engine flares should be drawn.
 const vector<Ship::EnginePoint> &Ship::EnginePoints() const
 {
-	return enginePoints;
+	return *enginePoints;
 }
 
 
@@ -2235,18 +2245,18 @@ void Ship::Recharge(bool atSpaceport)
 	
 	if(atSpaceport)
 	{
-		crew = min<int>(max(crew, RequiredCrew()), attributes.Get("bunks"));
-		fuel = attributes.Get("fuel capacity");
+		crew = min<int>(max(crew, RequiredCrew()), attributes->Get("bunks"));
+		fuel = attributes->Get("fuel capacity");
 	}
 	pilotError = 0;
 	pilotOkay = 0;
 	
-	if(atSpaceport || attributes.Get("shield generation"))
-		shields = attributes.Get("shields");
-	if(atSpaceport || attributes.Get("hull repair rate"))
-		hull = attributes.Get("hull");
-	if(atSpaceport || attributes.Get("energy generation"))
-		energy = attributes.Get("energy capacity");
+	if(atSpaceport || attributes->Get("shield generation"))
+		shields = attributes->Get("shields");
+	if(atSpaceport || attributes->Get("hull repair rate"))
+		hull = attributes->Get("hull");
+	if(atSpaceport || attributes->Get("energy generation"))
+		energy = attributes->Get("energy capacity");
 	
 	heat = IdleHeat();
 	ionization = 0.;
@@ -2265,10 +2275,10 @@ bool Ship::CanRefuel(const Ship &other) const
 
 double Ship::TransferFuel(double amount, Ship *to)
 {
-	amount = max(fuel - attributes.Get("fuel capacity"), amount);
+	amount = max(fuel - attributes->Get("fuel capacity"), amount);
 	if(to)
 	{
-		amount = min(to->attributes.Get("fuel capacity") - to->fuel, amount);
+		amount = min(to->attributes->Get("fuel capacity") - to->fuel, amount);
 		to->fuel += amount;
 	}
 	fuel -= amount;
@@ -2339,7 +2349,7 @@ void Ship::WasCaptured(const shared_ptr<Ship> &capturer)
 // Get characteristics of this ship, as a fraction between 0 and 1.
 double Ship::Shields() const
 {
-	double maximum = attributes.Get("shields");
+	double maximum = attributes->Get("shields");
 	return maximum ? min(1., shields / maximum) : 0.;
 }
 
@@ -2347,7 +2357,7 @@ double Ship::Shields() const
 
 double Ship::Hull() const
 {
-	double maximum = attributes.Get("hull");
+	double maximum = attributes->Get("hull");
 	return maximum ? min(1., hull / maximum) : 1.;
 }
 
@@ -2355,7 +2365,7 @@ double Ship::Hull() const
 
 double Ship::Fuel() const
 {
-	double maximum = attributes.Get("fuel capacity");
+	double maximum = attributes->Get("fuel capacity");
 	return maximum ? min(1., fuel / maximum) : 0.;
 }
 
@@ -2363,7 +2373,7 @@ double Ship::Fuel() const
 
 double Ship::Energy() const
 {
-	double maximum = attributes.Get("energy capacity");
+	double maximum = attributes->Get("energy capacity");
 	return maximum ? min(1., energy / maximum) : (hull > 0.) ? 1. : 0.;
 }
 
@@ -2383,8 +2393,8 @@ double Ship::Heat() const
 double Ship::Health() const
 {
 	double minimumHull = MinimumHull();
-	double hullDivisor = attributes.Get("hull") - minimumHull;
-	double divisor = attributes.Get("shields") + hullDivisor;
+	double hullDivisor = attributes->Get("hull") - minimumHull;
+	double divisor = attributes->Get("shields") + hullDivisor;
 	// This should not happen, but just in case.
 	if(divisor <= 0. || hullDivisor <= 0.)
 		return 0.;
@@ -2399,7 +2409,7 @@ double Ship::Health() const
 // Get the hull fraction at which this ship is disabled.
 double Ship::DisabledHull() const
 {
-	double hull = attributes.Get("hull");
+	double hull = attributes->Get("hull");
 	double minimumHull = MinimumHull();
 	
 	return (hull > 0. ? minimumHull / hull : 0.);
@@ -2428,10 +2438,10 @@ double Ship::JumpFuel(const System *destination) const
 		return max(JumpDriveFuel(), HyperdriveFuel());
 	
 	// Figure out what sort of jump we're making.
-	if(attributes.Get("hyperdrive") && currentSystem->Links().count(destination))
+	if(attributes->Get("hyperdrive") && currentSystem->Links().count(destination))
 		return HyperdriveFuel();
 	
-	if(attributes.Get("jump drive") && currentSystem->Neighbors().count(destination))
+	if(attributes->Get("jump drive") && currentSystem->Neighbors().count(destination))
 		return JumpDriveFuel();
 	
 	// If the given system is not a possible destination, return 0.
@@ -2444,10 +2454,10 @@ double Ship::JumpFuel(const System *destination) const
 double Ship::HyperdriveFuel() const
 {
 	// Don't bother searching through the outfits if there is no hyperdrive.
-	if(!attributes.Get("hyperdrive"))
+	if(!attributes->Get("hyperdrive"))
 		return JumpDriveFuel();
 	
-	if(attributes.Get("scram drive"))
+	if(attributes->Get("scram drive"))
 		return BestFuel("hyperdrive", "scram drive", 150.);
 	
 	return BestFuel("hyperdrive", "", 100.);
@@ -2458,7 +2468,7 @@ double Ship::HyperdriveFuel() const
 double Ship::JumpDriveFuel() const
 {
 	// Don't bother searching through the outfits if there is no jump drive.
-	if(!attributes.Get("jump drive"))
+	if(!attributes->Get("jump drive"))
 		return 0.;
 	
 	return BestFuel("jump drive", "", 200.);
@@ -2471,7 +2481,7 @@ double Ship::JumpFuelMissing() const
 	// Used for smart refuelling: transfer only as much as really needed
 	// includes checking if fuel cap is high enough at all
 	double jumpFuel = JumpFuel(targetSystem);
-	if(!jumpFuel || fuel > jumpFuel || jumpFuel > attributes.Get("fuel capacity"))
+	if(!jumpFuel || fuel > jumpFuel || jumpFuel > attributes->Get("fuel capacity"))
 		return 0.;
 	
 	return jumpFuel - fuel;
@@ -2484,14 +2494,14 @@ double Ship::IdleHeat() const
 {
 	// This ship's cooling ability:
 	double coolingEfficiency = CoolingEfficiency();
-	double cooling = coolingEfficiency * attributes.Get("cooling");
-	double activeCooling = coolingEfficiency * attributes.Get("active cooling");
+	double cooling = coolingEfficiency * attributes->Get("cooling");
+	double activeCooling = coolingEfficiency * attributes->Get("active cooling");
 	
 	// Idle heat is the heat level where:
 	// heat = heat * diss + heatGen - cool - activeCool * heat / (100 * mass)
 	// heat = heat * (diss - activeCool / (100 * mass)) + (heatGen - cool)
 	// heat * (1 - diss + activeCool / (100 * mass)) = (heatGen - cool)
-	double production = max(0., attributes.Get("heat generation") - cooling);
+	double production = max(0., attributes->Get("heat generation") - cooling);
 	double dissipation = HeatDissipation() + activeCooling / MaximumHeat();
 	return production / dissipation;
 }
@@ -2501,7 +2511,7 @@ double Ship::IdleHeat() const
 // Get the heat dissipation, in heat units per heat unit per frame.
 double Ship::HeatDissipation() const
 {
-	return .001 * attributes.Get("heat dissipation");
+	return .001 * attributes->Get("heat dissipation");
 }
 
 
@@ -2509,7 +2519,7 @@ double Ship::HeatDissipation() const
 // Get the maximum heat level, in heat units (not temperature).
 double Ship::MaximumHeat() const
 {
-	return MAXIMUM_TEMPERATURE * (cargo.Used() + attributes.Mass());
+	return MAXIMUM_TEMPERATURE * (cargo.Used() + attributes->Mass());
 }
 
 
@@ -2520,7 +2530,7 @@ double Ship::CoolingEfficiency() const
 	// This is an S-curve where the efficiency is 100% if you have no outfits
 	// that create "cooling inefficiency", and as that value increases the
 	// efficiency stays high for a while, then drops off, then approaches 0.
-	double x = attributes.Get("cooling inefficiency");
+	double x = attributes->Get("cooling inefficiency");
 	return 2. + 2. / (1. + exp(x / -2.)) - 4. / (1. + exp(x / -4.));
 }
 
@@ -2535,18 +2545,18 @@ int Ship::Crew() const
 
 int Ship::RequiredCrew() const
 {
-	if(attributes.Get("automaton"))
+	if(attributes->Get("automaton"))
 		return 0;
 	
 	// Drones do not need crew, but all other ships need at least one.
-	return max<int>(1, attributes.Get("required crew"));
+	return max<int>(1, attributes->Get("required crew"));
 }
 
 
 
 void Ship::AddCrew(int count)
 {
-	crew = min<int>(crew + count, attributes.Get("bunks"));
+	crew = min<int>(crew + count, attributes->Get("bunks"));
 }
 
 
@@ -2561,22 +2571,22 @@ bool Ship::CanBeFlagship() const
 
 double Ship::Mass() const
 {
-	return carriedMass + cargo.Used() + attributes.Mass();
+	return carriedMass + cargo.Used() + attributes->Mass();
 }
 
 
 
 double Ship::TurnRate() const
 {
-	return attributes.Get("turn") / Mass();
+	return attributes->Get("turn") / Mass();
 }
 
 
 
 double Ship::Acceleration() const
 {
-	double thrust = attributes.Get("thrust");
-	return (thrust ? thrust : attributes.Get("afterburner thrust")) / Mass();
+	double thrust = attributes->Get("thrust");
+	return (thrust ? thrust : attributes->Get("afterburner thrust")) / Mass();
 }
 
 
@@ -2586,15 +2596,15 @@ double Ship::MaxVelocity() const
 	// v * drag / mass == thrust / mass
 	// v * drag == thrust
 	// v = thrust / drag
-	double thrust = attributes.Get("thrust");
-	return (thrust ? thrust : attributes.Get("afterburner thrust")) / attributes.Get("drag");
+	double thrust = attributes->Get("thrust");
+	return (thrust ? thrust : attributes->Get("afterburner thrust")) / attributes->Get("drag");
 }
 
 
 
 double Ship::MaxReverseVelocity() const
 {
-	return attributes.Get("reverse thrust") / attributes.Get("drag");
+	return attributes->Get("reverse thrust") / attributes->Get("drag");
 }
 
 
@@ -2719,7 +2729,7 @@ bool Ship::CanCarry(const Ship &ship) const
 	if(!ship.canBeCarried)
 		return false;
 	// This carried ship is either a fighter or a drone.
-	bool isFighter = (ship.attributes.Category() == "Fighter");
+	bool isFighter = (ship.attributes->Category() == "Fighter");
 	
 	int free = BaysFree(isFighter);
 	if(!free)
@@ -2728,7 +2738,7 @@ bool Ship::CanCarry(const Ship &ship) const
 	for(const auto &it : escorts)
 	{
 		auto escort = it.lock();
-		if(escort && escort->attributes.Category() == ship.attributes.Category())
+		if(escort && escort->attributes->Category() == ship.attributes->Category())
 			--free;
 	}
 	return (free > 0);
@@ -2749,7 +2759,7 @@ bool Ship::Carry(const shared_ptr<Ship> &ship)
 		return false;
 	
 	// This carried ship is either a fighter or a drone.
-	bool isFighter = ship->attributes.Category() == "Fighter";
+	bool isFighter = ship->attributes->Category() == "Fighter";
 	
 	for(Bay &bay : bays)
 		if((bay.isFighter == isFighter) && !bay.ship)
@@ -2871,14 +2881,14 @@ void Ship::Jettison(const Outfit *outfit, int count)
 
 const Outfit &Ship::Attributes() const
 {
-	return attributes;
+	return *attributes;
 }
 
 
 
 const Outfit &Ship::BaseAttributes() const
 {
-	return baseAttributes;
+	return *baseAttributes;
 }
 
 
@@ -2886,15 +2896,15 @@ const Outfit &Ship::BaseAttributes() const
 // Get outfit information.
 const map<const Outfit *, int> &Ship::Outfits() const
 {
-	return outfits;
+	return *outfits;
 }
 
 
 
 int Ship::OutfitCount(const Outfit *outfit) const
 {
-	auto it = outfits.find(outfit);
-	return (it == outfits.end()) ? 0 : it->second;
+	auto it = outfits->find(outfit);
+	return (it == outfits->end()) ? 0 : it->second;
 }
 
 
@@ -2904,21 +2914,22 @@ void Ship::AddOutfit(const Outfit *outfit, int count)
 {
 	if(outfit && count)
 	{
-		auto it = outfits.find(outfit);
-		if(it == outfits.end())
-			outfits[outfit] = count;
+		map<const Outfit *, int> &installed = outfits.Edit();
+		auto it = installed.find(outfit);
+		if(it == installed.end())
+			installed[outfit] = count;
 		else
 		{
 			it->second += count;
 			if(!it->second)
-				outfits.erase(it);
+				installed.erase(it);
 		}
-		attributes.Add(*outfit, count);
+		attributes.Edit().Add(*outfit, count);
 		if(outfit->IsWeapon())
 			armament.Add(outfit, count);
 		
 		if(outfit->Get("cargo space"))
-			cargo.SetSize(attributes.Get("cargo space"));
+			cargo.SetSize(attributes->Get("cargo space"));
 		if(outfit->Get("hull"))
 			hull += outfit->Get("hull") * count;
 	}
@@ -2950,8 +2961,8 @@ bool Ship::CanFire(const Weapon *weapon) const
 	
 	if(weapon->Ammo())
 	{
-		auto it = outfits.find(weapon->Ammo());
-		if(it == outfits.end() || it->second <= 0)
+		auto it = outfits->find(weapon->Ammo());
+		if(it == outfits->end() || it->second <= 0)
 			return false;
 	}
 	
@@ -3134,7 +3145,7 @@ double Ship::MinimumHull() const
 	if(neverDisabled)
 		return 0.;
 	
-	double maximumHull = attributes.Get("hull");
+	double maximumHull = attributes->Get("hull");
 	return floor(maximumHull * max(.15, min(.45, 10. / sqrt(maximumHull))));
 }
 
@@ -3146,14 +3157,14 @@ double Ship::BestFuel(const string &type, const string &subtype, double defaultF
 	// Find the outfit that provides the least costly hyperjump.
 	double best = 0.;
 	// Make it possible for a hyperdrive to be integrated into a ship.
-	if(baseAttributes.Get(type) && (subtype.empty() || baseAttributes.Get(subtype)))
+	if(baseAttributes->Get(type) && (subtype.empty() || baseAttributes->Get(subtype)))
 	{
-		best = baseAttributes.Get("jump fuel");
+		best = baseAttributes->Get("jump fuel");
 		if(!best)
 			best = defaultFuel;
 	}
 	// Search through all the outfits.
-	for(const auto &it : outfits)
+	for(const auto &it : *outfits)
 		if(it.first->Get(type) && (subtype.empty() || it.first->Get(subtype)))
 		{
 			double fuel = it.first->Get("jump fuel");
@@ -3169,7 +3180,7 @@ double Ship::BestFuel(const string &type, const string &subtype, double defaultF
 
 void Ship::CreateExplosion(vector<Visual> &visuals, bool spread)
 {
-	if(!HasSprite() || !GetMask().IsLoaded() || explosionEffects.empty())
+	if(!HasSprite() || !GetMask().IsLoaded() || explosionEffects->empty())
 		return;
 	
 	// Bail out if this loops enough times, just in case.
@@ -3181,8 +3192,8 @@ void Ship::CreateExplosion(vector<Visual> &visuals, bool spread)
 		{
 			// Pick an explosion.
 			int type = Random::Int(explosionTotal);
-			auto it = explosionEffects.begin();
-			for( ; it != explosionEffects.end(); ++it)
+			auto it = explosionEffects->begin();
+			for( ; it != explosionEffects->end(); ++it)
 			{
 				type -= it->second;
 				if(type < 0)
@@ -3204,7 +3215,7 @@ void Ship::CreateExplosion(vector<Visual> &visuals, bool spread)
 
 
 // Place a "spark" effect, like ionization or disruption.
-void Ship::CreateSparks(vector<Visual> &visuals, const string &name, double amount)
+void Ship::CreateSparks(vector<Visual> &visuals, const Effect *effect, double amount)
 {
 	if(forget)
 		return;
@@ -3212,7 +3223,6 @@ void Ship::CreateSparks(vector<Visual> &visuals, const string &name, double amou
 	// Limit the number of sparks, depending on the size of the sprite.
 	amount = min(amount, Width() * Height() * .0006);
 	
-	const Effect *effect = GameData::Effects().Get(name);
 	while(true)
 	{
 		amount -= Random::Real();
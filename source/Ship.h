@@ -15,14 +15,17 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Body.h"
 
+#include "Allocations.h"
 #include "Angle.h"
 #include "Armament.h"
 #include "CargoHold.h"
 #include "Command.h"
+#include "CopyOnWrite.h"
 #include "Outfit.h"
 #include "Personality.h"
 #include "Point.h"
 
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
@@ -148,6 +151,9 @@ public:
 	void SetGovernment(const Government *government);
 	void SetIsSpecial(bool special = true);
 	bool IsSpecial() const;
+	// Get the key that identifies this ship's random number streams. A ship is
+	// given a new key each time it is placed.
+	uint64_t RandomKey() const;
 	
 	// If a ship belongs to the player, the player can give it commands.
 	void SetIsYours(bool yours = true);
@@ -389,7 +395,7 @@ private:
 	// either stay over the ship, or spread out if this is the final explosion.
 	void CreateExplosion(std::vector<Visual> &visuals, bool spread = false);
 	// Place a "spark" effect, like ionization or disruption.
-	void CreateSparks(std::vector<Visual> &visuals, const std::string &name, double amount);
+	void CreateSparks(std::vector<Visual> &visuals, const Effect *effect, double amount);
 	
 	
 private:
@@ -402,16 +408,19 @@ private:
 	const Government *government;
 	*/
 	
-	// Characteristics of the chassis:
+	// Characteristics of the chassis. Anything large that copies of a ship
+	// model rarely change is shared with the model until a copy changes it,
+	// so that spawning a ship does not need to duplicate all of it.
 	const Ship *base = nullptr;
 	std::string modelName;
 	std::string pluralModelName;
 	std::string noun;
-	std::string description;
+	CopyOnWrite<std::string> description;
 	const Sprite *thumbnail = nullptr;
 	// Characteristics of this particular ship:
 	std::string name;
 	bool canBeCarried = false;
+	uint64_t randomKey = 0;
 	
 	int forget = 0;
 	bool isInSystem = true;
@@ -444,11 +453,11 @@ private:
 	const Phrase *hail = nullptr;
 	
 	// Installed outfits, cargo, etc.:
-	Outfit attributes;
-	Outfit baseAttributes;
+	CopyOnWrite<Outfit> attributes;
+	CopyOnWrite<Outfit> baseAttributes;
 	bool addAttributes = false;
 	const Outfit *explosionWeapon = nullptr;
-	std::map<const Outfit *, int> outfits;
+	CopyOnWrite<std::map<const Outfit *, int>> outfits;
 	CargoHold cargo;
 	std::list<std::shared_ptr<Flotsam>> jettisoned;
 	
@@ -456,7 +465,7 @@ private:
 	// Cache the mass of carried ships to avoid repeatedly recomputing it.
 	double carriedMass = 0.;
 	
-	std::vector<EnginePoint> enginePoints;
+	CopyOnWrite<std::vector<EnginePoint>> enginePoints;
 	Armament armament;
 	// While loading, keep track of which outfits already have been equipped.
 	// (That is, they were specified as linked to a given gun or turret point.)
@@ -502,15 +511,15 @@ private:
 		int openPeriod = 60;
 		int closePeriod = 60;
 	};
-	std::vector<Leak> leaks;
+	CopyOnWrite<std::vector<Leak>> leaks;
 	std::vector<Leak> activeLeaks;
 	
 	// Explosions that happen when the ship is dying:
-	std::map<const Effect *, int> explosionEffects;
+	CopyOnWrite<std::map<const Effect *, int>> explosionEffects;
 	unsigned explosionRate = 0;
 	unsigned explosionCount = 0;
 	unsigned explosionTotal = 0;
-	std::map<const Effect *, int> finalExplosions;
+	CopyOnWrite<std::map<const Effect *, int>> finalExplosions;
 	
 	// Target ships, planets, systems, etc.
 	std::weak_ptr<Ship> targetShip;
@@ -523,6 +532,9 @@ private:
 	// Links between escorts and parents.
 	std::vector<std::weak_ptr<Ship>> escorts;
 	std::weak_ptr<Ship> parent;
+	
+	// Keep track of how many ships exist, to find any that are never freed.
+	Allocations::Counted<Ship, Allocations::SHIPS> counted;
 };
 
 
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "Sound.h"
 
+#include "Allocations.h"
 #include "File.h"
 #include "Files.h"
 
@@ -61,6 +62,12 @@ bool Sound::Load(const string &path, const string &name)
 		alGenBuffers(1, &buffer);
 	alBufferData(buffer, AL_FORMAT_MONO16, &data.front(), bytes, frequency);
 	
+	// The buffer might be replaced by a sound with the same name in a plugin.
+	if(size)
+		Allocations::Remove(Allocations::SOUNDS, size);
+	size = bytes;
+	Allocations::Add(Allocations::SOUNDS, size);
+	
 	return true;
 }
 
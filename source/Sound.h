@@ -32,6 +32,8 @@ public:
 private:
 	std::string name;
 	unsigned buffer = 0;
+	// The size of the sample data in the buffer, in bytes.
+	unsigned size = 0;
 	bool isLooped = false;
 };
 
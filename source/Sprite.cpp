@@ -23,6 +23,11 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 using namespace std;
 
+namespace {
+	bool isHeadless = false;
+	atomic<int> currentFrame(0);
+}
+
 
 
 Sprite::Sprite(const string &name)
@@ -46,14 +51,23 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	if(!buffer.Pixels())
 		return;
 	
-	// If this is the 1x image, its dimensions determine the sprite's size.
-	if(!is2x)
+	// If this is the 1x image, its dimensions determine the sprite's size. If
+	// the textures are being uploaded again, the size is already known, and it
+	// may be in use by another thread.
+	if(!is2x && !frames)
 	{
 		width = buffer.Width();
 		height = buffer.Height();
 		frames = buffer.Frames();
 	}
 	
+	// Without an OpenGL context, only the dimensions are needed.
+	if(isHeadless)
+	{
+		buffer.Clear();
+		return;
+	}
+	
 	// Check whether this sprite is large enough to require size reduction.
 	if(Preferences::Has("Reduce large graphics") && buffer.Width() * buffer.Height() >= 1000000)
 		buffer.ShrinkToHalfSize();
@@ -72,6 +86,7 @@ void Sprite::AddFrames(ImageBuffer &buffer, bool is2x)
 	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, // target, mipmap level, internal format,
 		buffer.Width(), buffer.Height(), buffer.Frames(), // width, height, depth,
 		0, GL_BGRA, GL_UNSIGNED_BYTE, buffer.Pixels()); // border, input format, data type, data.
+	textureBytes += static_cast<size_t>(buffer.Width()) * buffer.Height() * buffer.Frames() * 4;
 	
 	// Unbind the texture.
 	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
@@ -95,8 +110,7 @@ void Sprite::AddMasks(vector<Mask> &masks)
 // Free up all textures loaded for this sprite.
 void Sprite::Unload()
 {
-	glDeleteTextures(2, texture);
-	texture[0] = texture[1] = 0;
+	UnloadTextures();
 	
 	masks.clear();
 	width = 0.f;
@@ -106,6 +120,25 @@ void Sprite::Unload()
 
 
 
+// Free up the textures, but keep everything else.
+void Sprite::UnloadTextures()
+{
+	if(!isHeadless)
+		glDeleteTextures(2, texture);
+	texture[0] = texture[1] = 0;
+	textureBytes = 0;
+}
+
+
+
+// If the game is running without drawing anything, do not upload any textures.
+void Sprite::SetHeadless(bool headless)
+{
+	isHeadless = headless;
+}
+
+
+
 // Get the width, in pixels, of the 1x image.
 float Sprite::Width() const
 {
@@ -150,6 +183,7 @@ uint32_t Sprite::Texture() const
 // Get the index of the texture for the given high DPI mode.
 uint32_t Sprite::Texture(bool isHighDPI) const
 {
+	MarkDrawn();
 	return (isHighDPI && texture[1]) ? texture[1] : texture[0];
 }
 
@@ -165,3 +199,56 @@ const Mask &Sprite::GetMask(int frame) const
 	// Assume that if a masks array exists, it has the right number of frames.
 	return masks[frame % masks.size()];
 }
+
+
+
+// Cache the bounding boxes of the masks at each facing, for sprites whose
+// masks are queried often.
+void Sprite::CacheMaskFacings() const
+{
+	for(const Mask &mask : masks)
+		mask.CacheFacings();
+}
+
+
+
+// Get how much memory the masks' facing caches take up.
+size_t Sprite::MaskCacheBytes() const
+{
+	size_t bytes = 0;
+	for(const Mask &mask : masks)
+		bytes += mask.CacheBytes();
+	return bytes;
+}
+
+
+
+// Get how much GPU memory this sprite's textures take up.
+size_t Sprite::TextureBytes() const
+{
+	return textureBytes;
+}
+
+
+
+// Get the frame in which this sprite was last drawn.
+int Sprite::LastDrawn() const
+{
+	return lastDrawn.load(memory_order_relaxed);
+}
+
+
+
+// Mark this sprite as drawn in this frame, without drawing it.
+void Sprite::MarkDrawn() const
+{
+	lastDrawn.store(currentFrame.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+
+
+// Begin a new frame, and return its number.
+int Sprite::NewFrame()
+{
+	return ++currentFrame;
+}
@@ -16,6 +16,8 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Mask.h"
 #include "Point.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -43,6 +45,14 @@ public:
 	void AddMasks(std::vector<Mask> &masks);
 	// Free up all textures loaded for this sprite.
 	void Unload();
+	// Free up the textures, but keep the dimensions and masks so the sprite can
+	// still be used for collisions. It will draw nothing until it is uploaded
+	// again.
+	void UnloadTextures();
+	// If the game is running without drawing anything (e.g. to play back a
+	// recording), sprites only need their dimensions and masks. No textures
+	// are uploaded, so no OpenGL context is needed.
+	static void SetHeadless(bool headless = true);
 	
 	// Image dimensions, in pixels.
 	float Width() const;
@@ -61,13 +71,32 @@ public:
 	uint32_t Texture(bool isHighDPI) const;
 	// Get the collision mask for the given frame of the animation.
 	const Mask &GetMask(int frame = 0) const;
+	// Cache the bounding boxes of the masks at each facing, for sprites whose
+	// masks are queried often. Get how much memory those caches take up.
+	void CacheMaskFacings() const;
+	size_t MaskCacheBytes() const;
+	
+	// Get how much GPU memory this sprite's textures take up.
+	size_t TextureBytes() const;
+	// Get the frame in which this sprite was last drawn. Asking for its texture
+	// counts as drawing it.
+	int LastDrawn() const;
+	// Mark this sprite as drawn in this frame, without drawing it. If its
+	// textures were unloaded, this makes them be loaded again.
+	void MarkDrawn() const;
+	// Begin a new frame, for tracking which sprites are still being drawn.
+	static int NewFrame();
 	
 	
 private:
 	std::string name;
 	
 	uint32_t texture[2] = {0, 0};
+	size_t textureBytes = 0;
 	std::vector<Mask> masks;
+	// The textures may be requested by the drawing thread and by the thread
+	// that fills in the draw lists.
+	mutable std::atomic<int> lastDrawn{0};
 	
 	float width = 0.f;
 	float height = 0.f;
@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "ImageBuffer.h"
 #include "ImageSet.h"
 #include "Mask.h"
+#include "Profiler.h"
 #include "Sprite.h"
 #include "SpriteSet.h"
 
@@ -50,7 +51,7 @@ SpriteQueue::~SpriteQueue()
 
 
 // Add a sprite to load.
-void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
+void SpriteQueue::Add(const shared_ptr<ImageSet> &images, bool isPriority)
 {
 	{
 		lock_guard<mutex> lock(readMutex);
@@ -58,7 +59,10 @@ void SpriteQueue::Add(const shared_ptr<ImageSet> &images)
 		if(added < 0)
 			return;
 		
-		toRead.push(images);
+		if(isPriority)
+			toRead.push_front(images);
+		else
+			toRead.push_back(images);
 		++added;
 	}
 	readCondition.notify_one();
@@ -78,6 +82,11 @@ void SpriteQueue::Unload(const string &name)
 // Find out our percent completion.
 double SpriteQueue::Progress()
 {
+	// Once per frame, make sure the uploaded textures are within the budget,
+	// and load any textures that were unloaded but are being drawn again.
+	for(const shared_ptr<ImageSet> &images : residency.Update())
+		Add(images, true);
+	
 	unique_lock<mutex> lock(loadMutex);
 	return DoLoad(lock);
 }
@@ -104,9 +113,18 @@ void SpriteQueue::Finish()
 
 
 
+// Get the statistics for the textures that are uploaded to the GPU.
+const TextureResidency &SpriteQueue::Residency() const
+{
+	return residency;
+}
+
+
+
 // Thread entry point.
 void SpriteQueue::operator()()
 {
+	Profiler::SetThreadName("Sprite loader");
 	while(true)
 	{
 		unique_lock<mutex> lock(readMutex);
@@ -121,13 +139,16 @@ void SpriteQueue::operator()()
 			
 			// Extract the one item we should work on reading right now.
 			shared_ptr<ImageSet> imageSet = toRead.front();
-			toRead.pop();
+			toRead.pop_front();
 			
 			// It's now safe to add to the lists.
 			lock.unlock();
 			
 			// Load the sprite.
-			imageSet->Load();
+			{
+				Profiler::Zone zone("ImageSet::Load");
+				imageSet->Load();
+			}
 			
 			{
 				// The texture must be uploaded to OpenGL in the main thread.
@@ -147,6 +168,7 @@ void SpriteQueue::operator()()
 
 double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 {
+	Profiler::Zone zone("SpriteQueue::DoLoad");
 	while(!toUnload.empty())
 	{
 		Sprite *sprite = SpriteSet::Modify(toUnload.front());
@@ -154,6 +176,7 @@ double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 		
 		lock.unlock();
 		sprite->Unload();
+		residency.Unloaded(sprite);
 		lock.lock();
 	}
 	
@@ -166,7 +189,9 @@ double SpriteQueue::DoLoad(unique_lock<mutex> &lock)
 		// It's now safe to modify the lists.
 		lock.unlock();
 		
-		imageSet->Upload(SpriteSet::Modify(imageSet->Name()));
+		Sprite *sprite = SpriteSet::Modify(imageSet->Name());
+		imageSet->Upload(sprite);
+		residency.Uploaded(sprite, imageSet);
 		
 		lock.lock();
 		++completed;
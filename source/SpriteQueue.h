@@ -13,7 +13,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef SPRITE_QUEUE_H_
 #define SPRITE_QUEUE_H_
 
+#include "TextureResidency.h"
+
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -36,14 +39,17 @@ public:
 	SpriteQueue();
 	~SpriteQueue();
 	
-	// Add a sprite to load.
-	void Add(const std::shared_ptr<ImageSet> &images);
+	// Add a sprite to load. Priority sprites are needed soon, so they are
+	// loaded before any others that are waiting.
+	void Add(const std::shared_ptr<ImageSet> &images, bool isPriority = false);
 	// Unload the texture for the given sprite (to free up memory).
 	void Unload(const std::string &name);
 	// Upload more iamges and find out our percent completion.
 	double Progress();
 	// Finish loading.
 	void Finish();
+	// Get the statistics for the textures that are uploaded to the GPU.
+	const TextureResidency &Residency() const;
 	
 	// Thread entry point.
 	void operator()();
@@ -55,7 +61,7 @@ private:
 	
 private:
 	// These are the image sets that need to be loaded from disk.
-	std::queue<std::shared_ptr<ImageSet>> toRead;
+	std::deque<std::shared_ptr<ImageSet>> toRead;
 	std::mutex readMutex;
 	std::condition_variable readCondition;
 	int added = 0;
@@ -68,6 +74,9 @@ private:
 	
 	// These sprites must be unloaded to reclaim GPU memory.
 	std::queue<std::string> toUnload;
+	// Keep track of the uploaded textures, and keep them within the budget.
+	// This is only used in the main thread.
+	TextureResidency residency;
 	
 	// Worker threads for loading sprites from disk.
 	std::vector<std::thread> threads;
@@ -12,9 +12,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "SpriteSet.h"
 
+#include "Allocations.h"
 #include "Sprite.h"
 
+#include <cstdint>
 #include <map>
+#include <tuple>
+#include <utility>
 
 using namespace std;
 
@@ -35,6 +39,22 @@ Sprite *SpriteSet::Modify(const string &name)
 {
 	auto it = sprites.find(name);
 	if(it == sprites.end())
-		it = sprites.insert(make_pair(name, Sprite(name))).first;
+		it = sprites.emplace(piecewise_construct, forward_as_tuple(name), forward_as_tuple(name)).first;
 	return &it->second;
 }
+
+
+
+// Measure how much memory the loaded sprites' cached mask bounds take up.
+void SpriteSet::UpdateMemory()
+{
+	int64_t bytes = 0;
+	int64_t objects = 0;
+	for(const auto &it : sprites)
+	{
+		size_t cache = it.second.MaskCacheBytes();
+		bytes += cache;
+		objects += (cache != 0);
+	}
+	Allocations::Set(Allocations::MASK_CACHES, bytes, objects);
+}
@@ -26,6 +26,9 @@ class SpriteSet {
 public:
 	static const Sprite *Get(const std::string &name);
 	
+	// Measure how much memory the loaded sprites' cached mask bounds take up.
+	static void UpdateMemory();
+	
 	
 private:
 	// Only SpriteQueue is allowed to modify the sprites.
@@ -12,6 +12,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 #include "SpriteShader.h"
 
+#include "Font.h"
 #include "Point.h"
 #include "Screen.h"
 #include "Shader.h"
@@ -181,6 +182,7 @@ void SpriteShader::Draw(const Sprite *sprite, const Point &position, float zoom,
 
 void SpriteShader::Bind()
 {
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
@@ -15,6 +15,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Angle.h"
 #include "Body.h"
 #include "DrawList.h"
+#include "Font.h"
 #include "pi.h"
 #include "Point.h"
 #include "Preferences.h"
@@ -90,6 +91,7 @@ void StarField::SetHaze(const Sprite *sprite)
 
 void StarField::Draw(const Point &pos, const Point &vel, double zoom) const
 {
+	Font::Flush();
 	glUseProgram(shader.Object());
 	glBindVertexArray(vao);
 	
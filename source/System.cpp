@@ -22,6 +22,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Planet.h"
 #include "Random.h"
 #include "SpriteSet.h"
+#include "SystemGrid.h"
 
 #include <algorithm>
 #include <cmath>
@@ -321,7 +322,7 @@ void System::Load(const DataNode &node, Set<Planet> &planets)
 
 // Once the star map is fully loaded, figure out which stars are "neighbors"
 // of this one, i.e. close enough to see or to reach via jump drive.
-void System::UpdateNeighbors(const Set<System> &systems)
+void System::UpdateNeighbors(const SystemGrid &grid)
 {
 	neighbors.clear();
 	
@@ -333,9 +334,9 @@ void System::UpdateNeighbors(const Set<System> &systems)
 	
 	// Any other star system that is within the neighbor distance is also a
 	// neighbor. This will include any nearby linked systems.
-	for(const auto &it : systems)
-		if(&it.second != this && it.second.Position().Distance(position) <= NEIGHBOR_DISTANCE)
-			neighbors.insert(&it.second);
+	for(const System *system : grid.Near(position))
+		if(system != this && system->Position().Distance(position) <= NEIGHBOR_DISTANCE)
+			neighbors.insert(system);
 	
 	// Calculate the solar power and solar wind.
 	solarPower = 0.;
@@ -632,6 +633,19 @@ void System::SetSupply(const string &commodity, double tons)
 
 
 
+// Return all commodities to their base prices.
+void System::ResetEconomy()
+{
+	for(auto &it : trade)
+	{
+		it.second.supply = 0.;
+		it.second.exports = 0.;
+		it.second.Update();
+	}
+}
+
+
+
 double System::Supply(const string &commodity) const
 {
 	auto it = trade.find(commodity);
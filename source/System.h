@@ -29,6 +29,7 @@ class Minable;
 class Planet;
 class Ship;
 class Sprite;
+class SystemGrid;
 
 
 
@@ -75,8 +76,9 @@ public:
 	// Load a system's description.
 	void Load(const DataNode &node, Set<Planet> &planets);
 	// Once the star map is fully loaded, figure out which stars are "neighbors"
-	// of this one, i.e. close enough to see or to reach via jump drive.
-	void UpdateNeighbors(const Set<System> &systems);
+	// of this one, i.e. close enough to see or to reach via jump drive. The grid
+	// must contain every system, at its current position.
+	void UpdateNeighbors(const SystemGrid &grid);
 	
 	// Modify a system's links.
 	void Link(System *other);
@@ -133,6 +135,8 @@ public:
 	// Update the economy. Returns the amount of trade goods this system exports.
 	void StepEconomy();
 	void SetSupply(const std::string &commodity, double tons);
+	// Return all commodities to their base prices.
+	void ResetEconomy();
 	double Supply(const std::string &commodity) const;
 	double Exports(const std::string &commodity) const;
 	
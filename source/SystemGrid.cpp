@@ -0,0 +1,88 @@
+/* SystemGrid.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "SystemGrid.h"
+
+#include "System.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+	// Pack a pair of cell coordinates into a single key.
+	uint64_t Key(int64_t x, int64_t y)
+	{
+		return static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y);
+	}
+}
+
+
+
+// Remove all systems from the grid.
+void SystemGrid::Clear()
+{
+	cells.clear();
+	placed.clear();
+}
+
+
+
+// Add a system to the grid at its current position, or if it is already in
+// the grid, move it to its current position.
+void SystemGrid::Place(System *system)
+{
+	uint64_t cell = Cell(system->Position());
+	auto it = placed.find(system);
+	if(it != placed.end())
+	{
+		if(it->second == cell)
+			return;
+		
+		vector<System *> &old = cells[it->second];
+		old.erase(find(old.begin(), old.end(), system));
+		it->second = cell;
+	}
+	else
+		placed[system] = cell;
+	
+	cells[cell].push_back(system);
+}
+
+
+
+// Get every system that might be within the neighbor distance of the given
+// point. Some of the systems returned may be farther away than that.
+vector<System *> SystemGrid::Near(const Point &point) const
+{
+	vector<System *> result;
+	
+	int64_t cx = floor(point.X() / System::NEIGHBOR_DISTANCE);
+	int64_t cy = floor(point.Y() / System::NEIGHBOR_DISTANCE);
+	for(int64_t y = cy - 1; y <= cy + 1; ++y)
+		for(int64_t x = cx - 1; x <= cx + 1; ++x)
+		{
+			auto it = cells.find(Key(x, y));
+			if(it != cells.end())
+				result.insert(result.end(), it->second.begin(), it->second.end());
+		}
+	
+	return result;
+}
+
+
+
+uint64_t SystemGrid::Cell(const Point &point)
+{
+	return Key(floor(point.X() / System::NEIGHBOR_DISTANCE), floor(point.Y() / System::NEIGHBOR_DISTANCE));
+}
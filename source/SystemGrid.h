@@ -0,0 +1,55 @@
+/* SystemGrid.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef SYSTEM_GRID_H_
+#define SYSTEM_GRID_H_
+
+#include "Point.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class System;
+
+
+
+// A spatial hash of star system positions, so that the systems near a point
+// can be found without checking every system in the galaxy. Each grid cell is
+// as wide as the neighbor distance, so any system within that distance of a
+// point is in the block of nine cells surrounding it.
+class SystemGrid {
+public:
+	// Remove all systems from the grid.
+	void Clear();
+	// Add a system to the grid at its current position, or if it is already in
+	// the grid, move it to its current position.
+	void Place(System *system);
+	
+	// Get every system that might be within the neighbor distance of the given
+	// point. Some of the systems returned may be farther away than that.
+	std::vector<System *> Near(const Point &point) const;
+	
+	
+private:
+	static uint64_t Cell(const Point &point);
+	
+	
+private:
+	std::unordered_map<uint64_t, std::vector<System *>> cells;
+	// The cell that each system was last placed in.
+	std::unordered_map<const System *, uint64_t> placed;
+};
+
+
+
+#endif
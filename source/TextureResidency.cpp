@@ -0,0 +1,162 @@
+/* TextureResidency.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "TextureResidency.h"
+
+#include "ImageSet.h"
+#include "Preferences.h"
+#include "Sprite.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+namespace {
+	// Don't unload anything that has been drawn within the last ten seconds,
+	// even if that means going over budget. Otherwise, the same textures would
+	// be unloaded and loaded again over and over.
+	const int MIN_AGE = 600;
+	// Checking the budget means sorting all the textures, so don't do it in
+	// every frame.
+	const int CHECK_INTERVAL = 60;
+}
+
+
+
+// A sprite's textures were uploaded from the given images.
+void TextureResidency::Uploaded(Sprite *sprite, const shared_ptr<ImageSet> &images)
+{
+	Entry &entry = entries[sprite];
+	if(entry.evictedFrame >= 0)
+		evicted.erase(find(evicted.begin(), evicted.end(), sprite));
+	
+	bytes -= entry.bytes;
+	entry.images = images;
+	entry.bytes = sprite->TextureBytes();
+	entry.evictedFrame = -1;
+	entry.isLoading = false;
+	bytes += entry.bytes;
+}
+
+
+
+// A sprite was unloaded entirely, and should no longer be tracked.
+void TextureResidency::Unloaded(Sprite *sprite)
+{
+	auto it = entries.find(sprite);
+	if(it == entries.end())
+		return;
+	
+	if(it->second.evictedFrame >= 0)
+		evicted.erase(find(evicted.begin(), evicted.end(), sprite));
+	bytes -= it->second.bytes;
+	entries.erase(it);
+}
+
+
+
+// Begin a new frame. If the textures are over budget, unload the least
+// recently drawn ones, and load any unloaded ones that are being drawn again.
+vector<shared_ptr<ImageSet>> TextureResidency::Update()
+{
+	int frame = Sprite::NewFrame();
+	budget = static_cast<size_t>(Preferences::TextureBudget()) << 20;
+	
+	// The sprites will draw nothing until their textures have been uploaded
+	// again, which should only take a few frames.
+	vector<shared_ptr<ImageSet>> reload;
+	for(Sprite *sprite : evicted)
+	{
+		Entry &entry = entries[sprite];
+		if(!entry.isLoading && sprite->LastDrawn() > entry.evictedFrame)
+		{
+			entry.isLoading = true;
+			reload.push_back(entry.images);
+			++reloads;
+		}
+	}
+	
+	if(!budget || bytes <= budget || frame < nextCheck)
+		return reload;
+	nextCheck = frame + CHECK_INTERVAL;
+	
+	// Unload the textures that have gone the longest without being drawn.
+	vector<pair<int, Sprite *>> candidates;
+	for(const auto &it : entries)
+		if(it.second.evictedFrame < 0 && it.second.bytes && frame - it.first->LastDrawn() > MIN_AGE)
+			candidates.emplace_back(it.first->LastDrawn(), it.first);
+	sort(candidates.begin(), candidates.end());
+	
+	for(const auto &it : candidates)
+	{
+		if(bytes <= budget)
+			break;
+		
+		Entry &entry = entries[it.second];
+		it.second->UnloadTextures();
+		bytes -= entry.bytes;
+		entry.bytes = 0;
+		entry.evictedFrame = frame;
+		evicted.push_back(it.second);
+		++evictions;
+	}
+	return reload;
+}
+
+
+
+// Get the budget, in bytes, or zero if there is no limit.
+size_t TextureResidency::Budget() const
+{
+	return budget;
+}
+
+
+
+// Get the total size of all the uploaded textures.
+size_t TextureResidency::Bytes() const
+{
+	return bytes;
+}
+
+
+
+// Get the number of sprites whose textures are uploaded.
+int TextureResidency::Resident() const
+{
+	return entries.size() - evicted.size();
+}
+
+
+
+// Get the number of sprites whose textures have been unloaded.
+int TextureResidency::Evicted() const
+{
+	return evicted.size();
+}
+
+
+
+// Get how many times textures have been unloaded to stay within the budget.
+int TextureResidency::Evictions() const
+{
+	return evictions;
+}
+
+
+
+// Get how many times unloaded textures have been loaded again.
+int TextureResidency::Reloads() const
+{
+	return reloads;
+}
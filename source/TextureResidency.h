@@ -0,0 +1,80 @@
+/* TextureResidency.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef TEXTURE_RESIDENCY_H_
+#define TEXTURE_RESIDENCY_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+
+class ImageSet;
+class Sprite;
+
+
+
+// Class that keeps track of which sprites have textures uploaded to the GPU, and
+// keeps the total size of those textures within the budget that is set in the
+// preferences. When the budget is exceeded, the textures that have gone the
+// longest without being drawn are unloaded. If one of those sprites is drawn
+// again, its images are loaded from disk and uploaded again. This class should
+// only be used from the main thread.
+class TextureResidency {
+public:
+	// A sprite's textures were uploaded from the given images.
+	void Uploaded(Sprite *sprite, const std::shared_ptr<ImageSet> &images);
+	// A sprite was unloaded entirely, and should no longer be tracked.
+	void Unloaded(Sprite *sprite);
+	// Begin a new frame. If the textures are over budget, unload the least
+	// recently drawn ones. Return the images of any unloaded sprites that have
+	// been drawn since then, which must be loaded again.
+	std::vector<std::shared_ptr<ImageSet>> Update();
+	
+	// Get the budget, in bytes, or zero if there is no limit.
+	size_t Budget() const;
+	// Get the total size of all the uploaded textures.
+	size_t Bytes() const;
+	// Get the number of sprites whose textures are uploaded or unloaded.
+	int Resident() const;
+	int Evicted() const;
+	// Get how many times textures have been unloaded, or loaded again.
+	int Evictions() const;
+	int Reloads() const;
+	
+	
+private:
+	class Entry {
+	public:
+		std::shared_ptr<ImageSet> images;
+		size_t bytes = 0;
+		// The frame in which this sprite's textures were unloaded, or -1 if
+		// they are uploaded.
+		int evictedFrame = -1;
+		bool isLoading = false;
+	};
+	
+	
+private:
+	std::map<Sprite *, Entry> entries;
+	std::vector<Sprite *> evicted;
+	
+	size_t budget = 0;
+	size_t bytes = 0;
+	int evictions = 0;
+	int reloads = 0;
+	int nextCheck = 0;
+};
+
+
+
+#endif
@@ -13,15 +13,58 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "UI.h"
 
 #include "Command.h"
+#include "Font.h"
 #include "Panel.h"
+#include "Profiler.h"
 #include "Screen.h"
 
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
 
 using namespace std;
 
+namespace {
+	// Get the name of the profiler zone for drawing the given panel, which
+	// includes the name of the panel's class, such as "MainPanel::Draw".
+	const char *DrawZoneName(const Panel &panel)
+	{
+		// The names must last as long as the profiler does, so they are never
+		// freed. There is only one for each kind of panel.
+		static map<type_index, string> names;
+		string &name = names[typeid(panel)];
+		if(name.empty())
+		{
+			name = typeid(panel).name();
+#ifdef __GNUC__
+			// GCC and Clang give the mangled name of the class.
+			int status = 0;
+			char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+			if(demangled)
+			{
+				name = demangled;
+				free(demangled);
+			}
+#endif
+			// Leave out any namespace, or the "class " that MSVC puts first.
+			size_t start = name.find_last_of(": ");
+			if(start != string::npos)
+				name.erase(0, start + 1);
+			name += "::Draw";
+		}
+		return name.c_str();
+	}
+}
+
 
 
 // Default constructor.
@@ -126,7 +169,15 @@ void UI::DrawAll()
 			break;
 	
 	for( ; it != stack.end(); ++it)
+	{
+		// Only look up the panel's name if it will be recorded. If the profiler
+		// starts before this zone does, it gets the generic name instead.
+		Profiler::Zone zone(Profiler::IsRunning() ? DrawZoneName(**it) : "Panel::Draw");
 		(*it)->Draw();
+		// Make sure all of this panel's text is drawn before the next panel
+		// draws anything on top of it.
+		Font::Flush();
+	}
 }
 
 
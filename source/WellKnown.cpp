@@ -0,0 +1,87 @@
+/* WellKnown.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "WellKnown.h"
+
+#include "Audio.h"
+#include "Effect.h"
+#include "GameData.h"
+
+using namespace std;
+
+namespace {
+	// These must be in the same order as the IDs.
+	const char *EFFECT_NAMES[WellKnown::EFFECT_COUNT] = {
+		"smoke",
+		"ion spark",
+		"disruption spark",
+		"slowing spark",
+		"jump drive",
+		"basic launch",
+		"flotsam death"
+	};
+	const char *SOUND_NAMES[WellKnown::SOUND_COUNT] = {
+		"jump drive",
+		"hyperdrive",
+		"jump out",
+		"hyperdrive out",
+		"jump in",
+		"hyperdrive in",
+		"alarm",
+		"fail",
+		"scan"
+	};
+	
+	const Effect *effects[WellKnown::EFFECT_COUNT] = {};
+	const Sound *sounds[WellKnown::SOUND_COUNT] = {};
+}
+
+
+
+// Look up all the effects and sounds. The objects they point to are filled
+// in as the game data and the sounds are loaded.
+void WellKnown::Init()
+{
+	for(int i = 0; i < EFFECT_COUNT; ++i)
+		effects[i] = GameData::Effects().Get(EFFECT_NAMES[i]);
+	for(int i = 0; i < SOUND_COUNT; ++i)
+		sounds[i] = Audio::Get(SOUND_NAMES[i]);
+}
+
+
+
+const Effect *WellKnown::Get(EffectID id)
+{
+	return effects[id];
+}
+
+
+
+const Sound *WellKnown::Get(SoundID id)
+{
+	return sounds[id];
+}
+
+
+
+// Get the name that the data files use for the given effect or sound.
+string WellKnown::Name(EffectID id)
+{
+	return EFFECT_NAMES[id];
+}
+
+
+
+string WellKnown::Name(SoundID id)
+{
+	return SOUND_NAMES[id];
+}
@@ -0,0 +1,70 @@
+/* WellKnown.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef WELL_KNOWN_H_
+#define WELL_KNOWN_H_
+
+#include <string>
+
+class Effect;
+class Sound;
+
+
+
+// Class holding the effects and sounds that the game engine itself uses, as
+// opposed to the ones that outfits and ships name in the data files. Looking
+// an effect or sound up by name means searching a map, and in the case of
+// sounds, locking a mutex, which is too slow to do for every ship in every
+// frame. Instead, they are all looked up once, when the game data is loaded.
+// Ship and outfit attributes are not included: looking one up is a binary
+// search of a short sorted array, which does not lock or allocate anything.
+class WellKnown {
+public:
+	enum EffectID {
+		SMOKE,
+		ION_SPARK,
+		DISRUPTION_SPARK,
+		SLOWING_SPARK,
+		JUMP_DRIVE_SPARK,
+		BASIC_LAUNCH,
+		FLOTSAM_DEATH,
+		EFFECT_COUNT
+	};
+	enum SoundID {
+		JUMP_DRIVE,
+		HYPERDRIVE,
+		JUMP_OUT,
+		HYPERDRIVE_OUT,
+		JUMP_IN,
+		HYPERDRIVE_IN,
+		ALARM,
+		FAIL,
+		SCAN,
+		SOUND_COUNT
+	};
+	
+	
+public:
+	// Look up all the effects and sounds. The objects they point to are filled
+	// in as the game data and the sounds are loaded.
+	static void Init();
+	
+	static const Effect *Get(EffectID id);
+	static const Sound *Get(SoundID id);
+	// Get the name that the data files use for the given effect or sound.
+	static std::string Name(EffectID id);
+	static std::string Name(SoundID id);
+};
+
+
+
+#endif
@@ -18,6 +18,13 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 
 using namespace std;
 
+namespace {
+	// How many layouts to remember.
+	const size_t CACHE_SIZE = 128;
+}
+
+LayoutCache<uint64_t, WrappedText::Layout> WrappedText::cache(CACHE_SIZE);
+
 
 
 WrappedText::WrappedText()
@@ -132,7 +139,7 @@ void WrappedText::Wrap(const string &str)
 {
 	SetText(str.data(), str.length());
 	
-	Wrap();
+	CachedWrap();
 }
 
 
@@ -141,7 +148,7 @@ void WrappedText::Wrap(const char *str)
 {
 	SetText(str, strlen(str));
 	
-	Wrap();
+	CachedWrap();
 }
 
 
@@ -163,6 +170,14 @@ void WrappedText::Draw(const Point &topLeft, const Color &color) const
 
 
 
+// Get statistics on how well the cache of wrapped text is working.
+CacheStats WrappedText::LayoutCacheStats()
+{
+	return cache.Stats();
+}
+
+
+
 WrappedText::Word::Word()
 	: index(0), x(0), y(0)
 {
@@ -196,6 +211,42 @@ void WrappedText::SetText(const char *it, size_t length)
 
 
 
+// If this text has been wrapped with the same settings recently, reuse that
+// result. Otherwise, wrap it and remember the result.
+void WrappedText::CachedWrap()
+{
+	if(text.empty() || !font)
+	{
+		height = 0;
+		return;
+	}
+	
+	// Any change in the settings gives a different hash for the same text.
+	uint64_t seed = reinterpret_cast<uintptr_t>(font);
+	for(int value : {wrapWidth, tabWidth, lineHeight, paragraphBreak, static_cast<int>(alignment)})
+		seed = seed * 31 + value;
+	uint64_t key = LayoutHash(text.data(), text.length(), seed);
+	
+	const Layout *layout = cache.Get(key);
+	if(layout && layout->font == font && layout->wrapWidth == wrapWidth
+			&& layout->tabWidth == tabWidth && layout->lineHeight == lineHeight
+			&& layout->paragraphBreak == paragraphBreak && layout->alignment == alignment
+			&& layout->source == text)
+	{
+		text = layout->text;
+		words = layout->words;
+		height = layout->height;
+		return;
+	}
+	
+	string source = text;
+	Wrap();
+	cache.Set(key, Layout{font, wrapWidth, tabWidth, lineHeight, paragraphBreak, alignment,
+		std::move(source), text, words, height});
+}
+
+
+
 void WrappedText::Wrap()
 {
 	height = 0;
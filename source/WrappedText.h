@@ -13,8 +13,10 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #ifndef WRAPPED_TEXT_H_
 #define WRAPPED_TEXT_H_
 
+#include "LayoutCache.h"
 #include "Point.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -66,9 +68,13 @@ public:
 	// Draw the text.
 	void Draw(const Point &topLeft, const Color &color) const;
 	
+	// Get statistics on how well the cache of wrapped text is working.
+	static CacheStats LayoutCacheStats();
+	
 	
 private:
 	void SetText(const char *it, size_t length);
+	void CachedWrap();
 	void Wrap();
 	void AdjustLine(unsigned &lineBegin, int &lineWidth, bool isEnd);
 	int Space(char c) const;
@@ -91,6 +97,23 @@ private:
 		friend class WrappedText;
 	};
 	
+	// The result of wrapping some text with a particular set of parameters.
+	class Layout {
+	public:
+		const Font *font;
+		int wrapWidth;
+		int tabWidth;
+		int lineHeight;
+		int paragraphBreak;
+		Align alignment;
+		
+		// The text before and after wrapping.
+		std::string source;
+		std::string text;
+		std::vector<Word> words;
+		int height;
+	};
+	
 	
 private:
 	const Font *font;
@@ -105,6 +128,10 @@ private:
 	std::string text;
 	std::vector<Word> words;
 	int height;
+	
+	// Most wrapped text is drawn repeatedly, e.g. in every frame that the panel
+	// showing it is open, so the most recently used layouts are remembered.
+	static LayoutCache<uint64_t, Layout> cache;
 };
 
 
@@ -12,6 +12,7 @@ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
 PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 */
 
+#include "Allocations.h"
 #include "Audio.h"
 #include "Command.h"
 #include "Conversation.h"
@@ -21,13 +22,18 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "Dialog.h"
 #include "Files.h"
 #include "Font.h"
+#include "FrameQueue.h"
 #include "FrameTimer.h"
 #include "GameData.h"
 #include "ImageBuffer.h"
 #include "MenuPanel.h"
+#include "Messages.h"
 #include "Panel.h"
 #include "PlayerInfo.h"
 #include "Preferences.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "Scenario.h"
 #include "Screen.h"
 #include "SpriteSet.h"
 #include "SpriteShader.h"
@@ -36,6 +42,7 @@ PARTICULAR PURPOSE.  See the GNU General Public License for more details.
 #include "gl_header.h"
 #include <SDL2/SDL.h>
 
+#include <cctype>
 #include <cstring>
 #include <iostream>
 #include <map>
@@ -71,6 +78,11 @@ int main(int argc, char *argv[])
 	Conversation conversation;
 	bool debugMode = false;
 	bool loadOnly = false;
+	string replayPath;
+	int replayInterval = 0;
+	string scenarioPath;
+	string scenarioFilter;
+	string profilePath;
 	for(const char *const *it = argv + 1; *it; ++it)
 	{
 		string arg = *it;
@@ -90,13 +102,50 @@ int main(int argc, char *argv[])
 			debugMode = true;
 		else if(arg == "-p" || arg == "--parse-save")
 			loadOnly = true;
+		else if(arg == "--record" && it[1])
+			Replay::Record(*++it);
+		else if(arg == "--replay" && it[1])
+		{
+			replayPath = *++it;
+			if(it[1] && isdigit(*it[1]))
+				replayInterval = stoi(*++it);
+		}
+		else if(arg == "--scenario" && it[1])
+		{
+			scenarioPath = *++it;
+			if(it[1] && *it[1] != '-')
+				scenarioFilter = *++it;
+		}
+		else if(arg == "--profile" && it[1])
+			profilePath = *++it;
 	}
+	Profiler::SetThreadName("Main");
+	if(!profilePath.empty())
+		Profiler::Start();
+	// Only debug mode and scenarios report the memory each part of the game
+	// holds, so only they pay for keeping track of it.
+	if(debugMode || !scenarioPath.empty())
+		Allocations::Track();
 	PlayerInfo player;
 	
 	try {
 		// Begin loading the game data. Exit early if we are not using the UI.
 		if(!GameData::BeginLoad(argv))
 			return 0;
+		if(!replayPath.empty())
+		{
+			int result = Replay::Play(replayPath, replayInterval);
+			if(!profilePath.empty() && !Profiler::Write(profilePath))
+				cerr << "Unable to write a profile to \"" << profilePath << "\"." << endl;
+			return result;
+		}
+		if(!scenarioPath.empty())
+		{
+			int result = Scenario::Run(scenarioPath, scenarioFilter);
+			if(!profilePath.empty() && !Profiler::Write(profilePath))
+				cerr << "Unable to write a profile to \"" << profilePath << "\"." << endl;
+			return result;
+		}
 		
 		// Load player data, including reference-checking.
 		player.LoadRecent();
@@ -253,8 +302,10 @@ int main(int argc, char *argv[])
 		int toggleTimeout = 0;
 		while(!menuPanels.IsDone())
 		{
+			Profiler::Zone frameZone("Frame");
 			if(toggleTimeout)
 				--toggleTimeout;
+			FrameQueue::BeginFrame();
 			// Handle any events that occurred in this frame.
 			SDL_Event event;
 			while(SDL_PollEvent(&event))
@@ -282,6 +333,30 @@ int main(int argc, char *argv[])
 				{
 					menuPanels.Quit();
 				}
+				else if(debugMode && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F10)
+				{
+					// Print how much memory each part of the game is holding on to.
+					Allocations::Report(cout);
+					Messages::Add("Printed the memory used by each part of the game to the console.");
+				}
+				else if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F12)
+				{
+					// Start profiling, or stop and write out what was recorded.
+					if(!Profiler::IsRunning())
+					{
+						Profiler::Start();
+						Messages::Add("Profiling started. Press F12 again to save the trace.");
+					}
+					else
+					{
+						Profiler::Stop();
+						string path = profilePath.empty() ? Files::Config() + "trace.json" : profilePath;
+						if(Profiler::Write(path))
+							Messages::Add("Saved the profile to \"" + path + "\".");
+						else
+							Messages::Add("Unable to save the profile to \"" + path + "\".");
+					}
+				}
 				else if(event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
 				{
 					// The window has been resized. Adjust the raw screen size
@@ -327,6 +402,7 @@ int main(int argc, char *argv[])
 			
 			// Tell all the panels to step forward, then draw them.
 			((!isPaused && menuPanels.IsEmpty()) ? gamePanels : menuPanels).StepAll();
+			FrameQueue::Mark(FrameQueue::STEP);
 			
 			// Caps lock slows the frame rate in debug mode, but raises it in
 			// normal mode. Slowing eases in and out over a couple of frames.
@@ -356,13 +432,19 @@ int main(int argc, char *argv[])
 			}
 			
 			Audio::Step();
+			FrameQueue::Mark(FrameQueue::DRAW);
 			// Events in this frame may have cleared out the menu, in which case
 			// we should draw the game panels instead:
 			(menuPanels.IsEmpty() ? gamePanels : menuPanels).DrawAll();
 			if(fastForward)
 				SpriteShader::Draw(SpriteSet::Get("ui/fast forward"), Screen::TopLeft() + Point(10., 10.));
 			
+			// Upload any preloaded sprites that are now available, and keep the
+			// uploaded textures within the memory budget.
+			GameData::Progress();
+			
 			SDL_GL_SwapWindow(window);
+			FrameQueue::Submit(Preferences::FrameQueueDepth());
 			timer.Wait();
 		}
 		
@@ -379,6 +461,15 @@ int main(int argc, char *argv[])
 		Screen::SetRaw(windowWidth, windowHeight);
 		Preferences::Save();
 		
+		// If profiling was requested on the command line, save whatever was
+		// recorded most recently.
+		if(!profilePath.empty() && Profiler::IsRunning())
+			Profiler::Write(profilePath);
+		// In debug mode, report how much memory each part of the game is still
+		// holding on to, to help find anything that grows over a long session.
+		if(debugMode)
+			Allocations::Report(cout);
+		
 		Cleanup(window, context);
 	}
 	catch(const runtime_error &error)
@@ -402,8 +493,16 @@ void PrintHelp()
 	cerr << "    -t, --talk: read and display a conversation from STDIN." << endl;
 	cerr << "    -r, --resources <path>: load resources from given directory." << endl;
 	cerr << "    -c, --config <path>: save user's files to given directory." << endl;
-	cerr << "    -d, --debug: turn on debugging features (e.g. Caps Lock slows down instead of speeds up)." << endl;
+	cerr << "    -d, --debug: turn on debugging features (e.g. Caps Lock slows down instead of speeds up," << endl;
+	cerr << "        and F10 prints how much memory each part of the game is using)." << endl;
 	cerr << "    -p, --parse-save: load the most recent saved game and inspect it for content errors" << endl;
+	cerr << "    --record <path>: record each flight's input to the given file." << endl;
+	cerr << "    --replay <path> [interval]: play back a recorded flight without drawing it," << endl;
+	cerr << "        printing a hash of the game state every <interval> steps, then exit." << endl;
+	cerr << "    --scenario <path> [name]: run the engine on each scenario in the given file (or" << endl;
+	cerr << "        only those whose names contain <name>) without drawing it, then exit." << endl;
+	cerr << "    --profile <path>: record how long each part of the game takes, and save it to" << endl;
+	cerr << "        the given file on exit, as a Chrome trace. F12 starts or stops profiling." << endl;
 	cerr << endl;
 	cerr << "Report bugs to: <https://github.com/endless-sky/endless-sky/issues>" << endl;
 	cerr << "Home page: <https://endless-sky.github.io>" << endl;
@@ -0,0 +1,174 @@
+/* Benchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Files.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Keep running each benchmark until at least this much time has passed.
+	const double MIN_SECONDS = .5;
+	
+	// The registry must be created on first use, because benchmarks register
+	// themselves during static initialization.
+	map<string, function<void()>> &Registry()
+	{
+		static map<string, function<void()>> registry;
+		return registry;
+	}
+	
+	map<string, function<bool()>> &Tests()
+	{
+		static map<string, function<bool()>> tests;
+		return tests;
+	}
+	
+	// The results of each benchmark and test that has been run, in order.
+	class Result {
+	public:
+		string name;
+		double nanoseconds;
+		long iterations;
+	};
+	vector<Result> results;
+	vector<pair<string, bool>> testResults;
+	
+	void WriteString(ostringstream &out, const string &text)
+	{
+		out << '"';
+		for(char c : text)
+		{
+			if(c == '"' || c == '\\')
+				out << '\\' << c;
+			else if(static_cast<unsigned char>(c) >= 0x20)
+				out << c;
+		}
+		out << '"';
+	}
+}
+
+
+
+Benchmark::Benchmark(const string &name, function<void()> body)
+{
+	Registry()[name] = body;
+}
+
+
+
+// Run every benchmark whose name contains the given string, and print the
+// results. Return the number of benchmarks that were run.
+int Benchmark::RunAll(const string &filter)
+{
+	int count = 0;
+	for(const auto &it : Registry())
+	{
+		if(it.first.find(filter) == string::npos)
+			continue;
+		++count;
+		
+		// Run the benchmark once before timing it, so that any lazily created
+		// data is already in place.
+		it.second();
+		
+		// Double the number of iterations until the total time is long enough
+		// that timer resolution does not matter.
+		long iterations = 1;
+		double seconds = 0.;
+		while(true)
+		{
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for(long i = 0; i < iterations; ++i)
+				it.second();
+			seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			if(seconds >= MIN_SECONDS)
+				break;
+			iterations *= 2;
+		}
+		
+		double nanoseconds = seconds * 1e9 / iterations;
+		cout << it.first << ": " << nanoseconds << " ns (" << iterations << " iterations)" << endl;
+		results.push_back({it.first, nanoseconds, iterations});
+	}
+	return count;
+}
+
+
+
+// Write the results of every test and benchmark that has been run so far
+// to the given file, in JSON format, so that they can be compared between
+// revisions. Returns false if the file could not be written.
+bool Benchmark::WriteJSON(const string &path)
+{
+	ostringstream out;
+	out << "{\n\t\"tests\": [";
+	for(size_t i = 0; i < testResults.size(); ++i)
+	{
+		out << (i ? ",\n" : "\n") << "\t\t{\"name\": ";
+		WriteString(out, testResults[i].first);
+		out << ", \"passed\": " << (testResults[i].second ? "true" : "false") << "}";
+	}
+	out << "\n\t],\n\t\"benchmarks\": [";
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		out << (i ? ",\n" : "\n") << "\t\t{\"name\": ";
+		WriteString(out, results[i].name);
+		out << ", \"ns\": " << results[i].nanoseconds << ", \"iterations\": " << results[i].iterations << "}";
+	}
+	out << "\n\t]\n}\n";
+	
+	FILE *file = Files::Open(path, true);
+	if(!file)
+		return false;
+	Files::Write(file, out.str());
+	fclose(file);
+	return true;
+}
+
+
+
+Test::Test(const string &name, function<bool()> body)
+{
+	Tests()[name] = body;
+}
+
+
+
+// Run every test whose name contains the given string. Return the number of
+// tests that were run, and set "failed" to the number that failed.
+int Test::RunAll(const string &filter, int &failed)
+{
+	int count = 0;
+	failed = 0;
+	for(const auto &it : Tests())
+	{
+		if(it.first.find(filter) == string::npos)
+			continue;
+		++count;
+		
+		bool passed = it.second();
+		failed += !passed;
+		testResults.emplace_back(it.first, passed);
+		cout << it.first << ": " << (passed ? "passed" : "FAILED") << endl;
+	}
+	return count;
+}
@@ -0,0 +1,57 @@
+/* Benchmark.h
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <functional>
+#include <string>
+
+
+
+// A minimal benchmark harness. Each benchmark is a function that performs one
+// iteration of the work being measured. It is called repeatedly until enough
+// time has passed to get a stable measurement. Benchmarks register themselves
+// by defining a static Benchmark object in their source file.
+class Benchmark {
+public:
+	Benchmark(const std::string &name, std::function<void()> body);
+	
+	// Run every benchmark whose name contains the given string, and print the
+	// results. Return the number of benchmarks that were run.
+	static int RunAll(const std::string &filter = "");
+	
+	// Write the results of every test and benchmark that has been run so far
+	// to the given file, in JSON format, so that they can be compared between
+	// revisions. Returns false if the file could not be written.
+	static bool WriteJSON(const std::string &path);
+};
+
+
+
+// A check that an optimized piece of code gives the same results as a simple,
+// obviously correct version of it. Tests are run before the benchmarks, so
+// that a benchmark of code that gives the wrong answers is not trusted.
+class Test {
+public:
+	// The body should print a description of any problems it finds, and return
+	// false if there were any.
+	Test(const std::string &name, std::function<bool()> body);
+	
+	// Run every test whose name contains the given string. Return the number of
+	// tests that were run, and set "failed" to the number that failed.
+	static int RunAll(const std::string &filter, int &failed);
+};
+
+
+
+#endif
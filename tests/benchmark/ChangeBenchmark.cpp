@@ -0,0 +1,58 @@
+/* ChangeBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "ChangeCompactor.h"
+#include "DataFile.h"
+#include "DataNode.h"
+
+#include <list>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+	// The changes saved by a long campaign: a few thousand events, each of
+	// which changes the government of a few systems and planets and sometimes
+	// opens or closes a hyperspace link.
+	const list<DataNode> &Campaign()
+	{
+		static list<DataNode> changes;
+		if(changes.empty())
+		{
+			ostringstream out;
+			for(int i = 0; i < 2000; ++i)
+			{
+				int system = (i * 7) % 40;
+				out << "system \"System " << system << "\"\n";
+				out << "\tgovernment \"Government " << i % 5 << "\"\n";
+				out << "\tadd attributes \"event " << i % 3 << "\"\n";
+				out << "planet \"Planet " << system << "\"\n";
+				out << "\tgovernment \"Government " << i % 5 << "\"\n";
+				out << "\tdescription `The situation here has changed " << i << " times.`\n";
+				if(i % 4 == 0)
+					out << (i % 8 ? "link" : "unlink") << " \"System " << system << "\" \"System " << system + 1 << "\"\n";
+			}
+			istringstream in(out.str());
+			DataFile file(in);
+			for(const DataNode &node : file)
+				changes.push_back(node);
+		}
+		return changes;
+	}
+	
+	Benchmark compact("changes: compact 4,500 saved event changes", [](){
+		list<DataNode> changes = Campaign();
+		ChangeCompactor::Compact(changes);
+	});
+}
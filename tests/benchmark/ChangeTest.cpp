@@ -0,0 +1,250 @@
+/* ChangeTest.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "ChangeCompactor.h"
+#include "DataFile.h"
+#include "DataNode.h"
+#include "GameData.h"
+#include "Government.h"
+#include "Planet.h"
+#include "Set.h"
+#include "Sprite.h"
+#include "StellarObject.h"
+#include "System.h"
+
+#include <iostream>
+#include <list>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+	const int SYSTEMS = 4;
+	const int PLANETS = 6;
+	
+	// Write a random list of changes to a few systems and planets, like the
+	// ones that events make. Every name starts with the given prefix, so that
+	// the same changes can be applied to a separate copy of each object.
+	string RandomChanges(unsigned seed, const string &prefix)
+	{
+		mt19937 random(seed);
+		auto pick = [&random](int count) { return static_cast<int>(random() % count); };
+		auto system = [&](){ return '"' + prefix + "system " + to_string(pick(SYSTEMS)) + '"'; };
+		auto planet = [&](){ return '"' + prefix + "planet " + to_string(pick(PLANETS)) + '"'; };
+		
+		ostringstream out;
+		for(int i = 0; i < 60; ++i)
+		{
+			int type = pick(10);
+			if(type == 9)
+			{
+				out << (pick(2) ? "link " : "unlink ") << system() << ' ' << system() << '\n';
+				continue;
+			}
+			bool isSystem = (type < 5);
+			out << (isSystem ? "system " + system() : "planet " + planet()) << '\n';
+			for(int children = 1 + pick(4); children; --children)
+			{
+				int value = pick(3);
+				out << '\t';
+				if(isSystem)
+					switch(pick(22))
+					{
+						case 0: out << "pos " << pick(100) << ' ' << pick(100); break;
+						case 1: out << "government \"Government " << value << '"'; break;
+						case 2: out << "remove government"; break;
+						case 3: out << "music \"music " << value << '"'; break;
+						case 4: out << "habitable " << 100 * value; break;
+						case 5: out << "belt " << 100 * value; break;
+						case 6: out << "attributes \"attribute " << value << "\" \"attribute " << pick(3) << '"'; break;
+						case 7: out << "add attributes \"attribute " << value << '"'; break;
+						case 8: out << "remove attributes \"attribute " << value << '"'; break;
+						case 9: out << "remove attributes"; break;
+						case 10: out << "link " << system(); break;
+						case 11: out << "add link " << system(); break;
+						case 12: out << "remove link " << system(); break;
+						case 13: out << "object " << planet() << "\n\t\tdistance " << 100 * value; break;
+						case 14: out << "add object " << planet() << "\n\t\tdistance " << 100 * value; break;
+						case 15: out << "object\n\t\tdistance " << 100 * value; break;
+						case 16: out << "remove object"; break;
+						case 17: out << "asteroids \"rock " << value << "\" " << pick(10) << ' ' << pick(10); break;
+						case 18: out << "add asteroids \"rock " << value << "\" " << pick(10) << ' ' << pick(10); break;
+						case 19: out << "remove asteroids \"rock " << value << '"'; break;
+						case 20: out << "fleet \"Fleet " << value << "\" " << 100 * pick(10); break;
+						default: out << "remove fleet \"Fleet " << value << '"'; break;
+					}
+				else
+					switch(pick(16))
+					{
+						case 0: out << "attributes \"attribute " << value << "\" \"attribute " << pick(3) << '"'; break;
+						case 1: out << "add attributes \"attribute " << value << '"'; break;
+						case 2: out << "remove attributes \"attribute " << value << '"'; break;
+						case 3: out << "description `Description " << value << ".`"; break;
+						case 4: out << "add description `More description " << value << ".`"; break;
+						case 5: out << "description clear"; break;
+						case 6: out << "spaceport `Spaceport " << value << ".`"; break;
+						case 7: out << "add spaceport `More spaceport " << value << ".`"; break;
+						case 8: out << "music \"music " << value << '"'; break;
+						case 9: out << "music clear"; break;
+						case 10: out << "government \"Government " << value << '"'; break;
+						case 11: out << "remove government"; break;
+						case 12: out << "\"required reputation\" " << value; break;
+						case 13: out << "bribe " << value; break;
+						case 14: out << "security " << value; break;
+						default: out << "landscape \"land/test " << value << '"'; break;
+					}
+				out << '\n';
+			}
+		}
+		return out.str();
+	}
+	
+	// Define each of the objects that the changes refer to, the way the game's
+	// data files do before any events change them.
+	string Definitions(const string &prefix)
+	{
+		ostringstream out;
+		for(int i = 0; i < SYSTEMS; ++i)
+			out << "system \"" << prefix << "system " << i << "\"\n\tpos " << i << " 0\n";
+		for(int i = 0; i < PLANETS; ++i)
+			out << "planet \"" << prefix << "planet " << i << "\"\n\tdescription `Planet " << i << ".`\n";
+		return out.str();
+	}
+	
+	list<DataNode> Parse(const string &text)
+	{
+		list<DataNode> changes;
+		istringstream in(text);
+		DataFile file(in);
+		for(const DataNode &node : file)
+			changes.push_back(node);
+		return changes;
+	}
+	
+	// Describe everything about the systems and planets with the given prefix
+	// that a change could affect, leaving the prefix out of their names.
+	string Describe(const string &prefix)
+	{
+		auto name = [&prefix](const string &name) { return name.substr(prefix.length()); };
+		auto government = [](const Government *gov) { return gov ? gov->GetName() : string("none"); };
+		
+		ostringstream out;
+		for(int i = 0; i < SYSTEMS; ++i)
+		{
+			const System *system = GameData::Systems().Find(prefix + "system " + to_string(i));
+			if(!system)
+				continue;
+			
+			out << name(system->Name()) << ": pos " << system->Position().X() << ' ' << system->Position().Y()
+				<< ", government " << government(system->GetGovernment()) << ", music " << system->MusicName()
+				<< ", habitable " << system->HabitableZone() << ", belt " << system->AsteroidBelt() << '\n';
+			for(const string &attribute : system->Attributes())
+				out << "\tattribute " << attribute << '\n';
+			set<string> links;
+			for(const System *link : system->Links())
+				links.insert(name(link->Name()));
+			for(const string &link : links)
+				out << "\tlink " << link << '\n';
+			for(const StellarObject &object : system->Objects())
+				out << "\tobject " << (object.GetPlanet() ? name(object.GetPlanet()->TrueName()) : "-")
+					<< " in " << object.Parent() << " at " << object.Distance() << '\n';
+			for(const System::Asteroid &asteroid : system->Asteroids())
+				out << "\tasteroids " << asteroid.Name() << ' ' << asteroid.Count() << ' ' << asteroid.Energy() << '\n';
+			for(const System::FleetProbability &fleet : system->Fleets())
+				out << "\tfleet " << fleet.Get() << ' ' << fleet.Period() << '\n';
+		}
+		for(int i = 0; i < PLANETS; ++i)
+		{
+			const Planet *planet = GameData::Planets().Find(prefix + "planet " + to_string(i));
+			if(!planet)
+				continue;
+			
+			out << name(planet->TrueName()) << ": government " << government(planet->GetGovernment())
+				<< ", music " << planet->MusicName()
+				<< ", landscape " << (planet->Landscape() ? planet->Landscape()->Name() : "none")
+				<< ", reputation " << planet->RequiredReputation() << ", bribe " << planet->GetBribeFraction()
+				<< ", security " << planet->Security() << '\n'
+				<< "\tdescription " << planet->Description()
+				<< "\tspaceport " << planet->SpaceportDescription();
+			for(const string &attribute : planet->Attributes())
+				out << "\tattribute " << attribute << '\n';
+			for(const System *system : planet->WormholeSystems())
+				out << "\tin " << name(system->Name()) << '\n';
+		}
+		return out.str();
+	}
+	
+	// Apply random streams of changes to two copies of the same objects, once
+	// as they are and once compacted, and check that the results are the same.
+	bool CheckCompaction()
+	{
+		bool passed = true;
+		for(unsigned seed = 0; seed < 50; ++seed)
+		{
+			string original = "original " + to_string(seed) + ' ';
+			string compacted = "compacted " + to_string(seed) + ' ';
+			
+			GameData::Change(Parse(Definitions(original)));
+			GameData::Change(Parse(Definitions(compacted)));
+			
+			GameData::Change(Parse(RandomChanges(seed, original)));
+			list<DataNode> changes = Parse(RandomChanges(seed, compacted));
+			ChangeCompactor::Compact(changes);
+			GameData::Change(changes);
+			
+			string expected = Describe(original);
+			string result = Describe(compacted);
+			if(result != expected)
+			{
+				cout << "    Seed " << seed << ": compacting the changes gave a different result." << endl;
+				cout << "    Expected:\n" << expected << "    Got:\n" << result;
+				passed = false;
+			}
+		}
+		return passed;
+	}
+	
+	Test compaction("changes: compacted changes have the same effect", CheckCompaction);
+	
+	
+	// Check that changing a planet updates whether its system is "uninhabited,"
+	// even if no systems are changed at the same time.
+	bool CheckUninhabited()
+	{
+		GameData::Change(Parse(
+			"system \"inhabited test\"\n\tpos 5000 5000\n\tobject \"inhabited test planet\"\n"
+			"planet \"inhabited test planet\"\n"));
+		const System *system = GameData::Systems().Find("inhabited test");
+		
+		bool passed = true;
+		auto check = [system, &passed](bool expected, const char *when) {
+			if(system->Attributes().count("uninhabited") != expected)
+			{
+				cout << "    The system is " << (expected ? "not " : "") << "uninhabited " << when << "." << endl;
+				passed = false;
+			}
+		};
+		check(true, "with no spaceport");
+		GameData::Change(Parse("planet \"inhabited test planet\"\n\tspaceport `A spaceport.`\n"));
+		check(false, "after its planet gets a spaceport");
+		GameData::Change(Parse("planet \"inhabited test planet\"\n\tadd attributes uninhabited\n"));
+		check(true, "after its planet is marked as uninhabited");
+		return passed;
+	}
+	
+	Test uninhabited("changes: planet changes update their system's attributes", CheckUninhabited);
+}
@@ -0,0 +1,140 @@
+/* CollisionBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Angle.h"
+#include "Body.h"
+#include "CollisionSet.h"
+#include "ImageBuffer.h"
+#include "Mask.h"
+#include "Point.h"
+#include "Sprite.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// A ship-sized sprite with a detailed outline. Without an OpenGL context,
+	// only its size and masks are filled in.
+	const Sprite *GetSprite()
+	{
+		static Sprite sprite("benchmark");
+		if(!sprite.Width())
+		{
+			const int size = 120;
+			ImageBuffer image;
+			image.Allocate(size, size);
+			double center = .5 * size;
+			for(int y = 0; y < size; ++y)
+			{
+				uint32_t *it = image.Begin(y);
+				for(int x = 0; x < size; ++x)
+				{
+					Point d(x - center, y - center);
+					double radius = center * (.8 + .1 * sin(7 * atan2(d.Y(), d.X())));
+					*it++ = (d.Length() < radius) ? 0xFFFFFFFF : 0;
+				}
+			}
+			vector<Mask> masks(1);
+			masks.back().Create(image);
+			sprite.AddMasks(masks);
+			
+			Sprite::SetHeadless();
+			sprite.AddFrames(image, false);
+		}
+		return &sprite;
+	}
+	
+	unsigned seed = 1;
+	double Next(double range)
+	{
+		seed = seed * 1103515245u + 12345u;
+		return ((seed >> 8) % 20001) * (range / 10000.) - range;
+	}
+	
+	// A large battle: a thousand ships, most of them crowded together in a few
+	// fleets, the same way the engine fills its ship collision set.
+	vector<Body> &Ships()
+	{
+		static vector<Body> ships;
+		if(ships.empty())
+			for(int i = 0; i < 1000; ++i)
+			{
+				Point fleet(2000. * (i % 5) - 4000., 1000. * (i % 3) - 1000.);
+				ships.emplace_back(GetSprite(), fleet + Point(Next(1000.), Next(1000.)),
+					Point(), Angle(Next(180.)));
+			}
+		return ships;
+	}
+	
+	CollisionSet &Filled()
+	{
+		static CollisionSet set(256u, 32u);
+		static bool isFilled = false;
+		if(!isFilled)
+		{
+			set.Clear(0);
+			for(Body &ship : Ships())
+				set.Add(ship);
+			set.Finish();
+			isFilled = true;
+		}
+		return set;
+	}
+	
+	// A thousand projectiles in and around the battle, each moving about as
+	// far in one step as a fast projectile does.
+	class Shot {
+	public:
+		Point from;
+		Point to;
+	};
+	
+	const vector<Shot> &Shots()
+	{
+		static vector<Shot> shots;
+		if(shots.empty())
+			for(int i = 0; i < 1000; ++i)
+			{
+				Point from(Next(5000.), Next(2000.));
+				shots.push_back({from, from + Point(Next(20.), Next(20.))});
+			}
+		return shots;
+	}
+	
+	// Keep the compiler from optimizing the queries away.
+	size_t found = 0;
+	
+	Benchmark build("collision: fill a set with 1,000 ships", [](){
+		static CollisionSet set(256u, 32u);
+		set.Clear(0);
+		for(Body &ship : Ships())
+			set.Add(ship);
+		set.Finish();
+	});
+	
+	Benchmark line("collision: 1,000 projectiles against 1,000 ships", [](){
+		const CollisionSet &set = Filled();
+		for(const Shot &shot : Shots())
+			found += (set.Line(shot.from, shot.to) != nullptr);
+	});
+	
+	// Blast damage and the AI's search for nearby ships are circle queries.
+	Benchmark circle("collision: 1,000 circle queries among 1,000 ships", [](){
+		const CollisionSet &set = Filled();
+		for(const Shot &shot : Shots())
+			found += set.Circle(shot.from, 200.).size();
+	});
+}
@@ -0,0 +1,79 @@
+/* ConditionBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "ConditionSet.h"
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Files.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace {
+	list<ConditionSet> offers;
+	map<string, int64_t> conditions;
+	
+	// Give every condition that an expression refers to a value, so that the
+	// lookups find something, as they would in a long-running game.
+	void AddNames(const DataNode &node)
+	{
+		if(node.Size() == 2)
+			conditions[node.Token(1)] = 1;
+		else if(node.Size() == 3)
+			conditions[node.Token(0)] = 1;
+		for(const DataNode &child : node)
+			AddNames(child);
+	}
+	
+	// The offer conditions of every mission in the data files, and a player's
+	// conditions from a game that has visited a large part of the galaxy.
+	void Load()
+	{
+		if(!offers.empty())
+			return;
+		
+		for(const string &path : Files::RecursiveList(Files::Data()))
+		{
+			DataFile file(path);
+			for(const DataNode &node : file)
+				if(node.Token(0) == "mission")
+					for(const DataNode &child : node)
+						if(child.Size() == 2 && child.Token(0) == "to" && child.Token(1) == "offer")
+						{
+							offers.emplace_back(child);
+							for(const DataNode &grand : child)
+								AddNames(grand);
+						}
+		}
+		for(int i = 0; i < 1000; ++i)
+		{
+			conditions["visited planet: Planet " + to_string(i)] = 1;
+			conditions["visited system: System " + to_string(i)] = 1;
+		}
+	}
+	
+	// Keep the compiler from optimizing the tests away.
+	int passed = 0;
+	
+	// Each time the player lands, every mission's offer conditions are tested.
+	Benchmark test("conditions: test every mission's offer conditions", [](){
+		Load();
+		for(const ConditionSet &offer : offers)
+			passed += offer.Test(conditions);
+	});
+}
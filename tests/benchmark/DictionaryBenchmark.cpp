@@ -0,0 +1,68 @@
+/* DictionaryBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Dictionary.h"
+#include "Files.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Every attribute name that any outfit in the data files has.
+	const vector<string> &Keys()
+	{
+		static vector<string> keys;
+		if(keys.empty())
+		{
+			set<string> names;
+			for(const string &path : Files::RecursiveList(Files::Data()))
+			{
+				DataFile file(path);
+				for(const DataNode &node : file)
+					if(node.Token(0) == "outfit")
+						for(const DataNode &child : node)
+							if(child.Size() == 2 && child.IsNumber(1))
+								names.insert(child.Token(0));
+			}
+			keys.assign(names.begin(), names.end());
+		}
+		return keys;
+	}
+	
+	// A ship's attributes, which have about half of those names in them.
+	const Dictionary &Attributes()
+	{
+		static Dictionary attributes;
+		if(attributes.empty())
+			for(size_t i = 0; i < Keys().size(); i += 2)
+				attributes[Keys()[i]] = i + 1.;
+		return attributes;
+	}
+	
+	// Keep the compiler from optimizing the lookups away.
+	double sum = 0.;
+	
+	// Ships look up their attributes by name many times in every step, and
+	// most of those lookups are for attributes that the ship might not have.
+	Benchmark get("dictionary: look up every outfit attribute in a ship's attributes", [](){
+		const Dictionary &attributes = Attributes();
+		for(const string &key : Keys())
+			sum += attributes.Get(key.c_str());
+	});
+}
@@ -0,0 +1,154 @@
+/* FrameArenaBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Check that memory from the arena is aligned, that the most recent
+	// allocation is given back when it is freed, and that anything that does
+	// not fit comes from the heap instead.
+	bool CheckArena()
+	{
+		bool passed = true;
+		FrameArena arena(1024);
+		char *c = static_cast<char *>(arena.Allocate(1, 1));
+		double *d = static_cast<double *>(arena.Allocate(sizeof(double), alignof(double)));
+		if(reinterpret_cast<uintptr_t>(d) % alignof(double))
+		{
+			cout << "    A double was not aligned." << endl;
+			passed = false;
+		}
+		if(reinterpret_cast<char *>(d) - c >= 16)
+		{
+			cout << "    Padding a double wasted " << (reinterpret_cast<char *>(d) - c) << " bytes." << endl;
+			passed = false;
+		}
+		arena.Deallocate(d, sizeof(double));
+		if(arena.Allocate(sizeof(double), alignof(double)) != d)
+		{
+			cout << "    Freeing the most recent allocation did not give it back." << endl;
+			passed = false;
+		}
+		
+		void *big = arena.Allocate(2048, 8);
+		if(arena.Overflows() != 1)
+		{
+			cout << "    An allocation bigger than the arena did not go to the heap." << endl;
+			passed = false;
+		}
+		arena.Deallocate(big, 2048);
+		if(arena.Allocations() != 4)
+		{
+			cout << "    Counted " << arena.Allocations() << " allocations instead of 4." << endl;
+			passed = false;
+		}
+		// Freeing anything but the most recent allocation leaves it in use.
+		arena.Deallocate(c, 1);
+		if(arena.Lost() != 1 || arena.LostBytes() != 1 || arena.Peak() != 16)
+		{
+			cout << "    Lost " << arena.Lost() << " allocations and " << arena.LostBytes()
+				<< " bytes with a peak of " << arena.Peak() << ", instead of 1, 1, and 16." << endl;
+			passed = false;
+		}
+		
+		arena.Reset();
+		if(arena.Allocate(1, 1) != c || arena.Allocations() != 1 || arena.Lost() || arena.Peak() != 1)
+		{
+			cout << "    Resetting the arena did not free everything." << endl;
+			passed = false;
+		}
+		return passed;
+	}
+	
+	// Check that containers using the arena hold the same contents as ordinary
+	// ones, even once the arena is full.
+	bool CheckContainers()
+	{
+		FrameArena arena(4096);
+		vector<int> plain;
+		vector<int, FrameArena::Allocator<int>> vec(arena);
+		set<int> plainSet;
+		set<int, less<int>, FrameArena::Allocator<int>> arenaSet(less<int>(), arena);
+		for(int i = 0; i < 2000; ++i)
+		{
+			int value = (i * 7919) % 2003;
+			plain.push_back(value);
+			vec.push_back(value);
+			plainSet.insert(value);
+			arenaSet.insert(value);
+		}
+		bool passed = true;
+		if(!arena.Overflows())
+		{
+			cout << "    The arena was expected to be full." << endl;
+			passed = false;
+		}
+		if(!equal(plain.begin(), plain.end(), vec.begin()) || !equal(plainSet.begin(), plainSet.end(), arenaSet.begin()))
+		{
+			cout << "    A container in the arena has the wrong contents." << endl;
+			passed = false;
+		}
+		return passed;
+	}
+	
+	Test arena("arena: allocation, alignment, and overflow", CheckArena);
+	Test containers("arena: containers give the same results", CheckContainers);
+	
+	
+	// Build the same kind of per-government lists of ships that the AI builds
+	// every step, with 200 ships in four governments.
+	template <class List, class Lists>
+	void BuildLists(Lists &lists, const typename List::allocator_type &allocator)
+	{
+		static const vector<shared_ptr<int>> ships = [](){
+			vector<shared_ptr<int>> result;
+			for(int i = 0; i < 200; ++i)
+				result.emplace_back(new int(i % 4));
+			return result;
+		}();
+		for(int gov = 0; gov < 4; ++gov)
+		{
+			List &allies = lists.emplace(gov, List(allocator)).first->second;
+			allies.reserve(ships.size());
+			for(const shared_ptr<int> &ship : ships)
+				if(*ship != gov)
+					allies.push_back(ship);
+		}
+	}
+	
+	Benchmark heapLists("arena: per-government ship lists on the heap", [](){
+		map<int, vector<shared_ptr<int>>> lists;
+		BuildLists<vector<shared_ptr<int>>>(lists, allocator<shared_ptr<int>>());
+	});
+	
+	Benchmark arenaLists("arena: per-government ship lists in a frame arena", [](){
+		typedef vector<shared_ptr<int>, FrameArena::Allocator<shared_ptr<int>>> List;
+		static FrameArena frame(1 << 16);
+		{
+			map<int, List, less<int>, FrameArena::Allocator<pair<const int, List>>> lists(less<int>(), frame);
+			BuildLists<List>(lists, frame);
+		}
+		frame.Reset();
+	});
+}
@@ -0,0 +1,81 @@
+/* GalaxyBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Journal.h"
+#include "Planet.h"
+#include "Set.h"
+#include "System.h"
+#include "SystemGrid.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+	// A galaxy the size of the largest plugins: ten thousand systems, spaced
+	// out about as densely as the systems in the human galaxy.
+	const int SYSTEM_COUNT = 10000;
+	
+	Set<System> &Galaxy()
+	{
+		static Set<System> systems;
+		if(!systems.size())
+		{
+			ostringstream out;
+			unsigned seed = 1;
+			for(int i = 0; i < SYSTEM_COUNT; ++i)
+			{
+				seed = seed * 1103515245u + 12345u;
+				out << "system \"System " << i << "\"\n";
+				out << "\tpos " << (seed >> 8) % 10000 << " " << (seed >> 4) % 5000 << "\n";
+			}
+			istringstream in(out.str());
+			DataFile file(in);
+			Set<Planet> planets;
+			for(const DataNode &node : file)
+				systems.Get(node.Token(1))->Load(node, planets);
+		}
+		return systems;
+	}
+	
+	Benchmark updateAll("galaxy: find the neighbors of 10,000 systems", [](){
+		Set<System> &systems = Galaxy();
+		SystemGrid grid;
+		for(auto &it : systems)
+			grid.Place(&it.second);
+		for(auto &it : systems)
+			it.second.UpdateNeighbors(grid);
+	});
+	
+	// Without a journal, reverting the galaxy would mean copying every system
+	// back from a saved copy. With one, only the changed systems are copied.
+	Benchmark copyAll("galaxy: copy 10,000 systems", [](){
+		Set<System> copy = Galaxy();
+	});
+	
+	Benchmark revert("galaxy: revert a link between two of 10,000 systems", [](){
+		static Journal<System> journal(Galaxy());
+		static bool isFirst = true;
+		if(isFirst)
+			journal.Snapshot();
+		isFirst = false;
+		
+		System *other = journal.Modify("System 2");
+		journal.Modify("System 1")->Link(other);
+		journal.Revert();
+	});
+}
@@ -0,0 +1,87 @@
+/* GeometryBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Angle.h"
+#include "Point.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace {
+	const int COUNT = 10000;
+	
+	// The positions and facings of ten thousand objects, about as far apart as
+	// the objects in a busy system.
+	const vector<Point> &Points()
+	{
+		static vector<Point> points;
+		if(points.empty())
+		{
+			unsigned seed = 1;
+			auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) % 20001) - 10000.; };
+			for(int i = 0; i < COUNT; ++i)
+				points.emplace_back(next(), next());
+		}
+		return points;
+	}
+	
+	const vector<double> &Degrees()
+	{
+		static vector<double> degrees;
+		if(degrees.empty())
+		{
+			unsigned seed = 2;
+			for(int i = 0; i < COUNT; ++i)
+			{
+				seed = seed * 1103515245u + 12345u;
+				degrees.push_back(((seed >> 8) % 36000) * .01);
+			}
+		}
+		return degrees;
+	}
+	
+	// Keep the compiler from optimizing the math away.
+	double sum = 0.;
+	
+	// Every ship's thrust and every projectile's velocity is a unit vector
+	// looked up from its angle.
+	Benchmark unit("geometry: 10,000 unit vectors from angles", [](){
+		for(double degrees : Degrees())
+			sum += Angle(degrees).Unit().X();
+	});
+	
+	// Drawing a sprite or checking its mask rotates points by its facing.
+	Benchmark rotate("geometry: rotate 10,000 points", [](){
+		const vector<Point> &points = Points();
+		const vector<double> &degrees = Degrees();
+		for(int i = 0; i < COUNT; ++i)
+			sum += Angle(degrees[i]).Rotate(points[i]).Y();
+	});
+	
+	// The AI finds the angle toward each of its targets.
+	Benchmark fromVector("geometry: 10,000 angles from vectors", [](){
+		for(const Point &point : Points())
+			sum += Angle(point).Degrees();
+	});
+	
+	Benchmark distance("geometry: 10,000 distances, unit vectors and dot products", [](){
+		const vector<Point> &points = Points();
+		for(int i = 1; i < COUNT; ++i)
+		{
+			Point d = points[i] - points[i - 1];
+			sum += d.Length() + d.Unit().Dot(points[i]) + points[i].Cross(d);
+		}
+	});
+}
@@ -0,0 +1,33 @@
+/* ImageBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Files.h"
+#include "ImageBuffer.h"
+
+#include <string>
+
+using namespace std;
+
+namespace {
+	// Every sprite is decoded from a PNG file, and every planet landscape from
+	// a JPEG file, by the image loading threads.
+	void Read(const string &path)
+	{
+		ImageBuffer image;
+		image.Read(Files::Images() + path);
+	}
+	
+	Benchmark png("images: decode a ship sprite", [](){ Read("ship/bactrian.png"); });
+	Benchmark jpeg("images: decode a landscape", [](){ Read("land/badlands0.jpg"); });
+}
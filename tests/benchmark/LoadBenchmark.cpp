@@ -0,0 +1,224 @@
+/* LoadBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Files.h"
+#include "Fleet.h"
+#include "Government.h"
+#include "Journal.h"
+#include "Outfit.h"
+#include "Planet.h"
+#include "Set.h"
+#include "Ship.h"
+#include "System.h"
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	const vector<string> &DataFiles()
+	{
+		static const vector<string> paths = Files::RecursiveList(Files::Data());
+		return paths;
+	}
+	
+	// The contents of every data file, parsed once so that loading objects from
+	// them can be measured separately from parsing.
+	const list<DataFile> &Parsed()
+	{
+		static list<DataFile> files;
+		if(files.empty())
+			for(const string &path : DataFiles())
+				files.emplace_back(path);
+		return files;
+	}
+	
+	// Every name that is defined in the data files or used as a token in them,
+	// for measuring how fast the sets can look names up.
+	void AddTokens(const DataNode &node, vector<string> &tokens)
+	{
+		for(int i = 0; i < node.Size(); ++i)
+			tokens.push_back(node.Token(i));
+		for(const DataNode &child : node)
+			AddTokens(child, tokens);
+	}
+	
+	Benchmark parse("load: parse every file in the data/ tree", [](){
+		for(const string &path : DataFiles())
+			DataFile file(path);
+	});
+	
+	// Loading is the part of startup that depends on Set. Each object's Load()
+	// also looks up whatever other objects it refers to in GameData's sets.
+	Benchmark load("load: load the outfits, ships, systems, planets, fleets and governments", [](){
+		Set<Outfit> outfits;
+		Set<Ship> ships;
+		Set<System> systems;
+		Set<Planet> planets;
+		Set<Fleet> fleets;
+		Set<Government> governments;
+		for(const DataFile &file : Parsed())
+			for(const DataNode &node : file)
+			{
+				const string &key = node.Token(0);
+				if(node.Size() < 2)
+					continue;
+				else if(key == "outfit")
+					outfits.Get(node.Token(1))->Load(node);
+				else if(key == "ship")
+					ships.Get(node.Token((node.Size() > 2) ? 2 : 1))->Load(node);
+				else if(key == "system")
+					systems.Get(node.Token(1))->Load(node, planets);
+				else if(key == "planet")
+					planets.Get(node.Token(1))->Load(node);
+				else if(key == "fleet")
+					fleets.Get(node.Token(1))->Load(node);
+				else if(key == "government")
+					governments.Get(node.Token(1))->Load(node);
+			}
+	});
+	
+	// Keep the compiler from optimizing the lookups away.
+	int found = 0;
+	
+	Benchmark lookup("load: look up every token in the data/ tree in a set", [](){
+		static Set<int> names;
+		static vector<string> tokens;
+		if(tokens.empty())
+		{
+			for(const DataFile &file : Parsed())
+				for(const DataNode &node : file)
+				{
+					if(node.Size() >= 2)
+						names.Get(node.Token(1));
+					AddTokens(node, tokens);
+				}
+		}
+		
+		found = 0;
+		for(const string &token : tokens)
+			found += names.Has(token);
+	});
+	
+	
+	// Add and erase names at random, the way events and journals do, and check
+	// that a set and a copy of it always hold the same names as a map does,
+	// and that each name keeps the handle it was first given.
+	bool CheckErase()
+	{
+		mt19937 random(1);
+		Set<int> names;
+		map<string, int> expected;
+		map<string, int> handles;
+		bool passed = true;
+		for(int i = 0; i < 20000; ++i)
+		{
+			string name = "name " + to_string(random() % 500);
+			if(random() % 2)
+			{
+				int handle = names.Handle(name);
+				if(!handles.emplace(name, handle).second && handles[name] != handle)
+				{
+					cout << "    The handle of \"" << name << "\" changed." << endl;
+					passed = false;
+				}
+				*names.FromHandle(handle) = i;
+				expected[name] = i;
+			}
+			else
+			{
+				names.Erase(name);
+				expected.erase(name);
+			}
+		}
+		if(names.Handles() != static_cast<int>(handles.size()))
+		{
+			cout << "    There are " << names.Handles() << " handles for " << handles.size() << " names." << endl;
+			passed = false;
+		}
+		
+		Set<int> copy = names;
+		for(const Set<int> *set : {&names, &copy})
+		{
+			for(const auto &it : handles)
+				if(set->FromHandle(it.second) != set->Find(it.first))
+				{
+					cout << "    The handle of \"" << it.first << "\" gives the wrong object." << endl;
+					passed = false;
+				}
+			if(set->size() != static_cast<int>(expected.size()))
+			{
+				cout << "    The set has " << set->size() << " names instead of " << expected.size() << "." << endl;
+				passed = false;
+			}
+			for(int i = 0; i < 500; ++i)
+			{
+				string name = "name " + to_string(i);
+				auto it = expected.find(name);
+				const int *value = set->Find(name);
+				if(it == expected.end() ? value != nullptr : (!value || *value != it->second))
+				{
+					cout << "    The set has the wrong value for \"" << name << "\"." << endl;
+					passed = false;
+				}
+			}
+		}
+		return passed;
+	}
+	
+	Test erase("set: erasing and adding names keeps the same handles", CheckErase);
+	
+	// Check that a journal restores the objects that existed when its snapshot
+	// was taken, and removes all the others, including ones that had been
+	// erased before the snapshot and then created again.
+	bool CheckJournal()
+	{
+		Set<int> numbers;
+		*numbers.Get("one") = 1;
+		*numbers.Get("two") = 2;
+		numbers.Get("erased");
+		numbers.Erase("erased");
+		
+		Journal<int> journal(numbers);
+		journal.Snapshot();
+		*journal.Modify("one") = 10;
+		*journal.Modify("one") = 100;
+		*journal.Modify("erased") = 3;
+		*journal.Modify("added") = 4;
+		numbers.Get("created");
+		vector<int *> restored = journal.Revert();
+		
+		bool passed = true;
+		if(restored.size() != 1 || restored[0] != numbers.Find("one") || *numbers.Find("one") != 1)
+		{
+			cout << "    The modified object was not restored." << endl;
+			passed = false;
+		}
+		if(numbers.size() != 2 || !numbers.Has("two") || numbers.Has("erased") || numbers.Has("added") || numbers.Has("created"))
+		{
+			cout << "    The objects created after the snapshot were not removed." << endl;
+			passed = false;
+		}
+		return passed;
+	}
+	
+	Test journal("set: a journal reverts changes and removes new objects", CheckJournal);
+}
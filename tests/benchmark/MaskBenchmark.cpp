@@ -0,0 +1,179 @@
+/* MaskBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Angle.h"
+#include "ImageBuffer.h"
+#include "Mask.h"
+#include "Point.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Trace a mask from a gear-shaped image. More teeth make a more detailed
+	// outline, like the outline of a very large sprite.
+	Mask MakeMask(int size, int teeth)
+	{
+		ImageBuffer image;
+		image.Allocate(size, size);
+		double center = .5 * size;
+		for(int y = 0; y < size; ++y)
+		{
+			uint32_t *it = image.Begin(y);
+			for(int x = 0; x < size; ++x)
+			{
+				Point d(x - center, y - center);
+				double radius = center * (.8 + .1 * sin(teeth * atan2(d.Y(), d.X())));
+				*it++ = (d.Length() < radius) ? 0xFFFFFFFF : 0;
+			}
+		}
+		Mask mask;
+		mask.Create(image);
+		return mask;
+	}
+	
+	const Mask &Typical()
+	{
+		static const Mask mask = MakeMask(200, 12);
+		return mask;
+	}
+	
+	const Mask &Huge()
+	{
+		static const Mask mask = MakeMask(2000, 300);
+		return mask;
+	}
+	
+	// A long, thin outline, which fills only a small part of its radius.
+	Mask MakeLongMask()
+	{
+		ImageBuffer image;
+		image.Allocate(400, 80);
+		for(int y = 0; y < 80; ++y)
+		{
+			uint32_t *it = image.Begin(y);
+			for(int x = 0; x < 400; ++x)
+			{
+				Point d((x - 200.) / 200., (y - 40.) / 40.);
+				*it++ = (d.Length() < 1.) ? 0xFFFFFFFF : 0;
+			}
+		}
+		Mask mask;
+		mask.Create(image);
+		return mask;
+	}
+	
+	const Mask &Long()
+	{
+		static const Mask mask = MakeLongMask();
+		return mask;
+	}
+	
+	const Mask &CachedLong()
+	{
+		static const Mask mask = MakeLongMask();
+		mask.CacheFacings();
+		return mask;
+	}
+	
+	// A point near the mask, and a projectile's velocity from there.
+	class Query {
+	public:
+		Point point;
+		Point velocity;
+		Angle facing;
+	};
+	
+	// A thousand queries scattered around the mask, most of them close enough
+	// that the outline itself must be checked.
+	vector<Query> Queries(const Mask &mask)
+	{
+		vector<Query> queries;
+		unsigned seed = 1;
+		auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) % 2001) / 1000. - 1.; };
+		for(int i = 0; i < 1000; ++i)
+		{
+			Query query;
+			query.point = Point(next(), next()) * mask.Radius() * 1.2;
+			query.velocity = Point(next(), next()) * mask.Radius();
+			query.facing = Angle(180. * next());
+			queries.push_back(query);
+		}
+		return queries;
+	}
+	
+	const vector<Query> &TypicalQueries()
+	{
+		static const vector<Query> queries = Queries(Typical());
+		return queries;
+	}
+	
+	const vector<Query> &HugeQueries()
+	{
+		static const vector<Query> queries = Queries(Huge());
+		return queries;
+	}
+	
+	const vector<Query> &LongQueries()
+	{
+		static const vector<Query> queries = Queries(Long());
+		return queries;
+	}
+	
+	// Keep the compiler from optimizing the queries away.
+	double sum = 0.;
+	
+	void Collide(const Mask &mask, const vector<Query> &queries)
+	{
+		for(const Query &query : queries)
+			sum += mask.Collide(query.point, query.velocity, query.facing);
+	}
+	
+	void Contains(const Mask &mask, const vector<Query> &queries)
+	{
+		for(const Query &query : queries)
+			sum += mask.Contains(query.point, query.facing);
+	}
+	
+	void WithinRange(const Mask &mask, const vector<Query> &queries)
+	{
+		for(const Query &query : queries)
+			sum += mask.WithinRange(query.point, query.facing, .1 * mask.Radius());
+	}
+	
+	void Range(const Mask &mask, const vector<Query> &queries)
+	{
+		for(const Query &query : queries)
+			sum += mask.Range(query.point, query.facing);
+	}
+	
+	Benchmark collide("mask: 1,000 collisions with a typical outline", [](){ Collide(Typical(), TypicalQueries()); });
+	Benchmark contains("mask: 1,000 containment tests on a typical outline", [](){ Contains(Typical(), TypicalQueries()); });
+	Benchmark withinRange("mask: 1,000 range checks on a typical outline", [](){ WithinRange(Typical(), TypicalQueries()); });
+	Benchmark range("mask: 1,000 distances to a typical outline", [](){ Range(Typical(), TypicalQueries()); });
+	
+	Benchmark collideHuge("mask: 1,000 collisions with a huge outline", [](){ Collide(Huge(), HugeQueries()); });
+	Benchmark containsHuge("mask: 1,000 containment tests on a huge outline", [](){ Contains(Huge(), HugeQueries()); });
+	Benchmark withinRangeHuge("mask: 1,000 range checks on a huge outline", [](){ WithinRange(Huge(), HugeQueries()); });
+	Benchmark rangeHuge("mask: 1,000 distances to a huge outline", [](){ Range(Huge(), HugeQueries()); });
+	
+	Benchmark collideLong("mask: 1,000 collisions with a long outline", [](){ Collide(Long(), LongQueries()); });
+	Benchmark containsLong("mask: 1,000 containment tests on a long outline", [](){ Contains(Long(), LongQueries()); });
+	Benchmark withinRangeLong("mask: 1,000 range checks on a long outline", [](){ WithinRange(Long(), LongQueries()); });
+	Benchmark collideCached("mask: 1,000 collisions with a long outline, with cached facings", [](){ Collide(CachedLong(), LongQueries()); });
+	Benchmark containsCached("mask: 1,000 containment tests on a long outline, with cached facings", [](){ Contains(CachedLong(), LongQueries()); });
+	Benchmark withinRangeCached("mask: 1,000 range checks on a long outline, with cached facings", [](){ WithinRange(CachedLong(), LongQueries()); });
+}
@@ -0,0 +1,290 @@
+/* MaskTest.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Angle.h"
+#include "Files.h"
+#include "ImageBuffer.h"
+#include "ImageSet.h"
+#include "Mask.h"
+#include "Point.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// These are the mask queries as they were originally written, checking
+	// every edge of the outline one at a time.
+	double Intersection(const vector<Point> &outline, Point sA, Point vA)
+	{
+		double closest = 1.;
+		Point prev = outline.back();
+		for(const Point &next : outline)
+		{
+			Point vB = next - prev;
+			double cross = vB.Cross(vA);
+			if(cross > 0.)
+			{
+				Point vS = prev - sA;
+				double uB = vA.Cross(vS);
+				double uA = vB.Cross(vS);
+				if((uB >= 0.) & (uB < cross) & (uA >= 0.))
+					closest = min(closest, uA / cross);
+			}
+			prev = next;
+		}
+		return closest;
+	}
+	
+	bool Contains(const vector<Point> &outline, Point point)
+	{
+		int intersections = 0;
+		Point prev = outline.back();
+		for(const Point &next : outline)
+		{
+			if(prev.X() != next.X())
+				if((prev.X() <= point.X()) == (point.X() < next.X()))
+				{
+					double y = prev.Y() + (next.Y() - prev.Y()) *
+						(point.X() - prev.X()) / (next.X() - prev.X());
+					intersections += (y >= point.Y());
+				}
+			prev = next;
+		}
+		return (intersections & 1);
+	}
+	
+	bool WithinRange(const vector<Point> &outline, Point point, double range)
+	{
+		for(const Point &p : outline)
+			if(p.DistanceSquared(point) < range * range)
+				return true;
+		return false;
+	}
+	
+	double Range(const vector<Point> &outline, Point point)
+	{
+		if(Contains(outline, point))
+			return 0.;
+		
+		double range = numeric_limits<double>::infinity();
+		for(const Point &p : outline)
+			range = min(range, p.DistanceSquared(point));
+		return sqrt(range);
+	}
+	
+	// The results should be identical, down to the last bit.
+	bool Same(double a, double b)
+	{
+		return !memcmp(&a, &b, sizeof(a));
+	}
+	
+	// Compare the mask queries to the originals, with queries scattered around
+	// the mask. Some of the queries start exactly on one of the outline's
+	// points, which is where rounding matters most. Return the number of
+	// queries that gave different results.
+	int Compare(const Mask &mask, const string &name)
+	{
+		unsigned seed = 1;
+		auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) % 2001) / 1000. - 1.; };
+		
+		int failures = 0;
+		const vector<Point> &outline = mask.Points();
+		double radius = mask.Radius();
+		for(int i = 0; i < 200; ++i)
+		{
+			Point point = (i % 10) ? Point(next(), next()) * radius * 1.2 : outline[i % outline.size()];
+			Point velocity = Point(next(), next()) * radius;
+			Angle facing(180. * next());
+			double range = radius * .3 * (next() + 1.);
+			
+			// Rotate the query into the mask's frame of reference, exactly the
+			// same way that the mask does.
+			Point p = (-facing).Rotate(point);
+			Point v = (-facing).Rotate(velocity);
+			bool isNear = (point.Length() <= radius);
+			
+			double collide = 1.;
+			if(point.Length() <= radius + velocity.Length())
+				collide = (isNear && Contains(outline, p)) ? 0. : Intersection(outline, p, v);
+			
+			const char *failed = nullptr;
+			if(!Same(mask.Collide(point, velocity, facing), collide))
+				failed = "Collide";
+			else if(mask.Contains(point, facing) != (isNear && Contains(outline, p)))
+				failed = "Contains";
+			else if(mask.WithinRange(point, facing, range) != (range >= point.Length() - radius && WithinRange(outline, p, range)))
+				failed = "WithinRange";
+			else if(!Same(mask.Range(point, facing), Range(outline, p)))
+				failed = "Range";
+			
+			if(failed && ++failures <= 10)
+				cout << "    " << failed << "() differs for " << name << " at " << point.X() << ", " << point.Y() << endl;
+		}
+		return failures;
+	}
+	
+	// Get the mask of every masked sprite in the game. Reading them takes a
+	// while, so this is only done once.
+	const list<pair<string, Mask>> &Sprites()
+	{
+		static list<pair<string, Mask>> masks;
+		static bool isRead = false;
+		if(isRead)
+			return masks;
+		
+		isRead = true;
+		for(const string &path : Files::RecursiveList(Files::Images()))
+		{
+			string name = path.substr(Files::Images().length());
+			if(!ImageSet::IsMasked(name) || name.find('@') != string::npos)
+				continue;
+			
+			ImageBuffer image;
+			if(!image.Read(path))
+				continue;
+			Mask mask;
+			mask.Create(image);
+			if(mask.IsLoaded())
+				masks.emplace_back(name, mask);
+		}
+		return masks;
+	}
+	
+	// Few of the game's sprites have outlines detailed enough to be indexed,
+	// so also make gear-shaped outlines of increasing detail.
+	Mask Gear(int teeth)
+	{
+		int size = 6 * teeth + 200;
+		ImageBuffer image;
+		image.Allocate(size, size);
+		double center = .5 * size;
+		for(int y = 0; y < size; ++y)
+		{
+			uint32_t *it = image.Begin(y);
+			for(int x = 0; x < size; ++x)
+			{
+				Point d(x - center, y - center);
+				double radius = center * (.8 + .1 * sin(teeth * atan2(d.Y(), d.X())));
+				*it++ = (d.Length() < radius) ? 0xFFFFFFFF : 0;
+			}
+		}
+		Mask mask;
+		mask.Create(image);
+		return mask;
+	}
+	
+	// Check every masked sprite in the game.
+	bool CompareSprites()
+	{
+		int failures = 0;
+		for(const pair<string, Mask> &it : Sprites())
+		{
+			Mask mask = it.second;
+			failures += Compare(mask, it.first);
+			mask.CacheFacings();
+			failures += Compare(mask, it.first + " (with cached facings)");
+		}
+		if(Sprites().empty())
+			cout << "    No masked sprites were found in \"" << Files::Images() << "\"." << endl;
+		return !Sprites().empty() && !failures;
+	}
+	
+	bool CompareGears()
+	{
+		int failures = 0;
+		for(int teeth = 20; teeth <= 320; teeth *= 2)
+		{
+			Mask mask = Gear(teeth);
+			failures += Compare(mask, "a gear with " + to_string(teeth) + " teeth");
+			mask.CacheFacings();
+			failures += Compare(mask, "a gear with " + to_string(teeth) + " teeth (with cached facings)");
+		}
+		return !failures;
+	}
+	
+	// Get the results of the same queries that Compare() makes.
+	vector<double> Results(const Mask &mask)
+	{
+		unsigned seed = 1;
+		auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return ((seed >> 8) % 2001) / 1000. - 1.; };
+		
+		vector<double> results;
+		const vector<Point> &outline = mask.Points();
+		double radius = mask.Radius();
+		for(int i = 0; i < 200; ++i)
+		{
+			Point point = (i % 10) ? Point(next(), next()) * radius * 1.2 : outline[i % outline.size()];
+			Point velocity = Point(next(), next()) * radius;
+			Angle facing(180. * next());
+			double range = radius * .3 * (next() + 1.);
+			
+			results.push_back(mask.Collide(point, velocity, facing));
+			results.push_back(mask.Contains(point, facing));
+			results.push_back(mask.WithinRange(point, facing, range));
+			results.push_back(mask.Range(point, facing));
+		}
+		return results;
+	}
+	
+	// Check that each set of instructions that this processor supports gives
+	// exactly the same results as the scalar versions of the queries.
+	bool CompareInstructions()
+	{
+		vector<pair<string, Mask>> masks(Sprites().begin(), Sprites().end());
+		for(int teeth = 20; teeth <= 320; teeth *= 2)
+			masks.emplace_back("a gear with " + to_string(teeth) + " teeth", Gear(teeth));
+		for(size_t i = 0, count = masks.size(); i < count; ++i)
+		{
+			masks.push_back(masks[i]);
+			masks.back().first += " (with cached facings)";
+			masks.back().second.CacheFacings();
+		}
+		
+		const pair<Mask::Instructions, const char *> SETS[] = {{Mask::SSE2, "SSE2"}, {Mask::AVX, "AVX"}};
+		int failures = 0;
+		for(const pair<Mask::Instructions, const char *> &set : SETS)
+		{
+			if(!Mask::Supports(set.first))
+				continue;
+			
+			for(const pair<string, Mask> &it : masks)
+			{
+				Mask::UseInstructions(Mask::SCALAR);
+				vector<double> expected = Results(it.second);
+				Mask::UseInstructions(set.first);
+				vector<double> results = Results(it.second);
+				for(size_t i = 0; i < results.size(); ++i)
+					if(!Same(results[i], expected[i]) && ++failures <= 10)
+						cout << "    The " << set.second << " version of query " << i
+							<< " differs for " << it.first << "." << endl;
+			}
+		}
+		// Go back to using the widest instructions.
+		if(!Mask::UseInstructions(Mask::AVX))
+			Mask::UseInstructions(Mask::SSE2);
+		return !failures;
+	}
+	
+	Test sprites("mask: queries match checking every edge of every masked sprite", CompareSprites);
+	Test gears("mask: queries match checking every edge of detailed outlines", CompareGears);
+	Test instructions("mask: every instruction set gives the same results as the scalar one", CompareInstructions);
+}
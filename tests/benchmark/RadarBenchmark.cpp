@@ -0,0 +1,54 @@
+/* RadarBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Point.h"
+#include "Radar.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// A large battle: two thousand ships and missiles, most of them crowded
+	// together in a few fleets.
+	const vector<Point> &Battle()
+	{
+		static vector<Point> points;
+		if(points.empty())
+		{
+			unsigned seed = 1;
+			auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 8) % 2000; };
+			for(int i = 0; i < 2000; ++i)
+			{
+				Point fleet(2000. * (i % 5) - 4000., 1000. * (i % 3) - 1000.);
+				points.emplace_back(fleet + Point(next(), next()) - Point(1000., 1000.));
+			}
+		}
+		return points;
+	}
+	
+	void FillRadar(double scale)
+	{
+		static Radar radar;
+		radar.SetScale(scale);
+		radar.Clear();
+		radar.SetCenter(Point());
+		int type = 0;
+		for(const Point &point : Battle())
+			radar.Add(type++ % 4, point, 2.);
+	}
+	
+	Benchmark fillExact("radar: add a battle, no merging", [](){ FillRadar(0.); });
+	Benchmark fillBinned("radar: add a battle, merging dots", [](){ FillRadar(.025); });
+}
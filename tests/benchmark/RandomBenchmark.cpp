@@ -0,0 +1,138 @@
+/* RandomBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Random.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	const uint64_t SEED = 12345;
+	const uint64_t STEP = 67;
+	
+	// Draw a few numbers for each of the given entities, from each entity's
+	// own stream within one step of the game.
+	map<uint64_t, vector<uint32_t>> Draw(const vector<uint64_t> &entities)
+	{
+		map<uint64_t, vector<uint32_t>> result;
+		Random::Stream step(SEED, STEP, 0, Random::STEP);
+		for(uint64_t entity : entities)
+		{
+			Random::Stream stream(entity, Random::MOVE);
+			vector<uint32_t> &numbers = result[entity];
+			for(int i = 0; i < 5; ++i)
+				numbers.push_back(Random::Int());
+			// Drawing from another entity's stream in between must not change
+			// what comes next in this one.
+			{
+				Random::Stream other(entity + 1000, Random::AI);
+				Random::Int();
+			}
+			numbers.push_back(Random::Int(1000));
+		}
+		return result;
+	}
+	
+	// Check that each entity's stream gives the same numbers no matter what
+	// order the entities are visited in, or what thread they are visited on,
+	// even while another thread is drawing from its own streams.
+	bool CheckStreams()
+	{
+		bool passed = true;
+		map<uint64_t, vector<uint32_t>> expected = Draw({1, 2, 3});
+		if(expected[1] == expected[2] || expected[2] == expected[3])
+		{
+			cout << "    Different entities were given the same numbers." << endl;
+			passed = false;
+		}
+		
+		if(Draw({3, 1, 2}) != expected)
+		{
+			cout << "    Visiting the entities in a different order changed their numbers." << endl;
+			passed = false;
+		}
+		
+		// Have this thread and another one take turns drawing numbers for
+		// different entities, each from a stream it created itself, so that
+		// both threads have a stream active at the same time.
+		const vector<uint64_t> entities = {2, 3};
+		vector<uint32_t> drawn[2];
+		{
+			mutex turnMutex;
+			condition_variable turnChanged;
+			size_t turn = 0;
+			auto takeTurns = [&](size_t index){
+				Random::Stream step(SEED, STEP, 0, Random::STEP);
+				Random::Stream stream(entities[index], Random::MOVE);
+				for(int i = 0; i < 5; ++i)
+				{
+					unique_lock<mutex> lock(turnMutex);
+					turnChanged.wait(lock, [&](){ return turn % 2 == index; });
+					drawn[index].push_back(Random::Int());
+					++turn;
+					turnChanged.notify_all();
+				}
+			};
+			thread other(takeTurns, 1);
+			takeTurns(0);
+			other.join();
+		}
+		for(size_t index = 0; index < 2; ++index)
+			if(!equal(drawn[index].begin(), drawn[index].end(), expected[entities[index]].begin()))
+			{
+				cout << "    Drawing on " << (index ? "another" : "this") << " thread while a stream"
+					<< " was active on the other one changed the numbers." << endl;
+				passed = false;
+			}
+		
+		Random::Stream step(SEED, STEP + 1, 0, Random::STEP);
+		Random::Stream stream(1, Random::MOVE);
+		if(Random::Int() == expected[1][0])
+		{
+			cout << "    A different step gave the same numbers." << endl;
+			passed = false;
+		}
+		return passed;
+	}
+	
+	Test streams("random: entity streams do not depend on order or thread", CheckStreams);
+	
+	
+	// Keep the compiler from optimizing the random numbers away.
+	double sum = 0.;
+	
+	Benchmark global("random: draw 100,000 numbers from the global generator", [](){
+		for(int i = 0; i < 100000; ++i)
+			sum += Random::Real();
+	});
+	
+	// In a step of the game, each ship draws a few numbers from its own stream.
+	Benchmark entityStreams("random: draw 100,000 numbers from 10,000 entity streams", [](){
+		Random::Stream step(1, 2, 0, Random::STEP);
+		for(int entity = 0; entity < 10000; ++entity)
+		{
+			Random::Stream stream(entity, Random::MOVE);
+			for(int i = 0; i < 10; ++i)
+				sum += Random::Real();
+		}
+	});
+}
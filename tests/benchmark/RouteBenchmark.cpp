@@ -0,0 +1,65 @@
+/* RouteBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "DataFile.h"
+#include "DataNode.h"
+#include "DistanceMap.h"
+#include "Files.h"
+#include "GameData.h"
+#include "Planet.h"
+#include "Set.h"
+#include "System.h"
+
+#include <string>
+
+using namespace std;
+
+namespace {
+	// The systems in the data files, with their hyperspace links. Systems link
+	// to each other through GameData, so they must be loaded there. Loading all
+	// of GameData would also start loading every image in the background, so
+	// just fill in the systems.
+	const System *Sol()
+	{
+		static const System *sol = nullptr;
+		if(!sol)
+		{
+			static Set<Planet> planets;
+			for(const string &path : Files::RecursiveList(Files::Data()))
+			{
+				DataFile file(path);
+				for(const DataNode &node : file)
+					if(node.Token(0) == "system" && node.Size() >= 2)
+						const_cast<System *>(GameData::Systems().Get(node.Token(1)))->Load(node, planets);
+			}
+			sol = GameData::Systems().Get("Sol");
+		}
+		return sol;
+	}
+	
+	// Keep the compiler from optimizing the routes away.
+	int days = 0;
+	
+	// The map panel finds a route to every system that the player can see.
+	Benchmark all("routes: find the distance from one system to every other", [](){
+		DistanceMap distance(Sol());
+		days += distance.Days(Sol());
+	});
+	
+	// Mission and fleet destinations are often limited to a few jumps away.
+	Benchmark nearby("routes: find every system within five jumps", [](){
+		DistanceMap distance(Sol(), -1, 5);
+		days += distance.Days(Sol());
+	});
+}
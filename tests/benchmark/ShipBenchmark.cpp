@@ -0,0 +1,66 @@
+/* ShipBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Files.h"
+#include "GameData.h"
+#include "Outfit.h"
+#include "Ship.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	// Every ship model defined in the data files, fully loaded.
+	const list<Ship> &Models()
+	{
+		static list<Ship> models;
+		if(models.empty())
+		{
+			list<DataFile> files;
+			for(const string &path : Files::RecursiveList(Files::Data()))
+				files.emplace_back(path);
+			
+			// The ships need their outfits to be loaded in order to have all their
+			// attributes. Loading all of GameData would also start loading every
+			// image in the background, which would throw off the timing, so just
+			// fill in the outfits that GameData creates on demand.
+			for(const DataFile &file : files)
+				for(const DataNode &node : file)
+					if(node.Token(0) == "outfit" && node.Size() >= 2)
+						const_cast<Outfit *>(GameData::Outfits().Get(node.Token(1)))->Load(node);
+			
+			for(const DataFile &file : files)
+				for(const DataNode &node : file)
+					if(node.Token(0) == "ship" && node.Size() == 2)
+						models.emplace_back(node);
+			for(Ship &model : models)
+				model.FinishLoading(true);
+		}
+		return models;
+	}
+	
+	// Spawning a fleet copies each ship in it from its model, and the copies are
+	// destroyed when they leave the system.
+	Benchmark spawn("ships: spawn and destroy one of every ship model", [](){
+		vector<shared_ptr<Ship>> ships;
+		for(const Ship &model : Models())
+			ships.emplace_back(new Ship(model));
+	});
+}
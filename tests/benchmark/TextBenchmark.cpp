@@ -0,0 +1,87 @@
+/* TextBenchmark.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Color.h"
+#include "Files.h"
+#include "Font.h"
+#include "Point.h"
+#include "WrappedText.h"
+
+#include <string>
+
+using namespace std;
+
+namespace {
+	// Glyph metrics do not need an OpenGL context, so the font can be loaded
+	// the same way the game does it.
+	const Font &GetFont()
+	{
+		static const Font font(Files::Images() + "font/ubuntu14r.png");
+		return font;
+	}
+	
+	// About as much text as fits in a full conversation or mission panel.
+	const string &Page()
+	{
+		static string page;
+		if(page.empty())
+		{
+			const string paragraph =
+				"\tThe freighter's captain leans over the console, tapping at a long list of "
+				"cargo manifests. \"We've been hauling food and medical supplies out to the "
+				"frontier for almost a decade now, and we've never once been stopped by the "
+				"Republic Navy. Then, last week, three of our ships were boarded in a single "
+				"day.\" She pauses, as if deciding how much she should tell you. \"Whoever is "
+				"behind it, they knew exactly which ships to look for.\"\n";
+			for(int i = 0; i < 6; ++i)
+				page += paragraph;
+		}
+		return page;
+	}
+	
+	void WrapPage(int width)
+	{
+		WrappedText text(GetFont());
+		text.SetWrapWidth(width);
+		text.Wrap(Page());
+		// Building the glyph batch is the only part of drawing that happens on
+		// the CPU. Discard it instead of flushing it to the GPU.
+		text.Draw(Point(-220., -300.), Color(1.f));
+		Font::Discard();
+	}
+	
+	// The same page is drawn in every frame, so its layout should be cached.
+	Benchmark wrapPage("text: wrap and batch a page", [](){ WrapPage(440); });
+	
+	// Cycle through more wrap widths than the layout cache can hold, so that
+	// every layout is done from scratch.
+	Benchmark wrapNewPage("text: wrap and batch an uncached page", [](){
+		static int width = 0;
+		width = (width + 1) % 1000;
+		WrapPage(400 + width);
+	});
+	
+	// Measure and truncate the same list of names that a shop panel might show.
+	Benchmark truncateList("text: measure and truncate a list", [](){
+		static const string names[] = {
+			"Heavy Anti-Missile Turret", "Quantum Key Stone", "Fuel Pod",
+			"Systems Core (Large)", "Hyperdrive", "Plasma Cannon", "Sidewinder Missile Launcher",
+			"Outfits Expansion", "Cargo Expansion", "Ramscoop", "Fusion Reactor", "Dwarf Core"};
+		const Font &font = GetFont();
+		int sum = 0;
+		for(const string &name : names)
+			sum += font.Width(name) + font.TruncateMiddle(name, 120).length();
+		return sum;
+	});
+}
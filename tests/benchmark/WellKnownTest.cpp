@@ -0,0 +1,104 @@
+/* WellKnownTest.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Audio.h"
+#include "DataFile.h"
+#include "DataNode.h"
+#include "Effect.h"
+#include "Files.h"
+#include "GameData.h"
+#include "Set.h"
+#include "WellKnown.h"
+
+#include <iostream>
+#include <set>
+#include <string>
+
+using namespace std;
+
+namespace {
+	// The engine no longer looks up any effects or sounds by name while it is
+	// running, so a misspelled or missing name would only show up as an effect
+	// or sound that silently never appears. Check that each one the engine
+	// uses is defined by the game's data files, and that it is the same object
+	// that looking it up by name would give.
+	bool CheckEffects()
+	{
+		set<string> defined;
+		for(const string &path : Files::RecursiveList(Files::Data()))
+		{
+			DataFile file(path);
+			for(const DataNode &node : file)
+				if(node.Token(0) == "effect" && node.Size() >= 2)
+					defined.insert(node.Token(1));
+		}
+		
+		WellKnown::Init();
+		bool passed = true;
+		for(int i = 0; i < WellKnown::EFFECT_COUNT; ++i)
+		{
+			WellKnown::EffectID id = static_cast<WellKnown::EffectID>(i);
+			string name = WellKnown::Name(id);
+			if(!defined.count(name))
+			{
+				cout << "    No effect named \"" << name << "\" is defined." << endl;
+				passed = false;
+			}
+			if(WellKnown::Get(id) != GameData::Effects().Get(name))
+			{
+				cout << "    The effect \"" << name << "\" is not the one in GameData." << endl;
+				passed = false;
+			}
+		}
+		return passed;
+	}
+	
+	bool CheckSounds()
+	{
+		// A sound's name is its path within the sounds folder, without the
+		// ".wav" or "~.wav" at the end.
+		set<string> defined;
+		for(const string &path : Files::RecursiveList(Files::Sounds()))
+		{
+			if(path.length() < 4 || path.compare(path.length() - 4, 4, ".wav"))
+				continue;
+			size_t end = path.length() - 4;
+			if(path[end - 1] == '~')
+				--end;
+			defined.insert(path.substr(Files::Sounds().length(), end - Files::Sounds().length()));
+		}
+		
+		WellKnown::Init();
+		bool passed = true;
+		for(int i = 0; i < WellKnown::SOUND_COUNT; ++i)
+		{
+			WellKnown::SoundID id = static_cast<WellKnown::SoundID>(i);
+			string name = WellKnown::Name(id);
+			if(!defined.count(name))
+			{
+				cout << "    No sound named \"" << name << "\" exists." << endl;
+				passed = false;
+			}
+			if(WellKnown::Get(id) != Audio::Get(name))
+			{
+				cout << "    The sound \"" << name << "\" is not the one in Audio." << endl;
+				passed = false;
+			}
+		}
+		return passed;
+	}
+	
+	Test effects("names: every effect the engine uses is defined", CheckEffects);
+	Test sounds("names: every sound the engine uses exists", CheckSounds);
+}
@@ -0,0 +1,71 @@
+/* main.cpp
+Copyright (c) 2017 by Michael Zahniser
+
+Endless Sky is free software: you can redistribute it and/or modify it under the
+terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later version.
+
+Endless Sky is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+*/
+
+#include "Benchmark.h"
+
+#include "Files.h"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+
+
+// Run the tests, and then the benchmarks. If an argument is given, only tests
+// and benchmarks whose names contain it are run. The same resource path
+// options as the game are accepted. With "--json <path>", the results are also
+// written to the given file.
+int main(int argc, char *argv[])
+{
+	string filter;
+	string jsonPath;
+	for(const char *const *it = argv + 1; *it; ++it)
+	{
+		string arg = *it;
+		if(arg == "-r" || arg == "--resources" || arg == "-c" || arg == "--config")
+		{
+			// Skip the path; Files::Init() handles it.
+			if(it[1])
+				++it;
+		}
+		else if(arg == "--json")
+		{
+			if(it[1])
+				jsonPath = *++it;
+		}
+		else
+			filter = arg;
+	}
+	Files::Init(argv);
+	
+	int failed = 0;
+	int tests = Test::RunAll(filter, failed);
+	int benchmarks = failed ? 0 : Benchmark::RunAll(filter);
+	
+	if(!jsonPath.empty() && !Benchmark::WriteJSON(jsonPath))
+	{
+		cerr << "Unable to write \"" << jsonPath << "\"." << endl;
+		return 1;
+	}
+	if(failed)
+	{
+		cerr << failed << " of " << tests << " tests failed." << endl;
+		return 1;
+	}
+	if(!benchmarks && !tests)
+	{
+		cerr << "No benchmarks match \"" << filter << "\"." << endl;
+		return 1;
+	}
+	return 0;
+}